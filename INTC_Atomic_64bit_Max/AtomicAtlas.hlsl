@@ -0,0 +1,73 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+//
+// Texture2D-array and mip-chain atlas addressing for typed 64-bit atomics,
+// which only support a single 2D subresource. Must match HostAtlasLayout in
+// HostAtlas.h: mip 0 at the left of each slice, mips 1..N-1 stacked in a
+// column to its right, slices stacked vertically.
+//
+// Define ATLAS_WIDTH, ATLAS_HEIGHT (mip 0 size) and ATLAS_MIP_LEVELS before
+// including this file; the loops then unroll and addresses with constant
+// slice / level arguments fold at compile time:
+//
+//   #define ATLAS_WIDTH 512
+//   #define ATLAS_HEIGHT 256
+//   #define ATLAS_MIP_LEVELS 4
+//   #include "AtomicAtlas.hlsl"
+//
+//   IntelExt_InterlockedMaxUint64(outputbuff, Atlas_Address(slice, 2, texel), value);
+//
+// With these defines Atlas_Origin(0, 3) is (512, 192) and Atlas_Origin(1, 2)
+// is (512, 384), as the static_asserts in HostAtlas.cpp check on the host.
+//
+
+#ifndef ATLAS_WIDTH
+#error "Define ATLAS_WIDTH, ATLAS_HEIGHT and ATLAS_MIP_LEVELS before including AtomicAtlas.hlsl"
+#endif
+
+uint Atlas_MipWidth(uint level)
+{
+    return max(ATLAS_WIDTH >> level, 1u);
+}
+
+uint Atlas_MipHeight(uint level)
+{
+    return max(ATLAS_HEIGHT >> level, 1u);
+}
+
+uint2 Atlas_MipSize(uint level)
+{
+    return uint2(Atlas_MipWidth(level), Atlas_MipHeight(level));
+}
+
+uint Atlas_SliceHeight()
+{
+    uint columnHeight = 0;
+    [unroll]
+    for (uint level = 1; level < ATLAS_MIP_LEVELS; level++)
+    {
+        columnHeight += Atlas_MipHeight(level);
+    }
+    return max(ATLAS_HEIGHT, columnHeight);
+}
+
+// Top-left corner of (slice, level) in the atlas.
+uint2 Atlas_Origin(uint slice, uint level)
+{
+    uint y = slice * Atlas_SliceHeight();
+    [unroll]
+    for (uint i = 1; i < ATLAS_MIP_LEVELS; i++)
+    {
+        y += (i < level) ? Atlas_MipHeight(i) : 0;
+    }
+    return uint2(level == 0 ? 0 : ATLAS_WIDTH, y);
+}
+
+// Atlas texel of texel of (slice, level).
+uint2 Atlas_Address(uint slice, uint level, uint2 texel)
+{
+    return Atlas_Origin(slice, level) + texel;
+}
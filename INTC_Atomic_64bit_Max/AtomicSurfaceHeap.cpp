@@ -0,0 +1,133 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "stdafx.h"
+#include "AtomicSurfaceHeap.h"
+
+using Microsoft::WRL::ComPtr;
+
+AtomicSurfaceHeap::AtomicSurfaceHeap(ID3D12Device* device, INTCExtensionContext* context, UINT64 heapSize) :
+    m_device(device),
+    m_context(context),
+    m_allocator(heapSize,
+        [this](uint32_t heap, uint64_t size)
+        {
+            D3D12_HEAP_DESC heapDesc = {};
+            heapDesc.SizeInBytes = size;
+            heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+            heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+            heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES | D3D12_HEAP_FLAG_ALLOW_SHADER_ATOMICS;
+
+            INTC_D3D12_HEAP_DESC intcHeapDesc = {};
+            intcHeapDesc.pD3D12Desc = &heapDesc;
+            intcHeapDesc.HeapFlagCpuVisibleVideoMemory = FALSE;
+
+            ComPtr<ID3D12Heap> d3dHeap;
+            ThrowIfFailed(INTC_D3D12_CreateHeap(m_context, &intcHeapDesc, IID_PPV_ARGS(&d3dHeap)));
+            if (heap >= m_heaps.size())
+            {
+                m_heaps.resize(heap + 1);
+            }
+            m_heaps[heap] = d3dHeap;
+        },
+        [this](uint32_t heap)
+        {
+            m_heaps[heap].Reset();
+        })
+{
+}
+
+UINT64 AtomicSurfaceHeap::GetPlacementSize(const D3D12_RESOURCE_DESC& desc) const
+{
+    const D3D12_RESOURCE_ALLOCATION_INFO info = m_device->GetResourceAllocationInfo(0, 1, &desc);
+
+    // Buddy blocks are aligned to their own size, so a block at least as large
+    // as the alignment is also aligned enough.
+    return max(info.SizeInBytes, info.Alignment);
+}
+
+ComPtr<ID3D12Resource> AtomicSurfaceHeap::CreatePlacedSurface(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState,
+    UINT32 heap, UINT64 offset)
+{
+    D3D12_RESOURCE_DESC texture2D = desc;
+    texture2D.Flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+    INTC_D3D12_RESOURCE_DESC_0001 dsResDesc1;
+    dsResDesc1.pD3D12Desc = &texture2D;
+    dsResDesc1.Texture2DArrayMipPack = FALSE;
+    dsResDesc1.EmulatedTyped64bitAtomics = TRUE;
+
+    ComPtr<ID3D12Resource> resource;
+    ThrowIfFailed(INTC_D3D12_CreatePlacedResource(
+        m_context,
+        m_heaps[heap].Get(),
+        offset,
+        &dsResDesc1,
+        initialState,
+        nullptr,
+        IID_PPV_ARGS(&resource)));
+    return resource;
+}
+
+AtomicSurfaceHeap::Surface AtomicSurfaceHeap::CreateSurface(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState)
+{
+    Surface surface;
+    surface.allocation = m_allocator.Allocate(GetPlacementSize(desc));
+    try
+    {
+        surface.resource = CreatePlacedSurface(desc, initialState, surface.allocation.heap, surface.allocation.offset);
+    }
+    catch (...)
+    {
+        m_allocator.Free(surface.allocation);
+        throw;
+    }
+    return surface;
+}
+
+HostHeapAllocation AtomicSurfaceHeap::CreateTransientSurfaces(const D3D12_RESOURCE_DESC* descs, const UINT* firstPass, const UINT* lastPass,
+    UINT count, D3D12_RESOURCE_STATES initialState, Surface* surfaces)
+{
+    std::vector<HostTransientSurface> plan(count);
+    for (UINT i = 0; i < count; i++)
+    {
+        plan[i].size = GetPlacementSize(descs[i]);
+        plan[i].firstPass = firstPass[i];
+        plan[i].lastPass = lastPass[i];
+        plan[i].offset = 0;
+    }
+
+    const HostHeapAllocation block = m_allocator.Allocate(HostPlanAliasing(plan.data(), count));
+    try
+    {
+        for (UINT i = 0; i < count; i++)
+        {
+            surfaces[i].resource = CreatePlacedSurface(descs[i], initialState, block.heap, block.offset + plan[i].offset);
+            surfaces[i].allocation = HostHeapAllocation{ HostHeapAllocation::InvalidHeap, 0, 0 };
+        }
+    }
+    catch (...)
+    {
+        for (UINT i = 0; i < count; i++)
+        {
+            surfaces[i].resource.Reset();
+        }
+        m_allocator.Free(block);
+        throw;
+    }
+    return block;
+}
+
+void AtomicSurfaceHeap::Release(Surface& surface)
+{
+    surface.resource.Reset();
+    m_allocator.Free(surface.allocation);
+    surface.allocation = HostHeapAllocation{ HostHeapAllocation::InvalidHeap, 0, 0 };
+}
+
+void AtomicSurfaceHeap::ReleaseTransientBlock(const HostHeapAllocation& block)
+{
+    m_allocator.Free(block);
+}
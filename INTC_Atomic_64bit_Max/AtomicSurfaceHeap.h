@@ -0,0 +1,56 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Typed 64-bit atomic textures placed in shared heaps. Heaps come from
+// INTC_D3D12_CreateHeap and surfaces from INTC_D3D12_CreatePlacedResource with
+// EmulatedTyped64bitAtomics, with offsets chosen by HostHeapSuballocator.
+// Not thread safe beyond what HostHeapSuballocator provides; callers release
+// surfaces only once the GPU is done with them.
+
+#pragma once
+
+#ifndef INTC_IGDEXT_D3D12
+#define INTC_IGDEXT_D3D12
+#endif
+#include "igdext.h"
+
+#include "HostHeapAllocator.h"
+
+class AtomicSurfaceHeap
+{
+public:
+    struct Surface
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+        HostHeapAllocation allocation;  // Invalid for surfaces in a transient block.
+    };
+
+    AtomicSurfaceHeap(ID3D12Device* device, INTCExtensionContext* context, UINT64 heapSize = HostHeapSuballocator::DefaultHeapSize);
+
+    Surface CreateSurface(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState);
+
+    // Creates count transient surfaces, surface i used by passes firstPass[i]
+    // to lastPass[i], in one block in which surfaces never live at the same
+    // time share memory (HostPlanAliasing). Before a pass starts using an
+    // aliased surface, the caller issues an aliasing barrier and fully
+    // initializes it. Returns the block to pass to ReleaseTransientBlock.
+    HostHeapAllocation CreateTransientSurfaces(const D3D12_RESOURCE_DESC* descs, const UINT* firstPass, const UINT* lastPass,
+        UINT count, D3D12_RESOURCE_STATES initialState, Surface* surfaces);
+
+    void Release(Surface& surface);
+    void ReleaseTransientBlock(const HostHeapAllocation& block);
+
+    HostHeapStats GetStats() const  { return m_allocator.GetStats(); }
+
+private:
+    UINT64 GetPlacementSize(const D3D12_RESOURCE_DESC& desc) const;
+    Microsoft::WRL::ComPtr<ID3D12Resource> CreatePlacedSurface(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState,
+        UINT32 heap, UINT64 offset);
+
+    Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+    INTCExtensionContext* m_context;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Heap>> m_heaps;
+    HostHeapSuballocator m_allocator;
+};
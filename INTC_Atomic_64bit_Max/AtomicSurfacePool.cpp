@@ -0,0 +1,74 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "stdafx.h"
+#include "AtomicSurfacePool.h"
+
+using Microsoft::WRL::ComPtr;
+
+AtomicSurfacePool::AtomicSurfacePool(ID3D12Device* device, INTCExtensionContext* context, UINT maxIdleFrames) :
+    m_device(device),
+    m_context(context),
+    m_pool(
+        [this](uint32_t surface, const HostSurfaceKey& key)
+        {
+            return CreateSurface(surface, key);
+        },
+        [this](uint32_t surface)
+        {
+            m_resources[surface].Reset();
+        },
+        maxIdleFrames)
+{
+}
+
+UINT64 AtomicSurfacePool::CreateSurface(UINT32 surface, const HostSurfaceKey& key)
+{
+    D3D12_RESOURCE_DESC texture2D = CD3DX12_RESOURCE_DESC::Tex2D(static_cast<DXGI_FORMAT>(key.format), key.width, key.height, 1, 1);
+    texture2D.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+    INTC_D3D12_RESOURCE_DESC_0001 dsResDesc1;
+    dsResDesc1.pD3D12Desc = &texture2D;
+    dsResDesc1.Texture2DArrayMipPack = FALSE;
+    dsResDesc1.EmulatedTyped64bitAtomics = key.atomic64 ? TRUE : FALSE;
+
+    const CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
+    ComPtr<ID3D12Resource> resource;
+    ThrowIfFailed(INTC_D3D12_CreateCommittedResource(
+        m_context,
+        &heapProps,
+        key.atomic64 ? D3D12_HEAP_FLAG_ALLOW_SHADER_ATOMICS : D3D12_HEAP_FLAG_NONE,
+        &dsResDesc1,
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+        nullptr,
+        IID_PPV_ARGS(&resource)));
+
+    if (surface >= m_resources.size())
+    {
+        m_resources.resize(surface + 1);
+    }
+    m_resources[surface] = resource;
+    return m_device->GetResourceAllocationInfo(0, 1, &texture2D).SizeInBytes;
+}
+
+ID3D12Resource* AtomicSurfacePool::Acquire(UINT width, UINT height, DXGI_FORMAT format, bool atomic64, UINT64 frameFence)
+{
+    const HostSurfaceKey key = { width, height, static_cast<uint32_t>(format), atomic64 };
+    return m_resources[m_pool.Acquire(key, frameFence)].Get();
+}
+
+UINT64 AtomicSurfacePool::TrimToBudget(IDXGIAdapter3* adapter)
+{
+    DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+    ThrowIfFailed(adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info));
+    if (info.CurrentUsage <= info.Budget)
+    {
+        return 0;
+    }
+
+    const UINT64 excess = info.CurrentUsage - info.Budget;
+    const UINT64 idleBytes = m_pool.GetStats().idleBytes;
+    return m_pool.Trim(idleBytes > excess ? idleBytes - excess : 0);
+}
@@ -0,0 +1,48 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Per-frame scratch textures recycled through HostSurfacePool. Textures are
+// committed with INTC_D3D12_CreateCommittedResource, with
+// EmulatedTyped64bitAtomics when the key asks for 64-bit atomics, and start in
+// UNORDERED_ACCESS. Callers leave a texture in that state when the frame that
+// acquired it ends.
+
+#pragma once
+
+#ifndef INTC_IGDEXT_D3D12
+#define INTC_IGDEXT_D3D12
+#endif
+#include "igdext.h"
+
+#include "HostSurfacePool.h"
+
+class AtomicSurfacePool
+{
+public:
+    AtomicSurfacePool(ID3D12Device* device, INTCExtensionContext* context,
+        UINT maxIdleFrames = HostSurfacePool::DefaultMaxIdleFrames);
+
+    // Valid until frameFence, the fence value signaled after the frame that
+    // uses it, has completed.
+    ID3D12Resource* Acquire(UINT width, UINT height, DXGI_FORMAT format, bool atomic64, UINT64 frameFence);
+
+    // Call once per frame.
+    void Recycle(ID3D12Fence* fence) { m_pool.Recycle(fence->GetCompletedValue()); }
+
+    // Destroys idle textures while the local segment is over budget. Returns
+    // the bytes released.
+    UINT64 TrimToBudget(IDXGIAdapter3* adapter);
+    UINT64 Trim(UINT64 maxIdleBytes) { return m_pool.Trim(maxIdleBytes); }
+
+    HostSurfacePoolStats GetStats() const { return m_pool.GetStats(); }
+
+private:
+    UINT64 CreateSurface(UINT32 surface, const HostSurfaceKey& key);
+
+    Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+    INTCExtensionContext* m_context;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_resources;
+    HostSurfacePool m_pool;
+};
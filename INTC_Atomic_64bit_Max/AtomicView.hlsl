@@ -0,0 +1,39 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+//
+// Subregion views for typed 64-bit atomics, which do not support subresource
+// regions. The application binds four 32-bit root constants (see
+// HostViewConstants in HostSurfaceView.h):
+//
+//   b0.x, b0.y   view origin in the surface
+//   b0.z, b0.w   view extent
+//
+// and dispatches ceil(extent / group size) groups. Threads address the view
+// with View_Address and skip work outside the extent with View_Contains.
+// Define ATOMIC_VIEW_REGISTER before including this file to use a register
+// other than b0.
+//
+
+#ifndef ATOMIC_VIEW_REGISTER
+#define ATOMIC_VIEW_REGISTER b0
+#endif
+
+cbuffer AtomicViewConstants : register(ATOMIC_VIEW_REGISTER)
+{
+    uint2 viewOrigin;
+    uint2 viewExtent;
+};
+
+bool View_Contains(uint2 texel)
+{
+    return all(texel < viewExtent);
+}
+
+// Surface texel of a view-relative texel.
+uint2 View_Address(uint2 texel)
+{
+    return viewOrigin + texel;
+}
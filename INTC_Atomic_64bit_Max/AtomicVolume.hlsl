@@ -0,0 +1,58 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+//
+// Volumetric (3D) addressing for typed 64-bit atomics, which do not support
+// 3D surfaces. Must match HostVolumeLayout in HostVolume.h: z slices are tiled
+// over one Texture2D, VOLUME_SLICES_PER_ROW slices per row, with texels
+// row-major within a slice or, when VOLUME_MORTON is defined, in Morton order
+// (power-of-two VOLUME_WIDTH and VOLUME_HEIGHT only).
+//
+//   #define VOLUME_WIDTH 256
+//   #define VOLUME_HEIGHT 256
+//   #define VOLUME_SLICES_PER_ROW 16
+//   #define VOLUME_MORTON
+//   #include "AtomicVolume.hlsl"
+//
+//   IntelExt_InterlockedMaxUint64(outputbuff, Volume_Address(voxel), value);
+//
+
+#ifndef VOLUME_WIDTH
+#error "Define VOLUME_WIDTH, VOLUME_HEIGHT and VOLUME_SLICES_PER_ROW before including AtomicVolume.hlsl"
+#endif
+
+// Spreads the low 16 bits of value to the even bit positions.
+uint Volume_MortonSpread(uint value)
+{
+    value &= 0xFFFF;
+    value = (value | (value << 8)) & 0x00FF00FF;
+    value = (value | (value << 4)) & 0x0F0F0F0F;
+    value = (value | (value << 2)) & 0x33333333;
+    value = (value | (value << 1)) & 0x55555555;
+    return value;
+}
+
+// Position of texel within its slice.
+uint2 Volume_SliceTexel(uint2 texel)
+{
+#ifdef VOLUME_MORTON
+    // firstbithigh of a power of two is its log2; constant-folded.
+    const uint squareBits = firstbithigh((uint)min(VOLUME_WIDTH, VOLUME_HEIGHT));
+    const uint squareMask = (1u << squareBits) - 1;
+    const uint index = Volume_MortonSpread(texel.x & squareMask) |
+        (Volume_MortonSpread(texel.y & squareMask) << 1) |
+        (((texel.x | texel.y) >> squareBits) << (2 * squareBits));
+    return uint2(index & (VOLUME_WIDTH - 1), index >> firstbithigh((uint)VOLUME_WIDTH));
+#else
+    return texel;
+#endif
+}
+
+// Surface texel of voxel.
+uint2 Volume_Address(uint3 voxel)
+{
+    const uint2 slice = uint2(voxel.z % VOLUME_SLICES_PER_ROW, voxel.z / VOLUME_SLICES_PER_ROW);
+    return slice * uint2(VOLUME_WIDTH, VOLUME_HEIGHT) + Volume_SliceTexel(voxel.xy);
+}
@@ -0,0 +1,91 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "stdafx.h"
+#include "CpuVisibleBufferManager.h"
+
+using Microsoft::WRL::ComPtr;
+
+void IntelCpuVisibleVidmemBudget::Query(uint64_t* totalBytes, uint64_t* freeBytes)
+{
+    UINT64 total = 0;
+    UINT64 free = 0;
+    INTC_D3D12_QueryCpuVisibleVidmem(m_context, &total, &free);
+    *totalBytes = total;
+    *freeBytes = free;
+}
+
+CpuVisibleBufferManager::CpuVisibleBufferManager(ID3D12Device* device, INTCExtensionContext* context, UINT64 headroom) :
+    m_device(device),
+    m_context(context),
+    m_budget(context),
+    m_manager(m_budget,
+        [this](uint32_t buffer, uint64_t size, HostBufferKind kind, HostMemoryPool pool)
+        {
+            return PlaceBuffer(buffer, size, kind, pool);
+        },
+        [this](uint32_t buffer)
+        {
+            m_resources[buffer].Reset();
+        },
+        headroom)
+{
+}
+
+bool CpuVisibleBufferManager::IsVidmemAvailable()
+{
+    uint64_t totalBytes = 0;
+    uint64_t freeBytes = 0;
+    m_budget.Query(&totalBytes, &freeBytes);
+    return totalBytes != 0;
+}
+
+bool CpuVisibleBufferManager::PlaceBuffer(UINT32 buffer, UINT64 size, HostBufferKind kind, HostMemoryPool pool)
+{
+    const bool upload = kind == HostBufferKind::Upload;
+    const CD3DX12_HEAP_PROPERTIES heapProps(upload ? D3D12_HEAP_TYPE_UPLOAD : D3D12_HEAP_TYPE_READBACK);
+    const D3D12_RESOURCE_STATES initialState = upload ? D3D12_RESOURCE_STATE_GENERIC_READ : D3D12_RESOURCE_STATE_COPY_DEST;
+    D3D12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+
+    ComPtr<ID3D12Resource> resource;
+    if (pool == HostMemoryPool::CpuVisibleVidmem)
+    {
+        INTC_D3D12_RESOURCE_DESC_0002 intcDesc = {};
+        intcDesc.pD3D12Desc = &bufferDesc;
+        intcDesc.Texture2DArrayMipPack = FALSE;
+        intcDesc.EmulatedTyped64bitAtomics = FALSE;
+        intcDesc.ResourceFlagCpuVisibleVideoMemory = TRUE;
+
+        // Running out of video memory is expected here; the manager falls
+        // back to system memory.
+        if (FAILED(INTC_D3D12_CreateCommittedResource1(m_context, &heapProps, D3D12_HEAP_FLAG_NONE, &intcDesc,
+            initialState, nullptr, IID_PPV_ARGS(&resource))))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        ThrowIfFailed(m_device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+            initialState, nullptr, IID_PPV_ARGS(&resource)));
+    }
+
+    if (buffer >= m_resources.size())
+    {
+        m_resources.resize(buffer + 1);
+    }
+    m_resources[buffer] = resource;
+    return true;
+}
+
+UINT32 CpuVisibleBufferManager::CreateBuffer(UINT64 size, HostBufferKind kind)
+{
+    return m_manager.Allocate(size, kind);
+}
+
+void CpuVisibleBufferManager::Release(UINT32 buffer)
+{
+    m_manager.Free(buffer);
+}
@@ -0,0 +1,62 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Upload and readback buffers placed by HostVidmemManager. Video memory
+// buffers are committed with INTC_D3D12_CreateCommittedResource1 and
+// ResourceFlagCpuVisibleVideoMemory; the budget comes from
+// INTC_D3D12_QueryCpuVisibleVidmem. A move recreates the resource, so callers
+// fetch it again with GetResource after Rebalance and call Rebalance only
+// once the GPU is done with every managed buffer.
+
+#pragma once
+
+#ifndef INTC_IGDEXT_D3D12
+#define INTC_IGDEXT_D3D12
+#endif
+#include "igdext.h"
+
+#include "HostVidmemManager.h"
+
+// Reports the CPU-visible video memory budget of the device.
+class IntelCpuVisibleVidmemBudget : public HostVidmemBudgetProvider
+{
+public:
+    explicit IntelCpuVisibleVidmemBudget(INTCExtensionContext* context) : m_context(context) {}
+
+    void Query(uint64_t* totalBytes, uint64_t* freeBytes) override;
+
+private:
+    INTCExtensionContext* m_context;
+};
+
+class CpuVisibleBufferManager
+{
+public:
+    CpuVisibleBufferManager(ID3D12Device* device, INTCExtensionContext* context,
+        UINT64 headroom = HostVidmemManager::DefaultHeadroom);
+
+    // Upload buffers start in GENERIC_READ, readback buffers in COPY_DEST.
+    UINT32 CreateBuffer(UINT64 size, HostBufferKind kind);
+    void Release(UINT32 buffer);
+
+    ID3D12Resource* GetResource(UINT32 buffer) const    { return m_resources[buffer].Get(); }
+    HostMemoryPool GetPool(UINT32 buffer) const         { return m_manager.GetPool(buffer); }
+
+    void Touch(UINT32 buffer)                           { m_manager.Touch(buffer); }
+    UINT32 Rebalance()                                  { return m_manager.Rebalance(); }
+    HostVidmemStats GetStats() const                    { return m_manager.GetStats(); }
+
+    // Whether the device reports any CPU-visible video memory.
+    bool IsVidmemAvailable();
+
+private:
+    bool PlaceBuffer(UINT32 buffer, UINT64 size, HostBufferKind kind, HostMemoryPool pool);
+
+    Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+    INTCExtensionContext* m_context;
+    IntelCpuVisibleVidmemBudget m_budget;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_resources;
+    HostVidmemManager m_manager;
+};
@@ -18,7 +18,20 @@ DXSample::DXSample(UINT width, UINT height, std::wstring name) :
     m_width(width),
     m_height(height),
     m_title(name),
-    m_useWarpDevice(false)
+    m_useWarpDevice(false),
+    m_runHostBenchmarks(false),
+    m_useReservedResource(false),
+    m_usePlacedResource(false),
+    m_useCpuVisibleVidmem(false),
+    m_useDirtyTiles(false),
+    m_viewOriginX(0),
+    m_viewOriginY(0),
+    m_viewWidth(0),
+    m_viewHeight(0),
+    m_presentMode(HostPresentMode::Vsync),
+    m_frameRate(0),
+    m_recordThreads(1),
+    m_useTimeline(false)
 {
     WCHAR assetsPath[512];
     GetAssetsPath(assetsPath, _countof(assetsPath));
@@ -124,5 +137,89 @@ void DXSample::ParseCommandLineArgs(WCHAR* argv[], int argc)
             m_useWarpDevice = true;
             m_title = m_title + L" (WARP)";
         }
+        else if (_wcsnicmp(argv[i], L"-hostbench", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/hostbench", wcslen(argv[i])) == 0)
+        {
+            m_runHostBenchmarks = true;
+        }
+        else if (_wcsnicmp(argv[i], L"-reserved", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/reserved", wcslen(argv[i])) == 0)
+        {
+            m_useReservedResource = true;
+        }
+        else if (_wcsnicmp(argv[i], L"-placed", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/placed", wcslen(argv[i])) == 0)
+        {
+            m_usePlacedResource = true;
+        }
+        else if (_wcsnicmp(argv[i], L"-cpuvisible", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/cpuvisible", wcslen(argv[i])) == 0)
+        {
+            m_useCpuVisibleVidmem = true;
+        }
+        else if (_wcsnicmp(argv[i], L"-dirtytiles", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/dirtytiles", wcslen(argv[i])) == 0)
+        {
+            m_useDirtyTiles = true;
+        }
+        else if ((_wcsnicmp(argv[i], L"-view", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/view", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            if (swscanf_s(argv[++i], L"%u,%u,%u,%u", &m_viewOriginX, &m_viewOriginY, &m_viewWidth, &m_viewHeight) != 4)
+            {
+                m_viewWidth = 0;
+            }
+        }
+        else if ((_wcsnicmp(argv[i], L"-dump", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/dump", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_dumpPath = argv[++i];
+        }
+        else if ((_wcsnicmp(argv[i], L"-golden", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/golden", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_goldenPath = argv[++i];
+        }
+        else if ((_wcsnicmp(argv[i], L"-present", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/present", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            const WCHAR* mode = argv[++i];
+            if (_wcsicmp(mode, L"uncapped") == 0)
+            {
+                m_presentMode = HostPresentMode::Uncapped;
+            }
+            else if (swscanf_s(mode, L"%lf", &m_frameRate) == 1 && m_frameRate > 0)
+            {
+                m_presentMode = HostPresentMode::FixedRate;
+            }
+            else
+            {
+                m_presentMode = HostPresentMode::Vsync;
+            }
+        }
+        else if (_wcsnicmp(argv[i], L"-timeline", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/timeline", wcslen(argv[i])) == 0)
+        {
+            m_useTimeline = true;
+        }
+        else if ((_wcsnicmp(argv[i], L"-trace", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/trace", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_useTimeline = true;
+            m_tracePath = argv[++i];
+        }
+        else if ((_wcsnicmp(argv[i], L"-recordthreads", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/recordthreads", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            if (swscanf_s(argv[++i], L"%u", &m_recordThreads) != 1 || m_recordThreads == 0)
+            {
+                m_recordThreads = 1;
+            }
+        }
+        else if ((_wcsnicmp(argv[i], L"-visualize", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/visualize", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_visualizeMode = argv[++i];
+        }
     }
 }
@@ -12,6 +12,7 @@
 #pragma once
 
 #include "DXSampleHelper.h"
+#include "HostFrameLoop.h"
 #include "Win32Application.h"
 
 class DXSample
@@ -33,6 +34,8 @@ public:
     UINT GetWidth() const           { return m_width; }
     UINT GetHeight() const          { return m_height; }
     const WCHAR* GetTitle() const   { return m_title.c_str(); }
+    HostPresentMode GetPresentMode() const  { return m_presentMode; }
+    double GetFrameRate() const             { return m_frameRate; }
 
     void ParseCommandLineArgs(_In_reads_(argc) WCHAR* argv[], int argc);
 
@@ -54,6 +57,54 @@ protected:
     // Adapter info.
     bool m_useWarpDevice;
 
+    // Run the host (CPU) benchmarks before initializing the pipeline.
+    bool m_runHostBenchmarks;
+
+    // Back the compute texture with a reserved (sparse) resource.
+    bool m_useReservedResource;
+
+    // Place the compute texture in a shared heap (-placed).
+    bool m_usePlacedResource;
+
+    // Place the readback buffer in CPU-visible video memory when the budget
+    // allows (-cpuvisible).
+    bool m_useCpuVisibleVidmem;
+
+    // Read back only the tiles CSMain changed (-dirtytiles).
+    bool m_useDirtyTiles;
+
+    // Compute view rectangle (-view x,y,width,height). A zero width selects
+    // the whole surface.
+    UINT m_viewOriginX;
+    UINT m_viewOriginY;
+    UINT m_viewWidth;
+    UINT m_viewHeight;
+
+    // Stream every readback of the compute view to this file (-dump path).
+    std::wstring m_dumpPath;
+
+    // Frame pacing (-present vsync|uncapped|fps). A number selects FixedRate
+    // at that many frames per second.
+    HostPresentMode m_presentMode;
+    double m_frameRate;
+
+    // Record the frame's passes on this many threads (-recordthreads n).
+    UINT m_recordThreads;
+
+    // Time the phases of startup and of each frame, and print p50/p99 per
+    // phase at exit (-timeline). -trace path also writes the last events of
+    // every thread as a Chrome trace.
+    bool m_useTimeline;
+    std::wstring m_tracePath;
+
+    // Compare every readback of the compute view with the first record of
+    // this dump file (-golden path).
+    std::wstring m_goldenPath;
+
+    // Show the compute texture through Visualize.hlsl instead of the
+    // checkerboard (-visualize low|high|log|id). Empty leaves it off.
+    std::wstring m_visualizeMode;
+
 private:
     // Root assets path.
     std::wstring m_assetsPath;
@@ -0,0 +1,189 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "stdafx.h"
+#include "DirtyTileReadback.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    const UINT64 SlotRowPitch = DirtyTileReadback::TileSize * sizeof(UINT64);
+    const UINT64 SlotBytes = SlotRowPitch * DirtyTileReadback::TileSize;
+
+    ComPtr<ID3D12Resource> CreateReadbackBuffer(ID3D12Device* device, UINT64 size)
+    {
+        const CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_READBACK);
+        const CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(size);
+        ComPtr<ID3D12Resource> buffer;
+        ThrowIfFailed(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+            D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&buffer)));
+        return buffer;
+    }
+}
+
+const UINT DirtyTileReadback::TileSize;
+
+DirtyTileReadback::DirtyTileReadback(ID3D12Device* device, INTCExtensionContext* context, UINT width, UINT height,
+    UINT slotCount, UINT frameCount) :
+    m_frameCount(frameCount),
+    m_frame(0),
+    m_mask(width, height, TileSize),
+    m_ring(slotCount),
+    m_mirror(static_cast<size_t>(width) * height, 0),
+    m_lastTileCount(0),
+    m_bytesCopied(0)
+{
+    D3D12_RESOURCE_DESC maskDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R32G32_UINT,
+        m_mask.GetMaskWidth(), m_mask.GetTilesY(), 1, 1);
+    maskDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+    INTC_D3D12_RESOURCE_DESC_0001 dsResDesc1;
+    dsResDesc1.pD3D12Desc = &maskDesc;
+    dsResDesc1.Texture2DArrayMipPack = FALSE;
+    dsResDesc1.EmulatedTyped64bitAtomics = TRUE;
+
+    const CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
+    ThrowIfFailed(INTC_D3D12_CreateCommittedResource(
+        context,
+        &heapProps,
+        D3D12_HEAP_FLAG_ALLOW_SHADER_ATOMICS,
+        &dsResDesc1,
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+        nullptr,
+        IID_PPV_ARGS(&m_maskTexture)));
+
+    UINT64 maskBytes = 0;
+    device->GetCopyableFootprints(&maskDesc, 0, 1, 0, &m_maskFootprint, nullptr, nullptr, &maskBytes);
+    m_maskSlotBytes = (maskBytes + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) & ~static_cast<UINT64>(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+    m_maskReadback = CreateReadbackBuffer(device, m_maskSlotBytes * frameCount);
+    m_staging = CreateReadbackBuffer(device, SlotBytes * slotCount);
+}
+
+void DirtyTileReadback::CreateMaskView(D3D12_CPU_DESCRIPTOR_HANDLE handle)
+{
+    ComPtr<ID3D12Device> device;
+    ThrowIfFailed(m_maskTexture->GetDevice(IID_PPV_ARGS(&device)));
+
+    D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+    uavDesc.Format = DXGI_FORMAT_R32G32_UINT;
+    uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+    device->CreateUnorderedAccessView(m_maskTexture.Get(), nullptr, &uavDesc, handle);
+}
+
+void DirtyTileReadback::SetInitialRect(UINT left, UINT top, UINT right, UINT bottom)
+{
+    m_mask.Clear();
+    m_mask.MarkRect(left, top, right, bottom);
+}
+
+void DirtyTileReadback::RecordTileCopies(ID3D12GraphicsCommandList* commandList, ID3D12Resource* surface, UINT64 frameFence,
+    D3D12_GPU_DESCRIPTOR_HANDLE maskGpuHandle, D3D12_CPU_DESCRIPTOR_HANDLE maskCpuHandle)
+{
+    PendingFrame frame = { frameFence, m_frame % m_frameCount, {} };
+    m_frame++;
+
+    // Tiles that do not fit in the ring stay dirty for a later frame.
+    m_tiles.clear();
+    m_mask.Collect(m_tiles, m_ring.GetFreeCount());
+    if (!m_tiles.empty())
+    {
+        commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(surface,
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE));
+
+        D3D12_TEXTURE_COPY_LOCATION src = {};
+        src.pResource = surface;
+        src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        src.SubresourceIndex = 0;
+
+        D3D12_TEXTURE_COPY_LOCATION dst = {};
+        dst.pResource = m_staging.Get();
+        dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        dst.PlacedFootprint.Footprint.Format = DXGI_FORMAT_R32G32_UINT;
+        dst.PlacedFootprint.Footprint.Depth = 1;
+        dst.PlacedFootprint.Footprint.RowPitch = static_cast<UINT>(SlotRowPitch);
+
+        frame.copies.reserve(m_tiles.size());
+        for (uint32_t tile : m_tiles)
+        {
+            uint32_t left;
+            uint32_t top;
+            uint32_t width;
+            uint32_t height;
+            m_mask.GetTileRect(tile, left, top, width, height);
+
+            const HostTileCopy copy = { tile, m_ring.Allocate(frameFence) };
+            dst.PlacedFootprint.Offset = copy.slot * SlotBytes;
+            dst.PlacedFootprint.Footprint.Width = width;
+            dst.PlacedFootprint.Footprint.Height = height;
+            const D3D12_BOX box = { left, top, 0, left + width, top + height, 1 };
+            commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, &box);
+
+            frame.copies.push_back(copy);
+            m_bytesCopied += static_cast<UINT64>(width) * height * sizeof(UINT64);
+        }
+
+        commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(surface,
+            D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+    }
+    m_lastTileCount = static_cast<UINT>(m_tiles.size());
+
+    const UINT clearValue[4] = {};
+    commandList->ClearUnorderedAccessViewUint(maskGpuHandle, maskCpuHandle, m_maskTexture.Get(), clearValue, 0, nullptr);
+    commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::UAV(m_maskTexture.Get()));
+
+    m_pending.push_back(std::move(frame));
+}
+
+void DirtyTileReadback::RecordMaskCopy(ID3D12GraphicsCommandList* commandList)
+{
+    commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_maskTexture.Get(),
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE));
+
+    D3D12_TEXTURE_COPY_LOCATION src = {};
+    src.pResource = m_maskTexture.Get();
+    src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    src.SubresourceIndex = 0;
+
+    D3D12_TEXTURE_COPY_LOCATION dst = {};
+    dst.pResource = m_maskReadback.Get();
+    dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    dst.PlacedFootprint = m_maskFootprint;
+    dst.PlacedFootprint.Offset = m_pending.back().maskSlot * m_maskSlotBytes;
+    commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+
+    commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_maskTexture.Get(),
+        D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+}
+
+void DirtyTileReadback::Resolve(UINT64 completedFence)
+{
+    while (!m_pending.empty() && m_pending.front().fence <= completedFence)
+    {
+        const PendingFrame& frame = m_pending.front();
+
+        if (!frame.copies.empty())
+        {
+            // Whole-ring read range: the frame's slots may wrap around.
+            UINT8* staging = nullptr;
+            ThrowIfFailed(m_staging->Map(0, nullptr, reinterpret_cast<void**>(&staging)));
+            HostPatchTiles(m_mask, m_mirror.data(), m_mask.GetWidth() * sizeof(UINT64), staging, SlotRowPitch,
+                frame.copies.data(), frame.copies.size());
+            const D3D12_RANGE writeRange = { 0, 0 };
+            m_staging->Unmap(0, &writeRange);
+        }
+
+        const SIZE_T maskOffset = static_cast<SIZE_T>(frame.maskSlot * m_maskSlotBytes);
+        const D3D12_RANGE readRange = { maskOffset, maskOffset + static_cast<SIZE_T>(m_maskSlotBytes) };
+        UINT8* mask = nullptr;
+        ThrowIfFailed(m_maskReadback->Map(0, &readRange, reinterpret_cast<void**>(&mask)));
+        m_mask.MergeWords(reinterpret_cast<const uint64_t*>(mask + maskOffset), m_maskFootprint.Footprint.RowPitch / sizeof(UINT64));
+        const D3D12_RANGE writeRange = { 0, 0 };
+        m_maskReadback->Unmap(0, &writeRange);
+
+        m_pending.pop_front();
+    }
+    m_ring.Retire(completedFence);
+}
@@ -0,0 +1,93 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Incremental readback of a 64-bit atomic surface. Shaders mark the tiles
+// they write in a GPU dirty mask (DirtyTiles.hlsl), committed with
+// INTC_D3D12_CreateCommittedResource and EmulatedTyped64bitAtomics. Each
+// frame the mask is copied back and merged into a HostDirtyTileMask; at the
+// start of the next frame the tiles it names are copied into slots of a
+// staging ring, and once that frame completes they are patched into a host
+// mirror of the surface. The mirror lags the GPU by one frame. Per frame,
+// call RecordTileCopies, dispatch, then RecordMaskCopy.
+
+#pragma once
+
+#ifndef INTC_IGDEXT_D3D12
+#define INTC_IGDEXT_D3D12
+#endif
+#include "igdext.h"
+
+#include "HostAtomics64.h"
+#include "HostDirtyTiles.h"
+
+#include <deque>
+
+class DirtyTileReadback
+{
+public:
+    // DIRTY_TILE_SIZE in DirtyTiles.hlsl; tile rows are then exactly
+    // D3D12_TEXTURE_DATA_PITCH_ALIGNMENT bytes.
+    static const UINT TileSize = 32;
+
+    // DirtyTiles_MarkGroup marks from group corners, which covers every tile
+    // a group touches only while a group spans at most 2 x 2 tiles.
+    static_assert(TileSize >= HostThreadGroupSize, "dirty tiles must be at least one thread group across");
+
+    // frameCount is the number of frames in flight.
+    DirtyTileReadback(ID3D12Device* device, INTCExtensionContext* context, UINT width, UINT height,
+        UINT slotCount, UINT frameCount);
+
+    // Writes the mask UAV (u1 by default).
+    void CreateMaskView(D3D12_CPU_DESCRIPTOR_HANDLE handle);
+
+    // The mask starts with every tile dirty. Call before the first frame to
+    // copy only the tiles of [left, right) x [top, bottom) instead, when the
+    // rest of the surface is never written or not even backed by memory.
+    void SetInitialRect(UINT left, UINT top, UINT right, UINT bottom);
+
+    // Record before the dispatch. Copies tiles dirtied by completed frames
+    // from surface, which is in UNORDERED_ACCESS, into the ring, then clears
+    // the mask through its UAV (shader-visible and CPU-only handles).
+    // frameFence is the fence value signaled after this frame.
+    void RecordTileCopies(ID3D12GraphicsCommandList* commandList, ID3D12Resource* surface, UINT64 frameFence,
+        D3D12_GPU_DESCRIPTOR_HANDLE maskGpuHandle, D3D12_CPU_DESCRIPTOR_HANDLE maskCpuHandle);
+
+    // Record after the dispatch.
+    void RecordMaskCopy(ID3D12GraphicsCommandList* commandList);
+
+    // Patches the tiles of completed frames into the mirror and merges their
+    // masks.
+    void Resolve(UINT64 completedFence);
+
+    const UINT64* GetMirror() const     { return m_mirror.data(); }
+    UINT GetMirrorPitch() const         { return m_mask.GetWidth(); }
+
+    UINT GetLastTileCount() const       { return m_lastTileCount; }
+    UINT64 GetBytesCopied() const       { return m_bytesCopied; }
+
+private:
+    struct PendingFrame
+    {
+        UINT64 fence;
+        UINT maskSlot;
+        std::vector<HostTileCopy> copies;
+    };
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_maskTexture;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_maskReadback;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_staging;
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT m_maskFootprint;
+    UINT64 m_maskSlotBytes;
+    UINT m_frameCount;
+    UINT m_frame;
+
+    HostDirtyTileMask m_mask;
+    HostTileStagingRing m_ring;
+    std::vector<UINT64> m_mirror;
+    std::deque<PendingFrame> m_pending;
+    std::vector<uint32_t> m_tiles;
+    UINT m_lastTileCount;
+    UINT64 m_bytesCopied;
+};
@@ -0,0 +1,59 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+//
+// Dirty-tile mask for incremental readback. Must match HostDirtyTileMask in
+// HostDirtyTiles.h: one bit per DIRTY_TILE_SIZE x DIRTY_TILE_SIZE tile, 64
+// tiles of a tile row per R32G32_UINT mask texel (bit n of texel x covers
+// tile 64 * x + n), set with a 64-bit atomic OR. Include after
+// IntelExtensions12.hlsl and call IntelExt_Init before marking.
+//
+// With DIRTY_GROUP_SIZE x DIRTY_GROUP_SIZE thread groups dispatched over a
+// view and tiles at least that large, a group covers at most 2 x 2 tiles,
+// which DirtyTiles_MarkGroup marks from the corner threads of the group's
+// (clipped) rectangle:
+//
+//   outputbuff[address] = value;
+//   DirtyTiles_MarkGroup(GTid, DTid.xy, viewExtent, address);
+//
+
+#ifndef DIRTY_TILES_REGISTER
+#define DIRTY_TILES_REGISTER u1
+#endif
+
+#ifndef DIRTY_TILE_SIZE
+#define DIRTY_TILE_SIZE 32
+#endif
+
+// Edge of the marking shader's thread groups: CSMain's [numthreads(32, 32, 1)]
+// and HostThreadGroupSize on the host.
+#ifndef DIRTY_GROUP_SIZE
+#define DIRTY_GROUP_SIZE 32
+#endif
+
+#if DIRTY_TILE_SIZE < DIRTY_GROUP_SIZE
+#error "DIRTY_TILE_SIZE must be at least DIRTY_GROUP_SIZE, or a group can span more than 2 x 2 tiles"
+#endif
+
+RWTexture2D<uint2> dirtyTiles : register(DIRTY_TILES_REGISTER);
+
+void DirtyTiles_Mark(uint2 address)
+{
+    uint2 tile = address / DIRTY_TILE_SIZE;
+    uint bit = tile.x & 63;
+    uint2 value = bit < 32 ? uint2(1u << bit, 0) : uint2(0, 1u << (bit - 32));
+    IntelExt_InterlockedOrUint64(dirtyTiles, uint2(tile.x / 64, tile.y), value);
+}
+
+// Marks the tiles of a group from at most nine threads: those on the first
+// row / column, last row / column or last texel of the view in both axes.
+void DirtyTiles_MarkGroup(uint2 groupThread, uint2 viewTexel, uint2 viewExtent, uint2 address)
+{
+    bool2 edge = groupThread == 0 || groupThread == DIRTY_GROUP_SIZE - 1 || viewTexel + 1 == viewExtent;
+    if (all(edge))
+    {
+        DirtyTiles_Mark(address);
+    }
+}
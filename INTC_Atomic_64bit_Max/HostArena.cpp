@@ -0,0 +1,263 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostArena.h"
+#include "HostBits.h"
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+#endif
+
+namespace
+{
+    const size_t Size2M = 2ull * 1024 * 1024;
+    const size_t Size1G = 1024ull * 1024 * 1024;
+    const size_t StandardPageSize = 4096;
+
+    // Each Map* returns nullptr when the OS cannot provide that kind of page.
+#ifdef _WIN32
+    void* MapLargePages(size_t size)
+    {
+        const size_t largePage = GetLargePageMinimum();
+        if (largePage == 0 || size % largePage != 0)
+        {
+            return nullptr;
+        }
+        // Requires SeLockMemoryPrivilege; fails cleanly without it.
+        return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    }
+
+    void* MapStandardPages(size_t size)
+    {
+        return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+#else
+    void* MapHugeTlb(size_t size, int sizeFlag)
+    {
+        void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | sizeFlag, -1, 0);
+        return base == MAP_FAILED ? nullptr : base;
+    }
+
+    void* MapStandardPages(size_t size)
+    {
+        void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return base == MAP_FAILED ? nullptr : base;
+    }
+
+    // A 2 MiB aligned standard mapping marked for transparent huge pages. The
+    // head and tail of an oversized mapping are trimmed to get the alignment.
+    void* MapTransparent(size_t size)
+    {
+        uint8_t* raw = static_cast<uint8_t*>(MapStandardPages(size + Size2M));
+        if (raw == nullptr)
+        {
+            return nullptr;
+        }
+
+        uint8_t* aligned = reinterpret_cast<uint8_t*>(AlignUp(reinterpret_cast<uintptr_t>(raw), Size2M));
+        if (aligned > raw)
+        {
+            munmap(raw, aligned - raw);
+        }
+        const size_t tail = (raw + size + Size2M) - (aligned + size);
+        if (tail > 0)
+        {
+            munmap(aligned + size, tail);
+        }
+
+        if (madvise(aligned, size, MADV_HUGEPAGE) != 0)
+        {
+            munmap(aligned, size);
+            return nullptr;
+        }
+        return aligned;
+    }
+#endif
+}
+
+const char* HostPageKindName(HostPageKind kind)
+{
+    switch (kind)
+    {
+    case HostPageKind::Huge1G:      return "1 GiB";
+    case HostPageKind::Huge2M:      return "2 MiB";
+    case HostPageKind::Transparent: return "THP";
+    case HostPageKind::Standard:    return "4 KiB";
+    }
+    return "unknown";
+}
+
+HostArena::HostArena(size_t chunkSize, HostPagePolicy policy) :
+    m_chunkSize(AlignUp(chunkSize == 0 ? DefaultChunkSize : chunkSize, Size2M)),
+    m_policy(policy),
+    m_stats()
+{
+}
+
+HostArena::~HostArena()
+{
+    Release();
+}
+
+HostArena::Chunk HostArena::MapChunk(size_t minimumSize)
+{
+    const size_t size = AlignUp(minimumSize, Size2M);
+    Chunk chunk = { nullptr, size, 0, HostPageKind::Standard };
+    bool triedHuge = false;
+
+    if (m_policy == HostPagePolicy::PreferHuge)
+    {
+#ifdef _WIN32
+        triedHuge = true;
+        chunk.base = static_cast<uint8_t*>(MapLargePages(size));
+        chunk.kind = HostPageKind::Huge2M;
+#else
+        if (size >= Size1G)
+        {
+            triedHuge = true;
+            chunk.size = AlignUp(size, Size1G);
+            chunk.base = static_cast<uint8_t*>(MapHugeTlb(chunk.size, MAP_HUGE_1GB));
+            chunk.kind = HostPageKind::Huge1G;
+        }
+        if (chunk.base == nullptr)
+        {
+            triedHuge = true;
+            chunk.size = size;
+            chunk.base = static_cast<uint8_t*>(MapHugeTlb(chunk.size, 0));
+            chunk.kind = HostPageKind::Huge2M;
+        }
+        if (chunk.base == nullptr)
+        {
+            chunk.base = static_cast<uint8_t*>(MapTransparent(chunk.size));
+            chunk.kind = HostPageKind::Transparent;
+        }
+#endif
+    }
+
+    if (chunk.base == nullptr)
+    {
+        chunk.size = AlignUp(minimumSize, StandardPageSize);
+        chunk.base = static_cast<uint8_t*>(MapStandardPages(chunk.size));
+        chunk.kind = HostPageKind::Standard;
+    }
+
+    if (chunk.base == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    if (triedHuge && chunk.kind != HostPageKind::Huge1G && chunk.kind != HostPageKind::Huge2M)
+    {
+        m_stats.hugePageFallbacks++;
+    }
+    return chunk;
+}
+
+void HostArena::UnmapChunk(const Chunk& chunk)
+{
+#ifdef _WIN32
+    VirtualFree(chunk.base, 0, MEM_RELEASE);
+#else
+    munmap(chunk.base, chunk.size);
+#endif
+}
+
+void* HostArena::Allocate(size_t size, size_t alignment)
+{
+    if (alignment < CacheLineSize)
+    {
+        alignment = CacheLineSize;
+    }
+    if ((alignment & (alignment - 1)) != 0)
+    {
+        throw std::invalid_argument("HostArena::Allocate: alignment must be a power of two");
+    }
+    if (size == 0)
+    {
+        size = 1;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Chunk* target = nullptr;
+    for (Chunk& chunk : m_chunks)
+    {
+        const size_t offset = AlignUp(reinterpret_cast<uintptr_t>(chunk.base) + chunk.used, alignment) - reinterpret_cast<uintptr_t>(chunk.base);
+        if (offset + size <= chunk.size)
+        {
+            target = &chunk;
+            break;
+        }
+    }
+
+    if (target == nullptr)
+    {
+        // Chunk bases are at least page aligned, so only larger alignments need slack.
+        const size_t slack = alignment > StandardPageSize ? alignment : 0;
+        m_chunks.push_back(MapChunk(size + slack > m_chunkSize ? size + slack : m_chunkSize));
+        target = &m_chunks.back();
+
+        m_stats.reservedBytes += target->size;
+        m_stats.chunkCount++;
+        m_stats.chunksByKind[static_cast<uint32_t>(target->kind)]++;
+    }
+
+    const uintptr_t base = reinterpret_cast<uintptr_t>(target->base);
+    const size_t offset = AlignUp(base + target->used, alignment) - base;
+
+    m_stats.paddingBytes += offset - target->used;
+    m_stats.allocatedBytes += size;
+    m_stats.allocationCount++;
+
+    target->used = offset + size;
+    return target->base + offset;
+}
+
+void HostArena::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Chunk& chunk : m_chunks)
+    {
+        chunk.used = 0;
+    }
+    m_stats.allocatedBytes = 0;
+    m_stats.paddingBytes = 0;
+    m_stats.allocationCount = 0;
+}
+
+void HostArena::Release()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const Chunk& chunk : m_chunks)
+    {
+        UnmapChunk(chunk);
+    }
+    m_chunks.clear();
+    m_stats = HostArenaStats();
+}
+
+HostArenaStats HostArena::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,98 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Arena allocator for large host buffers: emulated surfaces, readback rings
+// and trace buffers. Memory comes straight from the OS in large chunks backed
+// by huge pages where possible, so random atomics over a multi-GiB surface are
+// not dominated by TLB misses. Falls back, per chunk, from 1 GiB pages to
+// 2 MiB pages to transparent huge pages to standard pages.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+enum class HostPageKind : uint32_t
+{
+    Huge1G,         // MAP_HUGETLB | MAP_HUGE_1GB.
+    Huge2M,         // MAP_HUGETLB (2 MiB) or MEM_LARGE_PAGES on Windows.
+    Transparent,    // Standard mapping with madvise(MADV_HUGEPAGE).
+    Standard,       // Standard pages.
+};
+
+static const uint32_t HostPageKindCount = 4;
+
+const char* HostPageKindName(HostPageKind kind);
+
+enum class HostPagePolicy
+{
+    PreferHuge,     // Try the largest suitable page size first.
+    StandardOnly,   // Never ask for huge pages (baseline for comparisons).
+};
+
+struct HostArenaStats
+{
+    uint64_t reservedBytes;                     // Bytes mapped from the OS.
+    uint64_t allocatedBytes;                    // Bytes handed out, excluding alignment padding.
+    uint64_t paddingBytes;                      // Bytes lost to alignment.
+    uint64_t allocationCount;
+    uint64_t chunkCount;
+    uint64_t chunksByKind[HostPageKindCount];   // Indexed by HostPageKind.
+    uint64_t hugePageFallbacks;                 // Chunks that got a smaller page size than they asked for.
+};
+
+class HostArena
+{
+public:
+    static const size_t CacheLineSize = 64;
+    static const size_t TileAlignment = 64 * 1024;     // D3D12 tiled resource tile size.
+    static const size_t DefaultChunkSize = 64 * 1024 * 1024;
+
+    explicit HostArena(size_t chunkSize = DefaultChunkSize, HostPagePolicy policy = HostPagePolicy::PreferHuge);
+    ~HostArena();
+
+    HostArena(const HostArena&) = delete;
+    HostArena& operator=(const HostArena&) = delete;
+
+    // Returns size bytes aligned to alignment (a power of two, raised to at
+    // least CacheLineSize). Allocations larger than the chunk size get a
+    // dedicated chunk. Fresh memory is zeroed; memory reused after Reset is not.
+    // Throws std::bad_alloc when the OS refuses the mapping.
+    void* Allocate(size_t size, size_t alignment = CacheLineSize);
+
+    template <typename T>
+    T* AllocateArray(size_t count, size_t alignment = CacheLineSize)
+    {
+        return static_cast<T*>(Allocate(count * sizeof(T), alignment < alignof(T) ? alignof(T) : alignment));
+    }
+
+    // Rewinds every chunk. Memory stays mapped and is reused by later allocations.
+    void Reset();
+
+    // Unmaps every chunk.
+    void Release();
+
+    HostArenaStats GetStats() const;
+
+private:
+    struct Chunk
+    {
+        uint8_t* base;
+        size_t size;
+        size_t used;
+        HostPageKind kind;
+    };
+
+    Chunk MapChunk(size_t minimumSize);
+    static void UnmapChunk(const Chunk& chunk);
+
+    mutable std::mutex m_mutex;
+    size_t m_chunkSize;
+    HostPagePolicy m_policy;
+    std::vector<Chunk> m_chunks;
+    HostArenaStats m_stats;
+};
@@ -0,0 +1,79 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostAtlas.h"
+#include "HostParallel.h"
+
+#include <stdexcept>
+
+// A 512 x 256 base with 4 mips and 2 slices: the mip column (128 + 64 + 32)
+// fits beside mip 0, so slices are 256 rows apart. AtomicAtlas.hlsl gives the
+// same origins for the same defines.
+namespace
+{
+    constexpr HostAtlasLayout ExampleLayout = { 512, 256, 2, 4 };
+    constexpr HostAtlasLayout TallColumnLayout = { 16, 4, 3, 5 };
+}
+
+static_assert(HostFullMipCount(512, 256) == 10, "full mip chain");
+static_assert(ExampleLayout.IsValid(), "layout is valid");
+static_assert(ExampleLayout.MipColumnHeight() == 224, "mip column height");
+static_assert(ExampleLayout.AtlasWidth() == 768, "atlas width");
+static_assert(ExampleLayout.AtlasHeight() == 512, "atlas height");
+static_assert(ExampleLayout.Origin(0, 0).x == 0 && ExampleLayout.Origin(0, 0).y == 0, "mip 0");
+static_assert(ExampleLayout.Origin(0, 1).x == 512 && ExampleLayout.Origin(0, 1).y == 0, "mip 1");
+static_assert(ExampleLayout.Origin(0, 3).x == 512 && ExampleLayout.Origin(0, 3).y == 192, "mip 3");
+static_assert(ExampleLayout.Origin(1, 2).x == 512 && ExampleLayout.Origin(1, 2).y == 384, "slice 1, mip 2");
+static_assert(ExampleLayout.Address(1, 3, 5, 7).x == 517 && ExampleLayout.Address(1, 3, 5, 7).y == 455, "address");
+
+// A wide base whose full mip column (2 + 1 + 1 + 1) is taller than mip 0.
+static_assert(TallColumnLayout.SliceHeight() == 5, "column sets the slice height");
+static_assert(TallColumnLayout.AtlasWidth() == 24 && TallColumnLayout.AtlasHeight() == 15, "atlas size");
+static_assert(TallColumnLayout.Origin(2, 4).y == 14, "last mip of the last slice");
+static_assert(!HostAtlasLayout{ 16, 4, 3, 6 }.IsValid(), "more mips than the chain has");
+
+void HostBuildAtlasMips(HostAtomicSurface64& surface, const HostAtlasLayout& layout, uint32_t slice, HostAtomicOp op)
+{
+    if (!layout.IsValid() || slice >= layout.arraySize ||
+        layout.AtlasWidth() > surface.GetWidth() || layout.AtlasHeight() > surface.GetHeight())
+    {
+        throw std::invalid_argument("HostBuildAtlasMips: layout does not fit the surface");
+    }
+
+    for (uint32_t level = 1; level < layout.mipLevels; level++)
+    {
+        const HostTexelCoord source = layout.Origin(slice, level - 1);
+        const HostTexelCoord destination = layout.Origin(slice, level);
+        const uint32_t sourceWidth = layout.MipWidth(level - 1);
+        const uint32_t sourceHeight = layout.MipHeight(level - 1);
+        const uint32_t width = layout.MipWidth(level);
+        const uint32_t height = layout.MipHeight(level);
+
+        // Rows of one level are independent; levels run in order.
+        HostParallelRanges(height, HostWorkerCount(), [&](uint32_t, size_t begin, size_t end)
+        {
+            for (uint32_t y = static_cast<uint32_t>(begin); y < end; y++)
+            {
+                const uint32_t y0 = y * 2;
+                const uint32_t y1 = (y + 1 == height) ? sourceHeight : y0 + 2;
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    const uint32_t x0 = x * 2;
+                    const uint32_t x1 = (x + 1 == width) ? sourceWidth : x0 + 2;
+
+                    uint64_t result = surface.Load(source.x + x0, source.y + y0);
+                    for (uint32_t sy = y0; sy < y1; sy++)
+                    {
+                        for (uint32_t sx = (sy == y0 ? x0 + 1 : x0); sx < x1; sx++)
+                        {
+                            result = HostAtomicCombine(op, result, surface.Load(source.x + sx, source.y + sy));
+                        }
+                    }
+                    surface.Store(destination.x + x, destination.y + y, result);
+                }
+            }
+        });
+    }
+}
@@ -0,0 +1,100 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Texture2D-array and mip-chain atlas. Typed 64-bit atomics only support a
+// single 2D subresource, so array slices and mip levels are packed into one
+// R32G32_UINT surface:
+//
+//   +---------------+-------+
+//   |               | mip 1 |   slice 0
+//   |     mip 0     +---+---+
+//   |               |m2 |
+//   |               +-+-+
+//   |               |.|
+//   +---------------+-------+
+//   |     mip 0     | mip 1 |   slice 1
+//   ...
+//
+// Mip 0 sits at the left of each slice, mips 1..N-1 are stacked in a column to
+// its right and slices are stacked vertically. AtomicAtlas.hlsl implements the
+// same mapping for shaders; every helper is constexpr so addresses with
+// constant arguments fold at compile time on both sides.
+
+#pragma once
+
+#include "HostAtomics64.h"
+
+// Full mip chain for a width x height base level.
+constexpr uint32_t HostFullMipCount(uint32_t width, uint32_t height)
+{
+    uint32_t levels = 1;
+    for (uint32_t size = width > height ? width : height; size > 1; size >>= 1)
+    {
+        levels++;
+    }
+    return levels;
+}
+
+struct HostAtlasLayout
+{
+    uint32_t width;         // Mip 0 width.
+    uint32_t height;        // Mip 0 height.
+    uint32_t arraySize;
+    uint32_t mipLevels;
+
+    static constexpr uint32_t MaxDimension = 16384;    // D3D12 2D texture limit.
+
+    static constexpr uint32_t MaxOf(uint32_t a, uint32_t b) { return a > b ? a : b; }
+
+    constexpr uint32_t MipWidth(uint32_t level) const   { return MaxOf(width >> level, 1); }
+    constexpr uint32_t MipHeight(uint32_t level) const  { return MaxOf(height >> level, 1); }
+
+    // Height of the mip 1..N-1 column.
+    constexpr uint32_t MipColumnHeight() const
+    {
+        uint32_t columnHeight = 0;
+        for (uint32_t level = 1; level < mipLevels; level++)
+        {
+            columnHeight += MipHeight(level);
+        }
+        return columnHeight;
+    }
+
+    constexpr uint32_t SliceHeight() const  { return MaxOf(height, MipColumnHeight()); }
+    constexpr uint32_t AtlasWidth() const   { return width + (mipLevels > 1 ? MipWidth(1) : 0); }
+    constexpr uint32_t AtlasHeight() const  { return SliceHeight() * arraySize; }
+
+    // Top-left corner of (slice, level) in the atlas.
+    constexpr HostTexelCoord Origin(uint32_t slice, uint32_t level) const
+    {
+        uint32_t y = slice * SliceHeight();
+        for (uint32_t i = 1; i < level; i++)
+        {
+            y += MipHeight(i);
+        }
+        return HostTexelCoord{ level == 0 ? 0 : width, y };
+    }
+
+    // Atlas texel of texel (x, y) of (slice, level).
+    constexpr HostTexelCoord Address(uint32_t slice, uint32_t level, uint32_t x, uint32_t y) const
+    {
+        const HostTexelCoord origin = Origin(slice, level);
+        return HostTexelCoord{ origin.x + x, origin.y + y };
+    }
+
+    constexpr bool IsValid() const
+    {
+        return width != 0 && height != 0 && arraySize != 0 &&
+            mipLevels != 0 && mipLevels <= HostFullMipCount(width, height) &&
+            AtlasWidth() <= MaxDimension && AtlasHeight() <= MaxDimension;
+    }
+};
+
+// Builds mips 1..N-1 of one slice from mip 0 by combining each 2x2 footprint
+// with op (Min or Max for depth pyramids; Add, And, Or and Xor also work).
+// Odd edges fold the last row / column into the last output texel, so every
+// source texel contributes. Throws std::invalid_argument when the layout is
+// invalid or does not fit the surface.
+void HostBuildAtlasMips(HostAtomicSurface64& surface, const HostAtlasLayout& layout, uint32_t slice, HostAtomicOp op);
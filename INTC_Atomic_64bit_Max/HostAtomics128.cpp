@@ -0,0 +1,202 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostAtomics128.h"
+
+#include <stdexcept>
+
+namespace
+{
+#ifdef HOST_ATOMICS_CMPXCHG16B
+    // Compares the 16 bytes at dest with expected and, if equal, stores desired.
+    // On failure expected receives the current contents. dest must be 16-byte aligned.
+    inline bool CompareExchange128(void* dest, uint64_t expected[2], const uint64_t desired[2])
+    {
+#if defined(_MSC_VER)
+        return _InterlockedCompareExchange128(
+            static_cast<volatile long long*>(dest),
+            static_cast<long long>(desired[1]),
+            static_cast<long long>(desired[0]),
+            reinterpret_cast<long long*>(expected)) != 0;
+#else
+        struct Pair { uint64_t lo; uint64_t hi; };
+        bool exchanged;
+        __asm__ __volatile__(
+            "lock cmpxchg16b %1"
+            : "=@ccz"(exchanged), "+m"(*static_cast<volatile Pair*>(dest)), "+a"(expected[0]), "+d"(expected[1])
+            : "b"(desired[0]), "c"(desired[1])
+            : "memory");
+        return exchanged;
+#endif
+    }
+#endif
+}
+
+HostAtomicSurface128::HostAtomicSurface128(uint32_t width, uint32_t height, HostAtomic128Backend backend) :
+    m_width(width),
+    m_height(height),
+    m_backend(backend)
+{
+    if (width == 0 || height == 0)
+    {
+        throw std::invalid_argument("HostAtomicSurface128: empty surface");
+    }
+
+#ifdef HOST_ATOMICS_CMPXCHG16B
+    if (m_backend == HostAtomic128Backend::Auto)
+    {
+        m_backend = HostAtomic128Backend::Cmpxchg16b;
+    }
+#else
+    if (m_backend == HostAtomic128Backend::Cmpxchg16b)
+    {
+        throw std::invalid_argument("HostAtomicSurface128: cmpxchg16b is not available on this target");
+    }
+    m_backend = HostAtomic128Backend::SequenceLock;
+#endif
+
+    const size_t count = static_cast<size_t>(width) * height;
+    m_texels.reset(new Texel[count]());
+    if (m_backend == HostAtomic128Backend::SequenceLock)
+    {
+        m_sequence.reset(new std::atomic<uint32_t>[count]());
+    }
+}
+
+uint32_t HostAtomicSurface128::LockTexel(size_t index)
+{
+    std::atomic<uint32_t>& sequence = m_sequence[index];
+    uint32_t observed = sequence.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        if ((observed & 1) == 0 &&
+            sequence.compare_exchange_weak(observed, observed + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            // Orders the odd sequence before the key and payload stores, so
+            // a reader that sees a new key also sees the sequence change.
+            std::atomic_thread_fence(std::memory_order_release);
+            return observed;
+        }
+        HostCpuPause();
+        observed = sequence.load(std::memory_order_relaxed);
+    }
+}
+
+void HostAtomicSurface128::UnlockTexel(size_t index, uint32_t sequence)
+{
+    m_sequence[index].store(sequence + 2, std::memory_order_release);
+}
+
+// Replaces the texel with value when wins(current) holds. Returns the texel
+// as observed by the final (successful or losing) comparison.
+template <typename Wins>
+HostKeyPayload128 HostAtomicSurface128::Update(size_t index, HostKeyPayload128 value, Wins wins)
+{
+    Texel& texel = m_texels[index];
+
+#ifdef HOST_ATOMICS_CMPXCHG16B
+    if (m_backend == HostAtomic128Backend::Cmpxchg16b)
+    {
+        // The initial read may be torn, so only a compare-exchange decides the
+        // result: a win installs value, and a loss is confirmed by one that
+        // rewrites the snapshot unchanged.
+        uint64_t expected[2] = { texel.key.load(std::memory_order_relaxed), texel.payload.load(std::memory_order_relaxed) };
+        const uint64_t desired[2] = { value.key, value.payload };
+        for (;;)
+        {
+            if (wins(expected[0]))
+            {
+                if (CompareExchange128(&texel, expected, desired))
+                {
+                    break;
+                }
+            }
+            else
+            {
+                const uint64_t snapshot[2] = { expected[0], expected[1] };
+                if (CompareExchange128(&texel, expected, snapshot))
+                {
+                    break;
+                }
+            }
+        }
+        return { expected[0], expected[1] };
+    }
+#endif
+
+    const uint32_t sequence = LockTexel(index);
+    const HostKeyPayload128 original = { texel.key.load(std::memory_order_relaxed), texel.payload.load(std::memory_order_relaxed) };
+    if (wins(original.key))
+    {
+        texel.key.store(value.key, std::memory_order_relaxed);
+        texel.payload.store(value.payload, std::memory_order_relaxed);
+    }
+    UnlockTexel(index, sequence);
+    return original;
+}
+
+HostKeyPayload128 HostAtomicSurface128::Load(uint32_t x, uint32_t y) const
+{
+    const size_t index = Index(x, y);
+    Texel& texel = m_texels[index];
+
+#ifdef HOST_ATOMICS_CMPXCHG16B
+    if (m_backend == HostAtomic128Backend::Cmpxchg16b)
+    {
+        // A compare-exchange that can only fail (or rewrite the same value) is
+        // the architectural way to read 16 bytes atomically.
+        uint64_t expected[2] = { 0, 0 };
+        const uint64_t desired[2] = { 0, 0 };
+        CompareExchange128(&texel, expected, desired);
+        return { expected[0], expected[1] };
+    }
+#endif
+
+    const std::atomic<uint32_t>& sequence = m_sequence[index];
+    for (;;)
+    {
+        const uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            HostCpuPause();
+            continue;
+        }
+        const HostKeyPayload128 value = { texel.key.load(std::memory_order_relaxed), texel.payload.load(std::memory_order_relaxed) };
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before)
+        {
+            return value;
+        }
+    }
+}
+
+void HostAtomicSurface128::Store(uint32_t x, uint32_t y, HostKeyPayload128 value)
+{
+    InterlockedExchange(x, y, value);
+}
+
+void HostAtomicSurface128::Clear(HostKeyPayload128 value)
+{
+    const size_t count = static_cast<size_t>(m_width) * m_height;
+    for (size_t i = 0; i < count; i++)
+    {
+        Update(i, value, [](uint64_t) { return true; });
+    }
+}
+
+HostKeyPayload128 HostAtomicSurface128::InterlockedMaxKey(uint32_t x, uint32_t y, HostKeyPayload128 value)
+{
+    return Update(Index(x, y), value, [&](uint64_t current) { return value.key > current; });
+}
+
+HostKeyPayload128 HostAtomicSurface128::InterlockedMinKey(uint32_t x, uint32_t y, HostKeyPayload128 value)
+{
+    return Update(Index(x, y), value, [&](uint64_t current) { return value.key < current; });
+}
+
+HostKeyPayload128 HostAtomicSurface128::InterlockedExchange(uint32_t x, uint32_t y, HostKeyPayload128 value)
+{
+    return Update(Index(x, y), value, [](uint64_t) { return true; });
+}
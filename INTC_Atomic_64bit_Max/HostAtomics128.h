@@ -0,0 +1,99 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Host 128-bit (uint4) paired atomics for depth-plus-payload workloads.
+// A texel holds a 64-bit key in .xy and a 64-bit payload in .zw. The key
+// decides the winner and the payload is carried with it in the same atomic,
+// so a reader can never observe the key of one writer with the payload of
+// another.
+
+#pragma once
+
+#include "HostAtomics64.h"
+
+#if (defined(_MSC_VER) && defined(_M_X64)) || (defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)))
+#define HOST_ATOMICS_CMPXCHG16B 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+struct HostKeyPayload128
+{
+    uint64_t key;
+    uint64_t payload;
+};
+
+// Mirror of the HLSL uint4 layout of a 128-bit texel.
+struct HostUint4
+{
+    uint32_t x;    // Key low 32 bits.
+    uint32_t y;    // Key high 32 bits.
+    uint32_t z;    // Payload low 32 bits.
+    uint32_t w;    // Payload high 32 bits.
+};
+
+inline HostKeyPayload128 PackUint4(HostUint4 value)
+{
+    return { PackUint2({ value.x, value.y }), PackUint2({ value.z, value.w }) };
+}
+
+inline HostUint4 UnpackUint4(HostKeyPayload128 value)
+{
+    const HostUint2 key = UnpackUint2(value.key);
+    const HostUint2 payload = UnpackUint2(value.payload);
+    return { key.x, key.y, payload.x, payload.y };
+}
+
+enum class HostAtomic128Backend
+{
+    Auto,           // cmpxchg16b where available, otherwise the sequence lock.
+    Cmpxchg16b,     // Requires HOST_ATOMICS_CMPXCHG16B.
+    SequenceLock,   // Portable: 64-bit words behind a per-texel 32-bit sequence lock.
+};
+
+class HostAtomicSurface128
+{
+public:
+    HostAtomicSurface128(uint32_t width, uint32_t height, HostAtomic128Backend backend = HostAtomic128Backend::Auto);
+
+    uint32_t GetWidth() const                   { return m_width; }
+    uint32_t GetHeight() const                  { return m_height; }
+    HostAtomic128Backend GetBackend() const     { return m_backend; }
+
+    HostKeyPayload128 Load(uint32_t x, uint32_t y) const;
+    void Store(uint32_t x, uint32_t y, HostKeyPayload128 value);
+    void Clear(HostKeyPayload128 value);
+
+    // Host counterparts of IntelExt_InterlockedMaxUint64 / IntelExt_InterlockedMinUint64
+    // for a key with a carried payload. The texel is replaced only when the
+    // new key is strictly greater (or less); ties keep the stored payload.
+    // Both return the texel as it was before the operation.
+    HostKeyPayload128 InterlockedMaxKey(uint32_t x, uint32_t y, HostKeyPayload128 value);
+    HostKeyPayload128 InterlockedMinKey(uint32_t x, uint32_t y, HostKeyPayload128 value);
+
+    HostKeyPayload128 InterlockedExchange(uint32_t x, uint32_t y, HostKeyPayload128 value);
+
+private:
+    struct alignas(16) Texel
+    {
+        std::atomic<uint64_t> key;
+        std::atomic<uint64_t> payload;
+    };
+
+    size_t Index(uint32_t x, uint32_t y) const { return static_cast<size_t>(y) * m_width + x; }
+
+    template <typename Wins>
+    HostKeyPayload128 Update(size_t index, HostKeyPayload128 value, Wins wins);
+
+    uint32_t LockTexel(size_t index);
+    void UnlockTexel(size_t index, uint32_t sequence);
+
+    uint32_t m_width;
+    uint32_t m_height;
+    HostAtomic128Backend m_backend;
+    std::unique_ptr<Texel[]> m_texels;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_sequence;    // Only allocated for SequenceLock.
+};
@@ -0,0 +1,465 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostAtomics64.h"
+#include "HostArena.h"
+
+#include <new>
+#include <stdexcept>
+
+const char* HostAtomicOpName(HostAtomicOp op)
+{
+    switch (op)
+    {
+    case HostAtomicOp::Add:             return "Add";
+    case HostAtomicOp::Min:             return "Min";
+    case HostAtomicOp::Max:             return "Max";
+    case HostAtomicOp::CompareExchange: return "CompareExchange";
+    case HostAtomicOp::Exchange:        return "Exchange";
+    case HostAtomicOp::And:             return "And";
+    case HostAtomicOp::Or:              return "Or";
+    case HostAtomicOp::Xor:             return "Xor";
+    }
+    return "Unknown";
+}
+
+//
+// HostStatCounter
+//
+
+namespace
+{
+    std::atomic<uint32_t> s_nextStatSlot(0);
+
+    // Constructs count zeroed atomics in arena memory aligned to whole tiles.
+    template <typename T>
+    std::atomic<T>* AllocateAtomics(HostArena& arena, size_t count)
+    {
+        std::atomic<T>* storage = arena.AllocateArray<std::atomic<T>>(count, HostArena::TileAlignment);
+        for (size_t i = 0; i < count; i++)
+        {
+            new (&storage[i]) std::atomic<T>(0);
+        }
+        return storage;
+    }
+}
+
+void HostStatCounter::Add(uint64_t count)
+{
+    // A locked add, so threads that share a slot once there are more than
+    // SlotCount of them still count exactly. Each thread normally owns its
+    // slot, so the line is not contended.
+    thread_local const uint32_t slot = s_nextStatSlot.fetch_add(1, std::memory_order_relaxed) % SlotCount;
+    m_slots[slot].value.fetch_add(count, std::memory_order_relaxed);
+}
+
+uint64_t HostStatCounter::Get() const
+{
+    uint64_t total = 0;
+    for (const Slot& slot : m_slots)
+    {
+        total += slot.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void HostStatCounter::Reset()
+{
+    for (Slot& slot : m_slots)
+    {
+        slot.value.store(0, std::memory_order_relaxed);
+    }
+}
+
+//
+// HostAtomicSurface64
+//
+
+HostAtomicSurface64::HostAtomicSurface64(uint32_t width, uint32_t height, HostArena* arena) :
+    m_width(width),
+    m_height(height),
+    m_texels(nullptr)
+{
+    if (width == 0 || height == 0)
+    {
+        throw std::invalid_argument("HostAtomicSurface64: empty surface");
+    }
+
+    const size_t count = static_cast<size_t>(width) * height;
+    if (arena != nullptr)
+    {
+        m_texels = AllocateAtomics<uint64_t>(*arena, count);
+    }
+    else
+    {
+        m_ownedTexels.reset(new std::atomic<uint64_t>[count]());
+        m_texels = m_ownedTexels.get();
+    }
+}
+
+uint64_t HostAtomicSurface64::Load(uint32_t x, uint32_t y) const
+{
+    return m_texels[Index(x, y)].load(std::memory_order_relaxed);
+}
+
+void HostAtomicSurface64::Store(uint32_t x, uint32_t y, uint64_t value)
+{
+    m_texels[Index(x, y)].store(value, std::memory_order_relaxed);
+}
+
+void HostAtomicSurface64::Clear(uint64_t value)
+{
+    const size_t count = static_cast<size_t>(m_width) * m_height;
+    for (size_t i = 0; i < count; i++)
+    {
+        m_texels[i].store(value, std::memory_order_relaxed);
+    }
+}
+
+uint64_t HostAtomicSurface64::InterlockedAdd(uint32_t x, uint32_t y, uint64_t value)
+{
+    return m_texels[Index(x, y)].fetch_add(value);
+}
+
+uint64_t HostAtomicSurface64::InterlockedMin(uint32_t x, uint32_t y, uint64_t value)
+{
+    std::atomic<uint64_t>& texel = m_texels[Index(x, y)];
+    uint64_t current = texel.load(std::memory_order_relaxed);
+    while (value < current && !texel.compare_exchange_weak(current, value))
+    {
+    }
+    return current;
+}
+
+uint64_t HostAtomicSurface64::InterlockedMax(uint32_t x, uint32_t y, uint64_t value)
+{
+    std::atomic<uint64_t>& texel = m_texels[Index(x, y)];
+    uint64_t current = texel.load(std::memory_order_relaxed);
+    while (value > current && !texel.compare_exchange_weak(current, value))
+    {
+    }
+    return current;
+}
+
+uint64_t HostAtomicSurface64::InterlockedAnd(uint32_t x, uint32_t y, uint64_t value)
+{
+    return m_texels[Index(x, y)].fetch_and(value);
+}
+
+uint64_t HostAtomicSurface64::InterlockedOr(uint32_t x, uint32_t y, uint64_t value)
+{
+    return m_texels[Index(x, y)].fetch_or(value);
+}
+
+uint64_t HostAtomicSurface64::InterlockedXor(uint32_t x, uint32_t y, uint64_t value)
+{
+    return m_texels[Index(x, y)].fetch_xor(value);
+}
+
+uint64_t HostAtomicSurface64::InterlockedExchange(uint32_t x, uint32_t y, uint64_t value)
+{
+    return m_texels[Index(x, y)].exchange(value);
+}
+
+uint64_t HostAtomicSurface64::InterlockedCompareExchange(uint32_t x, uint32_t y, uint64_t cmpValue, uint64_t xchgValue)
+{
+    m_texels[Index(x, y)].compare_exchange_strong(cmpValue, xchgValue);
+    return cmpValue;
+}
+
+uint64_t HostAtomicSurface64::Apply(HostAtomicOp op, uint32_t x, uint32_t y, uint64_t value, uint64_t xchgValue)
+{
+    switch (op)
+    {
+    case HostAtomicOp::Add:             return InterlockedAdd(x, y, value);
+    case HostAtomicOp::Min:             return InterlockedMin(x, y, value);
+    case HostAtomicOp::Max:             return InterlockedMax(x, y, value);
+    case HostAtomicOp::CompareExchange: return InterlockedCompareExchange(x, y, value, xchgValue);
+    case HostAtomicOp::Exchange:        return InterlockedExchange(x, y, value);
+    case HostAtomicOp::And:             return InterlockedAnd(x, y, value);
+    case HostAtomicOp::Or:              return InterlockedOr(x, y, value);
+    case HostAtomicOp::Xor:             return InterlockedXor(x, y, value);
+    }
+    return 0;
+}
+
+//
+// HostEmulatedAtomicSurface64
+//
+
+HostEmulatedAtomicSurface64::HostEmulatedAtomicSurface64(uint32_t width, uint32_t height, HostArena* arena) :
+    m_width(width),
+    m_height(height),
+    m_words(nullptr),
+    m_sequence(nullptr),
+    m_monotoneFilter(false)
+{
+    if (width == 0 || height == 0)
+    {
+        throw std::invalid_argument("HostEmulatedAtomicSurface64: empty surface");
+    }
+
+    // Words and sequence counters share one allocation: 3 x 32 bits per texel.
+    const size_t count = static_cast<size_t>(width) * height;
+    if (arena != nullptr)
+    {
+        m_words = AllocateAtomics<uint32_t>(*arena, count * 3);
+    }
+    else
+    {
+        m_ownedStorage.reset(new std::atomic<uint32_t>[count * 3]());
+        m_words = m_ownedStorage.get();
+    }
+    m_sequence = m_words + count * 2;
+}
+
+// Spins until the sequence counter is even, then makes it odd. Returns the
+// even value that was observed so UnlockTexel can publish the next one.
+uint32_t HostEmulatedAtomicSurface64::LockTexel(size_t index)
+{
+    std::atomic<uint32_t>& sequence = m_sequence[index];
+    uint32_t observed = sequence.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        if ((observed & 1) == 0 &&
+            sequence.compare_exchange_weak(observed, observed + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            // Orders the odd sequence before the word stores that follow, so a
+            // reader that sees new words also sees the sequence change.
+            std::atomic_thread_fence(std::memory_order_release);
+            return observed;
+        }
+        HostCpuPause();
+        observed = sequence.load(std::memory_order_relaxed);
+    }
+}
+
+void HostEmulatedAtomicSurface64::UnlockTexel(size_t index, uint32_t sequence)
+{
+    m_sequence[index].store(sequence + 2, std::memory_order_release);
+}
+
+uint64_t HostEmulatedAtomicSurface64::ReadWords(size_t index) const
+{
+    const uint32_t lo = m_words[index * 2].load(std::memory_order_relaxed);
+    const uint32_t hi = m_words[index * 2 + 1].load(std::memory_order_relaxed);
+    return PackUint2({ lo, hi });
+}
+
+void HostEmulatedAtomicSurface64::WriteWords(size_t index, uint64_t value)
+{
+    const HostUint2 words = UnpackUint2(value);
+    m_words[index * 2].store(words.x, std::memory_order_relaxed);
+    m_words[index * 2 + 1].store(words.y, std::memory_order_relaxed);
+}
+
+uint64_t HostEmulatedAtomicSurface64::Modify(HostAtomicOp op, size_t index, uint64_t value)
+{
+    const uint32_t sequence = LockTexel(index);
+    const uint64_t original = ReadWords(index);
+    const uint64_t result = HostAtomicCombine(op, original, value);
+    if (result != original)
+    {
+        WriteWords(index, result);
+    }
+    UnlockTexel(index, sequence);
+    return original;
+}
+
+// Single optimistic seqlock read. Fails if a writer held or took the texel.
+bool HostEmulatedAtomicSurface64::TryReadStable(size_t index, uint64_t& value) const
+{
+    const std::atomic<uint32_t>& sequence = m_sequence[index];
+    const uint32_t before = sequence.load(std::memory_order_acquire);
+    if (before & 1)
+    {
+        return false;
+    }
+    value = ReadWords(index);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return sequence.load(std::memory_order_relaxed) == before;
+}
+
+// Test-and-test-and-set min/max. A stable read that already satisfies the
+// update is a valid linearization point, so returning it is exact.
+uint64_t HostEmulatedAtomicSurface64::FilteredMinMax(HostAtomicOp op, size_t index, uint64_t value)
+{
+    // One count per operation, on whichever path it takes.
+    uint64_t current;
+    if (TryReadStable(index, current) && HostAtomicCombine(op, current, value) == current)
+    {
+        m_filterSkipped.Add(1);
+        return current;
+    }
+    m_filterLocked.Add(1);
+    return Modify(op, index, value);
+}
+
+uint32_t HostEmulatedAtomicSurface64::InterlockedGroup(HostAtomicOp op, uint32_t originX, uint32_t originY, const uint64_t* values,
+    uint32_t groupWidth, uint32_t groupHeight)
+{
+    if (op != HostAtomicOp::Min && op != HostAtomicOp::Max)
+    {
+        throw std::invalid_argument("HostEmulatedAtomicSurface64::InterlockedGroup: only Min and Max are monotone");
+    }
+
+    const uint32_t endX = originX < m_width ? (groupWidth < m_width - originX ? originX + groupWidth : m_width) : originX;
+    const uint32_t endY = originY < m_height ? (groupHeight < m_height - originY ? originY + groupHeight : m_height) : originY;
+
+    // Snapshot the group's tile with read-only loads first. Texels that could
+    // not be read consistently are marked so they always take the locked path.
+    const uint32_t spanX = endX - originX;
+    const uint32_t spanY = endY - originY;
+    uint64_t snapshot[HostThreadGroupSize * HostThreadGroupSize];
+    bool stable[HostThreadGroupSize * HostThreadGroupSize];
+    const bool useSnapshot = spanX * spanY <= HostThreadGroupSize * HostThreadGroupSize;
+    if (useSnapshot)
+    {
+        for (uint32_t j = 0; j < spanY; j++)
+        {
+            for (uint32_t i = 0; i < spanX; i++)
+            {
+                stable[j * spanX + i] = TryReadStable(Index(originX + i, originY + j), snapshot[j * spanX + i]);
+            }
+        }
+    }
+
+    uint32_t updated = 0;
+    for (uint32_t j = 0; j < spanY; j++)
+    {
+        const uint64_t* row = values + static_cast<size_t>(j) * groupWidth;
+        for (uint32_t i = 0; i < spanX; i++)
+        {
+            const uint64_t value = row[i];
+            const uint32_t lane = j * spanX + i;
+            if (useSnapshot && stable[lane] && HostAtomicCombine(op, snapshot[lane], value) == snapshot[lane])
+            {
+                continue;
+            }
+            Modify(op, Index(originX + i, originY + j), value);
+            updated++;
+        }
+    }
+
+    const uint32_t candidates = spanX * spanY;
+    m_filterLocked.Add(updated);
+    m_filterSkipped.Add(candidates - updated);
+    return updated;
+}
+
+void HostEmulatedAtomicSurface64::ResetFilterStats()
+{
+    m_filterSkipped.Reset();
+    m_filterLocked.Reset();
+}
+
+uint64_t HostEmulatedAtomicSurface64::Load(uint32_t x, uint32_t y) const
+{
+    const size_t index = Index(x, y);
+    const std::atomic<uint32_t>& sequence = m_sequence[index];
+    for (;;)
+    {
+        const uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            HostCpuPause();
+            continue;
+        }
+        const uint64_t value = ReadWords(index);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before)
+        {
+            return value;
+        }
+    }
+}
+
+void HostEmulatedAtomicSurface64::Store(uint32_t x, uint32_t y, uint64_t value)
+{
+    const size_t index = Index(x, y);
+    const uint32_t sequence = LockTexel(index);
+    WriteWords(index, value);
+    UnlockTexel(index, sequence);
+}
+
+void HostEmulatedAtomicSurface64::Clear(uint64_t value)
+{
+    const size_t count = static_cast<size_t>(m_width) * m_height;
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint32_t sequence = LockTexel(i);
+        WriteWords(i, value);
+        UnlockTexel(i, sequence);
+    }
+}
+
+uint64_t HostEmulatedAtomicSurface64::InterlockedAdd(uint32_t x, uint32_t y, uint64_t value)
+{
+    return Modify(HostAtomicOp::Add, Index(x, y), value);
+}
+
+uint64_t HostEmulatedAtomicSurface64::InterlockedMin(uint32_t x, uint32_t y, uint64_t value)
+{
+    if (m_monotoneFilter)
+    {
+        return FilteredMinMax(HostAtomicOp::Min, Index(x, y), value);
+    }
+    return Modify(HostAtomicOp::Min, Index(x, y), value);
+}
+
+uint64_t HostEmulatedAtomicSurface64::InterlockedMax(uint32_t x, uint32_t y, uint64_t value)
+{
+    if (m_monotoneFilter)
+    {
+        return FilteredMinMax(HostAtomicOp::Max, Index(x, y), value);
+    }
+    return Modify(HostAtomicOp::Max, Index(x, y), value);
+}
+
+uint64_t HostEmulatedAtomicSurface64::InterlockedAnd(uint32_t x, uint32_t y, uint64_t value)
+{
+    return Modify(HostAtomicOp::And, Index(x, y), value);
+}
+
+uint64_t HostEmulatedAtomicSurface64::InterlockedOr(uint32_t x, uint32_t y, uint64_t value)
+{
+    return Modify(HostAtomicOp::Or, Index(x, y), value);
+}
+
+uint64_t HostEmulatedAtomicSurface64::InterlockedXor(uint32_t x, uint32_t y, uint64_t value)
+{
+    return Modify(HostAtomicOp::Xor, Index(x, y), value);
+}
+
+uint64_t HostEmulatedAtomicSurface64::InterlockedExchange(uint32_t x, uint32_t y, uint64_t value)
+{
+    return Modify(HostAtomicOp::Exchange, Index(x, y), value);
+}
+
+uint64_t HostEmulatedAtomicSurface64::InterlockedCompareExchange(uint32_t x, uint32_t y, uint64_t cmpValue, uint64_t xchgValue)
+{
+    const size_t index = Index(x, y);
+    const uint32_t sequence = LockTexel(index);
+    const uint64_t original = ReadWords(index);
+    if (original == cmpValue)
+    {
+        WriteWords(index, xchgValue);
+    }
+    UnlockTexel(index, sequence);
+    return original;
+}
+
+uint64_t HostEmulatedAtomicSurface64::Apply(HostAtomicOp op, uint32_t x, uint32_t y, uint64_t value, uint64_t xchgValue)
+{
+    if (op == HostAtomicOp::CompareExchange)
+    {
+        return InterlockedCompareExchange(x, y, value, xchgValue);
+    }
+    if (m_monotoneFilter && (op == HostAtomicOp::Min || op == HostAtomicOp::Max))
+    {
+        return FilteredMinMax(op, Index(x, y), value);
+    }
+    return Modify(op, Index(x, y), value);
+}
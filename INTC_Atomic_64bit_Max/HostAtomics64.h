@@ -0,0 +1,240 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Host (CPU) reference implementation of the INTEL_EXT_UINT64_ATOMIC operations
+// exposed by IntelExtensions12.hlsl. Surfaces use the same texel layout as the
+// DXGI_FORMAT_R32G32_UINT UAV: low 32 bits in .x, high 32 bits in .y.
+//
+// This code is portable C++ and does not depend on D3D12, so it can be built
+// and benchmarked on any host.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class HostArena;
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HOST_ATOMICS_X86 1
+#endif
+
+// Sub-op codes, matching INTEL_EXT_ATOMIC_* in IntelExtensions12.hlsl.
+enum class HostAtomicOp : uint32_t
+{
+    Add = 0,
+    Min = 1,
+    Max = 2,
+    CompareExchange = 3,
+    Exchange = 4,
+    And = 5,
+    Or = 6,
+    Xor = 7,
+};
+
+static const uint32_t HostAtomicOpCount = 8;
+
+// Thread group edge of CSMain ([numthreads(32, 32, 1)]).
+static const uint32_t HostThreadGroupSize = 32;
+
+const char* HostAtomicOpName(HostAtomicOp op);
+
+// Mirror of the HLSL uint2 used to carry a 64-bit value.
+struct HostUint2
+{
+    uint32_t x;    // Low 32 bits.
+    uint32_t y;    // High 32 bits.
+};
+
+inline uint64_t PackUint2(HostUint2 value)
+{
+    return (static_cast<uint64_t>(value.y) << 32) | value.x;
+}
+
+inline HostUint2 UnpackUint2(uint64_t value)
+{
+    return { static_cast<uint32_t>(value), static_cast<uint32_t>(value >> 32) };
+}
+
+// 2D texel address on a surface.
+struct HostTexelCoord
+{
+    uint32_t x;
+    uint32_t y;
+};
+
+// Spin-wait hint used by the lock and retry loops below.
+inline void HostCpuPause()
+{
+#ifdef HOST_ATOMICS_X86
+    _mm_pause();
+#endif
+}
+
+// Statistics counter spread over cache-line-padded slots, one per thread, so
+// counting from many threads does not serialize them on a single line. Counts
+// are exact for any number of threads; beyond SlotCount, threads share slots.
+class HostStatCounter
+{
+public:
+    HostStatCounter() { Reset(); }
+
+    void Add(uint64_t count);
+    uint64_t Get() const;
+    void Reset();
+
+private:
+    static const uint32_t SlotCount = 64;
+
+    // Padded rather than aligned to a cache line, so a counter embedded in a
+    // heap object needs no C++17 aligned new. With a 64-byte stride no two
+    // values share a line.
+    struct Slot
+    {
+        std::atomic<uint64_t> value;
+        char pad[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    Slot m_slots[SlotCount];
+};
+
+// Applies a non-compare sub-op to a plain value. Returns the new value.
+inline uint64_t HostAtomicCombine(HostAtomicOp op, uint64_t current, uint64_t value)
+{
+    switch (op)
+    {
+    case HostAtomicOp::Add:      return current + value;
+    case HostAtomicOp::Min:      return value < current ? value : current;
+    case HostAtomicOp::Max:      return value > current ? value : current;
+    case HostAtomicOp::Exchange: return value;
+    case HostAtomicOp::And:      return current & value;
+    case HostAtomicOp::Or:       return current | value;
+    case HostAtomicOp::Xor:      return current ^ value;
+    default:                     return current;
+    }
+}
+
+// Native backend: one std::atomic<uint64_t> per texel, so every operation maps
+// to a single 64-bit hardware atomic (or a 64-bit CAS loop for min/max). The
+// min/max loops start with a plain load and return without a CAS when the
+// update cannot win.
+class HostAtomicSurface64
+{
+public:
+    // With an arena, texel storage is tile-aligned arena memory (huge pages
+    // where available) and stays owned by the arena.
+    HostAtomicSurface64(uint32_t width, uint32_t height, HostArena* arena = nullptr);
+
+    uint32_t GetWidth() const   { return m_width; }
+    uint32_t GetHeight() const  { return m_height; }
+
+    uint64_t Load(uint32_t x, uint32_t y) const;
+    void Store(uint32_t x, uint32_t y, uint64_t value);
+    void Clear(uint64_t value);
+
+    // All interlocked operations return the value held before the operation,
+    // like the dst0u result of the HLSL extension.
+    uint64_t InterlockedAdd(uint32_t x, uint32_t y, uint64_t value);
+    uint64_t InterlockedMin(uint32_t x, uint32_t y, uint64_t value);
+    uint64_t InterlockedMax(uint32_t x, uint32_t y, uint64_t value);
+    uint64_t InterlockedAnd(uint32_t x, uint32_t y, uint64_t value);
+    uint64_t InterlockedOr(uint32_t x, uint32_t y, uint64_t value);
+    uint64_t InterlockedXor(uint32_t x, uint32_t y, uint64_t value);
+    uint64_t InterlockedExchange(uint32_t x, uint32_t y, uint64_t value);
+    uint64_t InterlockedCompareExchange(uint32_t x, uint32_t y, uint64_t cmpValue, uint64_t xchgValue);
+
+    // Dispatches on a sub-op code. For CompareExchange, value is the comparand.
+    uint64_t Apply(HostAtomicOp op, uint32_t x, uint32_t y, uint64_t value, uint64_t xchgValue = 0);
+
+private:
+    size_t Index(uint32_t x, uint32_t y) const { return static_cast<size_t>(y) * m_width + x; }
+
+    uint32_t m_width;
+    uint32_t m_height;
+    std::atomic<uint64_t>* m_texels;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_ownedTexels;    // Null when the storage comes from an arena.
+};
+
+// Skip statistics of the monotone min/max filter.
+struct HostFilterStats
+{
+    uint64_t candidates;    // Min/max operations seen while the filter was enabled.
+    uint64_t skipped;       // Operations resolved by a read, without taking the texel lock.
+
+    double SkippedFraction() const { return candidates == 0 ? 0.0 : static_cast<double>(skipped) / candidates; }
+};
+
+// Emulated backend: models what EmulatedTyped64bitAtomics asks of the driver.
+// Each texel is two 32-bit words guarded by a 32-bit per-texel sequence counter.
+// Writers take the counter from even to odd (the lock bit), update both words
+// and release it at the next even value. Readers never block writers; they
+// retry if the counter changed or was odd while they read the two words.
+//
+// With the monotone filter enabled, InterlockedMin/InterlockedMax first read
+// the texel (test-and-test-and-set) and return without locking when the update
+// cannot win, so losing updates only ever hold the cache line shared.
+class HostEmulatedAtomicSurface64
+{
+public:
+    HostEmulatedAtomicSurface64(uint32_t width, uint32_t height, HostArena* arena = nullptr);
+
+    uint32_t GetWidth() const   { return m_width; }
+    uint32_t GetHeight() const  { return m_height; }
+
+    uint64_t Load(uint32_t x, uint32_t y) const;
+    void Store(uint32_t x, uint32_t y, uint64_t value);
+    void Clear(uint64_t value);
+
+    uint64_t InterlockedAdd(uint32_t x, uint32_t y, uint64_t value);
+    uint64_t InterlockedMin(uint32_t x, uint32_t y, uint64_t value);
+    uint64_t InterlockedMax(uint32_t x, uint32_t y, uint64_t value);
+    uint64_t InterlockedAnd(uint32_t x, uint32_t y, uint64_t value);
+    uint64_t InterlockedOr(uint32_t x, uint32_t y, uint64_t value);
+    uint64_t InterlockedXor(uint32_t x, uint32_t y, uint64_t value);
+    uint64_t InterlockedExchange(uint32_t x, uint32_t y, uint64_t value);
+    uint64_t InterlockedCompareExchange(uint32_t x, uint32_t y, uint64_t cmpValue, uint64_t xchgValue);
+
+    uint64_t Apply(HostAtomicOp op, uint32_t x, uint32_t y, uint64_t value, uint64_t xchgValue = 0);
+
+    // Applies op (Min or Max) from one thread group: values holds groupWidth x
+    // groupHeight entries, row-major, for the texels starting at (originX, originY).
+    // The group's tile is snapshotted once with plain reads and only lanes that
+    // beat the snapshot take the texel lock. Groups larger than
+    // HostThreadGroupSize squared skip the snapshot and lock every lane. Lanes outside the surface are
+    // ignored. Skipping against a stale snapshot is only exact when the texels
+    // move in one direction (max-only or min-only) during the call.
+    // Returns the number of lanes that performed the read-modify-write.
+    uint32_t InterlockedGroup(HostAtomicOp op, uint32_t originX, uint32_t originY, const uint64_t* values,
+        uint32_t groupWidth = HostThreadGroupSize, uint32_t groupHeight = HostThreadGroupSize);
+
+    void SetMonotoneFilter(bool enable)     { m_monotoneFilter = enable; }
+    bool GetMonotoneFilter() const          { return m_monotoneFilter; }
+    HostFilterStats GetFilterStats() const  { return { m_filterSkipped.Get() + m_filterLocked.Get(), m_filterSkipped.Get() }; }
+    void ResetFilterStats();
+
+private:
+    size_t Index(uint32_t x, uint32_t y) const { return static_cast<size_t>(y) * m_width + x; }
+
+    bool TryReadStable(size_t index, uint64_t& value) const;
+    uint64_t FilteredMinMax(HostAtomicOp op, size_t index, uint64_t value);
+    uint32_t LockTexel(size_t index);
+    void UnlockTexel(size_t index, uint32_t sequence);
+    uint64_t ReadWords(size_t index) const;
+    void WriteWords(size_t index, uint64_t value);
+    uint64_t Modify(HostAtomicOp op, size_t index, uint64_t value);
+
+    uint32_t m_width;
+    uint32_t m_height;
+    std::atomic<uint32_t>* m_words;         // 2 words per texel, .x then .y.
+    std::atomic<uint32_t>* m_sequence;      // 1 counter per texel.
+    std::unique_ptr<std::atomic<uint32_t>[]> m_ownedStorage;   // Null when the storage comes from an arena.
+
+    bool m_monotoneFilter;
+    HostStatCounter m_filterSkipped;
+    HostStatCounter m_filterLocked;     // Candidates that took the texel lock.
+};
@@ -0,0 +1,165 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostBatchApply.h"
+#include "HostParallel.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Widest digit per pass. 4096 buckets keep a worker's histogram at 32 KiB,
+    // and surfaces up to 4096 x 4096 (4096 tiles) sort in a single pass.
+    const uint32_t MaxRadixBits = 12;
+    const uint32_t MaxRadixBuckets = 1 << MaxRadixBits;
+
+    inline uint32_t TileOf(const HostAtomicUpdate& update, uint32_t tilesX)
+    {
+        return (update.y / HostBatchApplier::TileSize) * tilesX + update.x / HostBatchApplier::TileSize;
+    }
+}
+
+HostBatchApplier::HostBatchApplier(uint32_t workerCount) :
+    m_workerCount(workerCount == 0 ? HostWorkerCount() : workerCount),
+    m_directThreshold(DefaultDirectThreshold),
+    m_scratchCapacity(0)
+{
+    m_histograms.resize(static_cast<size_t>(m_workerCount) * MaxRadixBuckets);
+}
+
+void HostBatchApplier::Reserve(size_t count)
+{
+    if (m_scratchCapacity < count)
+    {
+        // Value-initialized so the pages are faulted in here, not in the first sort.
+        m_scratch.reset(new HostAtomicUpdate[count]());
+        m_scratchCapacity = count;
+    }
+}
+
+void HostBatchApplier::ApplyDirect(HostAtomicSurface64& surface, const HostAtomicUpdate* updates, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const HostAtomicUpdate& update = updates[i];
+        if (update.op != HostAtomicOp::CompareExchange)
+        {
+            surface.Apply(update.op, update.x, update.y, update.value);
+        }
+    }
+}
+
+// Parallel LSD radix sort on the tile index, in as few passes of at most
+// MaxRadixBits as the tile count allows. Each pass has
+// every worker histogram its own contiguous range, turns the histograms into
+// per-worker bucket offsets (bucket-major, worker-minor, which keeps the sort
+// stable) and scatters its range. Buffers ping-pong between updates and
+// m_scratch; the return value says which one holds the result.
+const HostAtomicUpdate* HostBatchApplier::SortByTile(HostAtomicUpdate* updates, size_t count, uint32_t tilesX, uint32_t tileCount)
+{
+    uint32_t keyBits = 0;
+    while ((1ull << keyBits) < tileCount)
+    {
+        keyBits++;
+    }
+    if (keyBits == 0)
+    {
+        return updates;
+    }
+
+    const uint32_t passCount = (keyBits + MaxRadixBits - 1) / MaxRadixBits;
+    const uint32_t radixBits = (keyBits + passCount - 1) / passCount;
+    const uint32_t radixBuckets = 1u << radixBits;
+
+    Reserve(count);
+
+    HostAtomicUpdate* source = updates;
+    HostAtomicUpdate* destination = m_scratch.get();
+    const uint32_t workerCount = m_workerCount;
+
+    for (uint32_t shift = 0; shift < keyBits; shift += radixBits)
+    {
+        HostParallelRun(workerCount, [&](uint32_t worker)
+        {
+            size_t* histogram = &m_histograms[static_cast<size_t>(worker) * radixBuckets];
+            std::fill(histogram, histogram + radixBuckets, 0);
+
+            const size_t begin = count * worker / workerCount;
+            const size_t end = count * (worker + 1) / workerCount;
+            for (size_t i = begin; i < end; i++)
+            {
+                histogram[(TileOf(source[i], tilesX) >> shift) & (radixBuckets - 1)]++;
+            }
+        });
+
+        size_t offset = 0;
+        for (uint32_t bucket = 0; bucket < radixBuckets; bucket++)
+        {
+            for (uint32_t worker = 0; worker < workerCount; worker++)
+            {
+                size_t& entry = m_histograms[static_cast<size_t>(worker) * radixBuckets + bucket];
+                const size_t bucketCount = entry;
+                entry = offset;
+                offset += bucketCount;
+            }
+        }
+
+        HostParallelRun(workerCount, [&](uint32_t worker)
+        {
+            size_t* offsets = &m_histograms[static_cast<size_t>(worker) * radixBuckets];
+
+            const size_t begin = count * worker / workerCount;
+            const size_t end = count * (worker + 1) / workerCount;
+            for (size_t i = begin; i < end; i++)
+            {
+                destination[offsets[(TileOf(source[i], tilesX) >> shift) & (radixBuckets - 1)]++] = source[i];
+            }
+        });
+
+        std::swap(source, destination);
+    }
+
+    return source;
+}
+
+void HostBatchApplier::Apply(HostAtomicSurface64& surface, HostAtomicUpdate* updates, size_t count)
+{
+    if (count < m_directThreshold)
+    {
+        ApplyDirect(surface, updates, count);
+        return;
+    }
+
+    const uint32_t tilesX = (surface.GetWidth() + TileSize - 1) / TileSize;
+    const uint32_t tilesY = (surface.GetHeight() + TileSize - 1) / TileSize;
+    const HostAtomicUpdate* sorted = SortByTile(updates, count, tilesX, tilesX * tilesY);
+
+    // Give each worker a contiguous run of whole tiles: move every split point
+    // forward to the next tile boundary, so a tile never has two owners.
+    const uint32_t workerCount = m_workerCount;
+    std::vector<size_t> splits(workerCount + 1);
+    for (uint32_t worker = 0; worker <= workerCount; worker++)
+    {
+        size_t split = count * worker / workerCount;
+        while (split > 0 && split < count && TileOf(sorted[split], tilesX) == TileOf(sorted[split - 1], tilesX))
+        {
+            split++;
+        }
+        splits[worker] = split;
+    }
+
+    HostParallelRun(workerCount, [&](uint32_t worker)
+    {
+        // Plain (relaxed) loads and stores: this worker is the only writer of its tiles.
+        for (size_t i = splits[worker]; i < splits[worker + 1]; i++)
+        {
+            const HostAtomicUpdate& update = sorted[i];
+            if (update.op != HostAtomicOp::CompareExchange)
+            {
+                surface.Store(update.x, update.y, HostAtomicCombine(update.op, surface.Load(update.x, update.y), update.value));
+            }
+        }
+    });
+}
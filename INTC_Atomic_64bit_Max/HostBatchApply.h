@@ -0,0 +1,63 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Sort-then-apply engine for large unordered batches of 64-bit atomic updates
+// (replayed traces, bulk updates). Random-address atomics are bound by memory
+// latency; sorting the batch by tile first turns them into tile-local plain
+// read-modify-writes, and because each tile is owned by exactly one worker no
+// atomic instructions are needed.
+
+#pragma once
+
+#include "HostAtomics64.h"
+
+#include <vector>
+
+// One queued update. x and y fit in 16 bits because D3D12 limits 2D textures
+// to 16384 texels per side.
+struct HostAtomicUpdate
+{
+    uint16_t x;
+    uint16_t y;
+    HostAtomicOp op;
+    uint64_t value;
+};
+
+class HostBatchApplier
+{
+public:
+    // Edge of the square tiles the batch is sorted into. 64 x 64 x 8 bytes is
+    // 32 KiB, which keeps a tile resident in L1/L2 while it is applied.
+    static const uint32_t TileSize = 64;
+    static const size_t DefaultDirectThreshold = 1 << 16;
+
+    explicit HostBatchApplier(uint32_t workerCount = 0);
+
+    // Batches smaller than this are applied with direct atomics instead.
+    void SetDirectThreshold(size_t threshold)   { m_directThreshold = threshold; }
+    size_t GetDirectThreshold() const           { return m_directThreshold; }
+
+    // Allocates the sort scratch for batches of up to count updates up front,
+    // so the first large Apply does not pay for it.
+    void Reserve(size_t count);
+
+    // Applies every update to surface. The result equals applying the batch
+    // in order: the radix sort is stable, so updates to the same texel keep
+    // their relative order. updates is used as sort scratch and is left in
+    // unspecified order. No other thread may access surface during the call.
+    // CompareExchange needs two operands and is not supported; such entries
+    // are ignored.
+    void Apply(HostAtomicSurface64& surface, HostAtomicUpdate* updates, size_t count);
+
+private:
+    void ApplyDirect(HostAtomicSurface64& surface, const HostAtomicUpdate* updates, size_t count);
+    const HostAtomicUpdate* SortByTile(HostAtomicUpdate* updates, size_t count, uint32_t tilesX, uint32_t tileCount);
+
+    uint32_t m_workerCount;
+    size_t m_directThreshold;
+    std::unique_ptr<HostAtomicUpdate[]> m_scratch;
+    size_t m_scratchCapacity;
+    std::vector<size_t> m_histograms;   // m_workerCount x MaxRadixBuckets.
+};
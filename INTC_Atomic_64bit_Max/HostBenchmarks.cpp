@@ -0,0 +1,2315 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Host benchmarks for the CPU reference library. These run inside the sample
+// with the -hostbench command line switch, or standalone on any platform by
+// building the Host*.cpp files with HOST_BENCHMARK_MAIN defined.
+
+#include "HostBenchmarks.h"
+#include "HostAtomics64.h"
+#include "HostAtomics128.h"
+#include "HostArena.h"
+#include "HostAtlas.h"
+#include "HostCommandRecorder.h"
+#include "HostFrameLoop.h"
+#include "HostFrameTimeline.h"
+#include "HostHeapAllocator.h"
+#include "HostBatchApply.h"
+#include "HostParallel.h"
+#include "HostParallelRecording.h"
+#include "HostSparseSurface64.h"
+#include "HostVolume.h"
+#include "HostVidmemManager.h"
+#include "HostDescriptorAllocator.h"
+#include "HostSurfacePool.h"
+#include "HostSplitSurface64.h"
+#include "HostReadbackCopy.h"
+#include "HostDirtyTiles.h"
+#include "HostSurfaceStats.h"
+#include "HostSurfaceDump.h"
+#include "HostSurfaceCompression.h"
+#include "HostSurfaceDiff.h"
+#include "HostVisualize.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // Matches TEX_WIDTH x TEX_HEIGHT of the sample.
+    const uint32_t SurfaceWidth = 640;
+    const uint32_t SurfaceHeight = 480;
+
+    class Stopwatch
+    {
+    public:
+        Stopwatch() : m_start(std::chrono::steady_clock::now()) {}
+
+        double ElapsedSeconds() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    // Small, fast generator so address generation does not dominate the timings.
+    struct XorShift64
+    {
+        uint64_t state;
+
+        explicit XorShift64(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ull + 1) {}
+
+        uint64_t Next()
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+    };
+
+    // Checks that fail make RunHostBenchmarks report failure.
+    uint32_t s_failedChecks = 0;
+
+    bool Check(bool passed)
+    {
+        s_failedChecks += passed ? 0 : 1;
+        return passed;
+    }
+
+    // Runs body(threadIndex) on threadCount threads and returns the wall time.
+    template <typename Body>
+    double RunOnThreads(uint32_t threadCount, Body body)
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount);
+
+        Stopwatch stopwatch;
+        for (uint32_t t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back(body, t);
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        return stopwatch.ElapsedSeconds();
+    }
+
+    //
+    // Emulated (2 x 32-bit + seqlock) vs native 64-bit atomics.
+    //
+
+    enum class AccessPattern
+    {
+        Linear,     // CSMain-style: every thread walks its own rows.
+        Random,     // Uniformly random texels over the whole surface.
+        Contended,  // All threads hammer the same 8x8 block.
+    };
+
+    const char* AccessPatternName(AccessPattern pattern)
+    {
+        switch (pattern)
+        {
+        case AccessPattern::Linear:    return "linear";
+        case AccessPattern::Random:    return "random";
+        case AccessPattern::Contended: return "contended";
+        }
+        return "unknown";
+    }
+
+    template <typename Surface>
+    double TimeAtomicOps(Surface& surface, HostAtomicOp op, AccessPattern pattern, uint32_t threadCount, uint64_t opsPerThread)
+    {
+        const uint32_t width = surface.GetWidth();
+        const uint32_t height = surface.GetHeight();
+        const uint64_t texelCount = static_cast<uint64_t>(width) * height;
+
+        const double seconds = RunOnThreads(threadCount, [&](uint32_t threadIndex)
+        {
+            XorShift64 rng(threadIndex + 1);
+            uint64_t linear = (texelCount / threadCount) * threadIndex;
+            for (uint64_t i = 0; i < opsPerThread; i++)
+            {
+                const uint64_t random = rng.Next();
+                uint32_t x;
+                uint32_t y;
+                switch (pattern)
+                {
+                case AccessPattern::Linear:
+                    x = static_cast<uint32_t>(linear % width);
+                    y = static_cast<uint32_t>((linear / width) % height);
+                    linear++;
+                    break;
+                case AccessPattern::Random:
+                    x = static_cast<uint32_t>(random % width);
+                    y = static_cast<uint32_t>((random >> 32) % height);
+                    break;
+                default:
+                    x = static_cast<uint32_t>(random & 7);
+                    y = static_cast<uint32_t>((random >> 32) & 7);
+                    break;
+                }
+                const uint64_t value = random >> 40;
+                surface.Apply(op, x, y, value, value ^ 1);
+            }
+        });
+
+        return seconds * 1e9 / static_cast<double>(opsPerThread * threadCount);
+    }
+
+    void BenchmarkEmulatedAtomics()
+    {
+        const uint32_t threadCount = HostWorkerCount();
+        const uint64_t opsPerThread = 1 << 20;
+
+        HostAtomicSurface64 native(SurfaceWidth, SurfaceHeight);
+        HostEmulatedAtomicSurface64 emulated(SurfaceWidth, SurfaceHeight);
+
+        printf("%u x %u surface, %u threads, %llu ops per thread\n",
+            SurfaceWidth, SurfaceHeight, threadCount, static_cast<unsigned long long>(opsPerThread));
+        printf("%-16s %-10s %12s %12s %8s\n", "op", "pattern", "native ns", "emulated ns", "ratio");
+
+        const AccessPattern patterns[] = { AccessPattern::Linear, AccessPattern::Random, AccessPattern::Contended };
+        for (uint32_t opIndex = 0; opIndex < HostAtomicOpCount; opIndex++)
+        {
+            const HostAtomicOp op = static_cast<HostAtomicOp>(opIndex);
+            for (AccessPattern pattern : patterns)
+            {
+                native.Clear(0);
+                emulated.Clear(0);
+                const double nativeNs = TimeAtomicOps(native, op, pattern, threadCount, opsPerThread);
+                const double emulatedNs = TimeAtomicOps(emulated, op, pattern, threadCount, opsPerThread);
+                printf("%-16s %-10s %12.2f %12.2f %7.2fx\n",
+                    HostAtomicOpName(op), AccessPatternName(pattern), nativeNs, emulatedNs, emulatedNs / nativeNs);
+            }
+        }
+
+        // Writers exchange values whose two words are equal into one 8x8
+        // block while readers Load it; a reader that sees unequal words has
+        // read a torn texel.
+        const uint32_t tornThreads = threadCount < 4 ? 4 : threadCount;
+        const uint64_t tornOps = 1 << 18;
+        std::atomic<uint64_t> tornReads(0);
+        emulated.Clear(0);
+        RunOnThreads(tornThreads, [&](uint32_t threadIndex)
+        {
+            XorShift64 rng(threadIndex + 1);
+            uint64_t torn = 0;
+            for (uint64_t i = 0; i < tornOps; i++)
+            {
+                const uint64_t random = rng.Next();
+                const uint32_t x = static_cast<uint32_t>(random & 7);
+                const uint32_t y = static_cast<uint32_t>((random >> 3) & 7);
+                if (threadIndex & 1)
+                {
+                    const uint64_t value = emulated.Load(x, y);
+                    torn += (value >> 32) != (value & 0xFFFFFFFF) ? 1 : 0;
+                }
+                else
+                {
+                    const uint64_t word = random >> 32;
+                    emulated.InterlockedExchange(x, y, (word << 32) | word);
+                }
+            }
+            tornReads += torn;
+        });
+        printf("%u threads exchanging and loading one 8x8 block: %llu torn reads%s\n",
+            tornThreads, static_cast<unsigned long long>(tornReads.load()), Check(tornReads == 0) ? "" : " FAILED");
+    }
+
+    //
+    // 128-bit key + payload atomics vs two separate 64-bit atomics.
+    //
+
+    template <typename Update>
+    double TimeKeyPayloadOps(bool contended, uint32_t threadCount, uint64_t opsPerThread, Update update)
+    {
+        const double seconds = RunOnThreads(threadCount, [&](uint32_t threadIndex)
+        {
+            XorShift64 rng(threadIndex + 1);
+            for (uint64_t i = 0; i < opsPerThread; i++)
+            {
+                const uint64_t random = rng.Next();
+                const uint32_t x = static_cast<uint32_t>(contended ? (random & 7) : (random % SurfaceWidth));
+                const uint32_t y = static_cast<uint32_t>(contended ? ((random >> 32) & 7) : ((random >> 32) % SurfaceHeight));
+                update(x, y, HostKeyPayload128{ random >> 16, random ^ threadIndex });
+            }
+        });
+        return seconds * 1e9 / static_cast<double>(opsPerThread * threadCount);
+    }
+
+    void BenchmarkPairedAtomics128()
+    {
+        const uint32_t threadCount = HostWorkerCount();
+        const uint64_t opsPerThread = 1 << 20;
+
+        HostAtomicSurface128 seqlock(SurfaceWidth, SurfaceHeight, HostAtomic128Backend::SequenceLock);
+        HostAtomicSurface64 keys(SurfaceWidth, SurfaceHeight);
+        HostAtomicSurface64 payloads(SurfaceWidth, SurfaceHeight);
+#ifdef HOST_ATOMICS_CMPXCHG16B
+        HostAtomicSurface128 cmpxchg16b(SurfaceWidth, SurfaceHeight, HostAtomic128Backend::Cmpxchg16b);
+#endif
+
+        printf("%u x %u surface, %u threads, %llu max-by-key ops per thread\n",
+            SurfaceWidth, SurfaceHeight, threadCount, static_cast<unsigned long long>(opsPerThread));
+        printf("two 64-bit atomics: InterlockedMax on the key, then Exchange of the payload\n");
+        printf("if the key won. Cheapest, but racing writers can pair keys with the wrong payload.\n");
+        printf("%-10s %12s %12s %12s\n", "pattern", "cmpxchg16b", "seqlock", "2 x 64-bit");
+
+        for (int contended = 0; contended < 2; contended++)
+        {
+            double cmpxchg16bNs = 0.0;
+#ifdef HOST_ATOMICS_CMPXCHG16B
+            cmpxchg16b.Clear({ 0, 0 });
+            cmpxchg16bNs = TimeKeyPayloadOps(contended != 0, threadCount, opsPerThread,
+                [&](uint32_t x, uint32_t y, HostKeyPayload128 value) { cmpxchg16b.InterlockedMaxKey(x, y, value); });
+#endif
+            seqlock.Clear({ 0, 0 });
+            const double seqlockNs = TimeKeyPayloadOps(contended != 0, threadCount, opsPerThread,
+                [&](uint32_t x, uint32_t y, HostKeyPayload128 value) { seqlock.InterlockedMaxKey(x, y, value); });
+
+            keys.Clear(0);
+            payloads.Clear(0);
+            const double pairNs = TimeKeyPayloadOps(contended != 0, threadCount, opsPerThread,
+                [&](uint32_t x, uint32_t y, HostKeyPayload128 value)
+                {
+                    if (keys.InterlockedMax(x, y, value.key) < value.key)
+                    {
+                        payloads.InterlockedExchange(x, y, value.payload);
+                    }
+                });
+
+            printf("%-10s %12.2f %12.2f %12.2f\n", contended ? "contended" : "random", cmpxchg16bNs, seqlockNs, pairNs);
+        }
+
+        // Writers max-by-key into one 8x8 block with a payload derived from
+        // the key while readers Load it; a payload that does not match its
+        // key was paired with another writer's.
+        const uint32_t pairingThreads = threadCount < 4 ? 4 : threadCount;
+        const uint64_t pairingOps = 1 << 18;
+        auto countMispaired = [&](HostAtomicSurface128& surface)
+        {
+            std::atomic<uint64_t> mispaired(0);
+            surface.Clear({ 0, ~0ull });
+            RunOnThreads(pairingThreads, [&](uint32_t threadIndex)
+            {
+                XorShift64 rng(threadIndex + 1);
+                uint64_t wrong = 0;
+                for (uint64_t i = 0; i < pairingOps; i++)
+                {
+                    const uint64_t random = rng.Next();
+                    const uint32_t x = static_cast<uint32_t>(random & 7);
+                    const uint32_t y = static_cast<uint32_t>((random >> 3) & 7);
+                    if (threadIndex & 1)
+                    {
+                        const HostKeyPayload128 value = surface.Load(x, y);
+                        wrong += value.payload != ~value.key ? 1 : 0;
+                    }
+                    else
+                    {
+                        // Keys grow slowly so that many updates still win.
+                        const uint64_t key = (i << 8) | (random >> 56);
+                        surface.InterlockedMaxKey(x, y, { key, ~key });
+                    }
+                }
+                mispaired += wrong;
+            });
+            return mispaired.load();
+        };
+        const uint64_t seqlockMispaired = countMispaired(seqlock);
+        printf("%u threads max-by-key and loading one 8x8 block: seqlock %llu mispaired%s\n", pairingThreads,
+            static_cast<unsigned long long>(seqlockMispaired), Check(seqlockMispaired == 0) ? "" : " FAILED");
+#ifdef HOST_ATOMICS_CMPXCHG16B
+        const uint64_t cmpxchg16bMispaired = countMispaired(cmpxchg16b);
+        printf("%u threads max-by-key and loading one 8x8 block: cmpxchg16b %llu mispaired%s\n", pairingThreads,
+            static_cast<unsigned long long>(cmpxchg16bMispaired), Check(cmpxchg16bMispaired == 0) ? "" : " FAILED");
+#endif
+    }
+
+    //
+    // Test-and-test-and-set filtering of monotone max updates.
+    //
+
+    // CSMain-style: every thread walks all 32x32 groups of the surface several
+    // times issuing InterlockedMax with random values, so after the first pass
+    // most updates lose. With sameGroup every update goes to the first group
+    // instead, so all threads contend for the same texels.
+    // update(originX, originY, values) applies one group.
+    template <typename GroupUpdate>
+    double TimeMonotoneGroups(uint32_t threadCount, uint32_t passes, bool sameGroup, GroupUpdate update)
+    {
+        const uint32_t groupsX = SurfaceWidth / HostThreadGroupSize;
+        const uint32_t groupsY = SurfaceHeight / HostThreadGroupSize;
+
+        const double seconds = RunOnThreads(threadCount, [&](uint32_t threadIndex)
+        {
+            XorShift64 rng(threadIndex + 1);
+            uint64_t values[HostThreadGroupSize * HostThreadGroupSize];
+            for (uint32_t pass = 0; pass < passes; pass++)
+            {
+                for (uint32_t group = 0; group < groupsX * groupsY; group++)
+                {
+                    for (uint64_t& value : values)
+                    {
+                        value = rng.Next() >> 16;
+                    }
+                    const uint32_t target = sameGroup ? 0 : group;
+                    update((target % groupsX) * HostThreadGroupSize, (target / groupsX) * HostThreadGroupSize, values);
+                }
+            }
+        });
+
+        const uint64_t ops = static_cast<uint64_t>(threadCount) * passes * SurfaceWidth * SurfaceHeight;
+        return seconds * 1e9 / static_cast<double>(ops);
+    }
+
+    void BenchmarkMonotoneFilter()
+    {
+        const uint32_t threadCount = HostWorkerCount();
+        const uint32_t passes = 8;
+
+        HostAtomicSurface64 native(SurfaceWidth, SurfaceHeight);
+        HostEmulatedAtomicSurface64 emulated(SurfaceWidth, SurfaceHeight);
+
+        auto perLane = [](auto& surface)
+        {
+            return [&surface](uint32_t originX, uint32_t originY, const uint64_t* values)
+            {
+                for (uint32_t j = 0; j < HostThreadGroupSize; j++)
+                {
+                    for (uint32_t i = 0; i < HostThreadGroupSize; i++)
+                    {
+                        surface.InterlockedMax(originX + i, originY + j, values[j * HostThreadGroupSize + i]);
+                    }
+                }
+            };
+        };
+
+        // With one thread per core and updates spread over the surface, a
+        // filtered read costs about as much as the uncontended lock it saves.
+        // The filter pays off when threads contend for the same texels: a
+        // skipped update leaves the line shared instead of taking it exclusive.
+        const uint32_t contendedThreads = threadCount < 4 ? 4 : threadCount;
+        for (int sameGroup = 0; sameGroup < 2; sameGroup++)
+        {
+            const uint32_t threads = sameGroup ? contendedThreads : threadCount;
+            printf("%u x %u surface, %u threads, %u passes of InterlockedMax over %s\n",
+                SurfaceWidth, SurfaceHeight, threads, passes, sameGroup ? "one 32x32 group" : "every texel");
+            printf("%-28s %10s %10s\n", "mode", "ns/op", "skipped");
+
+            // Every update is one filter candidate, whichever threads share
+            // the counter's slots.
+            const uint64_t ops = static_cast<uint64_t>(threads) * passes * SurfaceWidth * SurfaceHeight;
+
+            native.Clear(0);
+            printf("%-28s %10.2f %10s\n", "native (load + CAS)", TimeMonotoneGroups(threads, passes, sameGroup != 0, perLane(native)), "-");
+
+            emulated.Clear(0);
+            emulated.SetMonotoneFilter(false);
+            printf("%-28s %10.2f %10s\n", "emulated, unfiltered", TimeMonotoneGroups(threads, passes, sameGroup != 0, perLane(emulated)), "-");
+
+            emulated.Clear(0);
+            emulated.SetMonotoneFilter(true);
+            emulated.ResetFilterStats();
+            double ns = TimeMonotoneGroups(threads, passes, sameGroup != 0, perLane(emulated));
+            printf("%-28s %10.2f %9.1f%%%s\n", "emulated, per-op filter", ns, emulated.GetFilterStats().SkippedFraction() * 100.0,
+                Check(emulated.GetFilterStats().candidates == ops) ? "" : " MISCOUNTED");
+
+            emulated.Clear(0);
+            emulated.ResetFilterStats();
+            ns = TimeMonotoneGroups(threads, passes, sameGroup != 0, [&](uint32_t originX, uint32_t originY, const uint64_t* values)
+            {
+                emulated.InterlockedGroup(HostAtomicOp::Max, originX, originY, values);
+            });
+            printf("%-28s %10.2f %9.1f%%%s\n", "emulated, 32x32 group filter", ns, emulated.GetFilterStats().SkippedFraction() * 100.0,
+                Check(emulated.GetFilterStats().candidates == ops) ? "" : " MISCOUNTED");
+        }
+    }
+
+    //
+    // Sort-then-apply vs direct atomics for large random batches.
+    //
+
+    uint64_t SurfaceChecksum(const HostAtomicSurface64& surface)
+    {
+        uint64_t checksum = 0;
+        for (uint32_t y = 0; y < surface.GetHeight(); y++)
+        {
+            for (uint32_t x = 0; x < surface.GetWidth(); x++)
+            {
+                checksum = checksum * 31 + surface.Load(x, y);
+            }
+        }
+        return checksum;
+    }
+
+    void BenchmarkSortThenApply()
+    {
+        // 4096 x 4096 x 8 bytes = 128 MiB, well beyond the last-level cache.
+        const uint32_t width = 4096;
+        const uint32_t height = 4096;
+        const uint32_t threadCount = HostWorkerCount();
+        const size_t batchSizes[] = { 1000000, 10000000, 100000000 };
+        const HostAtomicOp ops[] = { HostAtomicOp::Max, HostAtomicOp::Add, HostAtomicOp::Or };
+
+        HostAtomicSurface64 direct(width, height);
+        HostAtomicSurface64 sorted(width, height);
+        HostBatchApplier applier(threadCount);
+        applier.Reserve(batchSizes[sizeof(batchSizes) / sizeof(batchSizes[0]) - 1]);
+
+        printf("%u x %u surface, %u threads, random Max/Add/Or updates\n", width, height, threadCount);
+        printf("%12s %14s %14s %8s %8s\n", "batch", "direct Mops/s", "sorted Mops/s", "speedup", "match");
+
+        std::vector<HostAtomicUpdate> batch;
+        for (size_t batchSize : batchSizes)
+        {
+            batch.resize(batchSize);
+            HostParallelRanges(batchSize, threadCount, [&](uint32_t worker, size_t begin, size_t end)
+            {
+                XorShift64 rng(worker + 1);
+                for (size_t i = begin; i < end; i++)
+                {
+                    const uint64_t random = rng.Next();
+                    batch[i] = { static_cast<uint16_t>(random % width), static_cast<uint16_t>((random >> 16) % height),
+                        ops[(random >> 32) % 3], random >> 40 };
+                }
+            });
+
+            direct.Clear(0);
+            sorted.Clear(0);
+
+            Stopwatch directTime;
+            HostParallelRanges(batchSize, threadCount, [&](uint32_t, size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    direct.Apply(batch[i].op, batch[i].x, batch[i].y, batch[i].value);
+                }
+            });
+            const double directSeconds = directTime.ElapsedSeconds();
+
+            // Max does not commute with Add or Or, so the threaded run above
+            // lands in no fixed order. The reference applies the batch on one
+            // thread in batch order, which the stable sort preserves per texel.
+            // It runs first because Apply leaves the batch reordered.
+            direct.Clear(0);
+            for (const HostAtomicUpdate& update : batch)
+            {
+                direct.Apply(update.op, update.x, update.y, update.value);
+            }
+
+            Stopwatch sortedTime;
+            applier.Apply(sorted, batch.data(), batch.size());
+            const double sortedSeconds = sortedTime.ElapsedSeconds();
+
+            printf("%12zu %14.1f %14.1f %7.2fx %8s\n", batchSize,
+                batchSize / directSeconds * 1e-6, batchSize / sortedSeconds * 1e-6, directSeconds / sortedSeconds,
+                Check(SurfaceChecksum(direct) == SurfaceChecksum(sorted)) ? "yes" : "NO");
+        }
+    }
+
+    //
+    // Random atomics on a large surface: heap vs arena with and without huge pages.
+    //
+
+    double TimeRandomAdds(HostAtomicSurface64& surface, uint32_t threadCount, uint64_t opsPerThread)
+    {
+        const uint32_t width = surface.GetWidth();
+        const uint32_t height = surface.GetHeight();
+        const double seconds = RunOnThreads(threadCount, [&](uint32_t threadIndex)
+        {
+            XorShift64 rng(threadIndex + 1);
+            for (uint64_t i = 0; i < opsPerThread; i++)
+            {
+                const uint64_t random = rng.Next();
+                surface.InterlockedAdd(static_cast<uint32_t>(random % width), static_cast<uint32_t>((random >> 32) % height), 1);
+            }
+        });
+        return seconds * 1e9 / static_cast<double>(opsPerThread * threadCount);
+    }
+
+    void BenchmarkHugePageArena()
+    {
+        // 8192 x 8192 x 8 bytes = 512 MiB, enough to overflow a 4 KiB-page TLB many times over.
+        const uint32_t width = 8192;
+        const uint32_t height = 8192;
+        const uint32_t threadCount = HostWorkerCount();
+        const uint64_t opsPerThread = 1 << 24;
+
+        printf("%u x %u surface, %u threads, %llu random InterlockedAdd per thread\n",
+            width, height, threadCount, static_cast<unsigned long long>(opsPerThread));
+        printf("%-22s %10s %-24s\n", "storage", "ns/op", "chunks");
+
+        {
+            HostAtomicSurface64 surface(width, height);
+            surface.Clear(0);
+            printf("%-22s %10.2f %-24s\n", "operator new", TimeRandomAdds(surface, threadCount, opsPerThread), "-");
+        }
+
+        const HostPagePolicy policies[] = { HostPagePolicy::StandardOnly, HostPagePolicy::PreferHuge };
+        for (HostPagePolicy policy : policies)
+        {
+            HostArena arena(HostArena::DefaultChunkSize, policy);
+            HostAtomicSurface64 surface(width, height, &arena);
+            surface.Clear(0);
+            const double ns = TimeRandomAdds(surface, threadCount, opsPerThread);
+
+            const HostArenaStats stats = arena.GetStats();
+            char chunks[64] = {};
+            for (uint32_t kind = 0; kind < HostPageKindCount; kind++)
+            {
+                if (stats.chunksByKind[kind] != 0)
+                {
+                    snprintf(chunks + strlen(chunks), sizeof(chunks) - strlen(chunks), "%llu x %s ",
+                        static_cast<unsigned long long>(stats.chunksByKind[kind]), HostPageKindName(static_cast<HostPageKind>(kind)));
+                }
+            }
+            printf("%-22s %10.2f %-24s\n", policy == HostPagePolicy::PreferHuge ? "arena, huge pages" : "arena, 4 KiB pages", ns, chunks);
+        }
+    }
+
+    //
+    // Sparse (allocate-on-first-touch tiles) vs dense surface.
+    //
+
+    // Random InterlockedMax confined to windowCount square windows of
+    // windowSize texels spread over the surface, like a renderer that only
+    // touches a few screen regions of a huge virtual surface.
+    template <typename Surface>
+    double TimeWindowedMax(Surface& surface, uint32_t windowCount, uint32_t windowSize, uint32_t threadCount, uint64_t opsPerThread)
+    {
+        const uint32_t stepX = (surface.GetWidth() - windowSize) / windowCount;
+        const uint32_t stepY = (surface.GetHeight() - windowSize) / windowCount;
+        const double seconds = RunOnThreads(threadCount, [&](uint32_t threadIndex)
+        {
+            XorShift64 rng(threadIndex + 1);
+            for (uint64_t i = 0; i < opsPerThread; i++)
+            {
+                const uint64_t random = rng.Next();
+                const uint32_t window = static_cast<uint32_t>(random >> 56) % windowCount;
+                const uint32_t x = window * stepX + static_cast<uint32_t>(random & 0xFFFF) % windowSize;
+                const uint32_t y = window * stepY + static_cast<uint32_t>((random >> 16) & 0xFFFF) % windowSize;
+                surface.InterlockedMax(x, y, (random >> 32) | 1);
+            }
+        });
+        return seconds * 1e9 / static_cast<double>(opsPerThread * threadCount);
+    }
+
+    void BenchmarkSparseSurface()
+    {
+        const uint32_t width = 8192;
+        const uint32_t height = 8192;
+        const uint32_t windowCount = 8;
+        const uint32_t windowSize = 512;
+        const uint32_t threadCount = HostWorkerCount();
+        const uint64_t opsPerThread = 1 << 24;
+
+        printf("%u x %u surface, %u windows of %u x %u, %u threads, %llu random InterlockedMax per thread\n",
+            width, height, windowCount, windowSize, windowSize, threadCount, static_cast<unsigned long long>(opsPerThread));
+        printf("%-10s %10s %14s %12s\n", "storage", "ns/op", "resident MiB", "tiles");
+
+        {
+            HostAtomicSurface64 surface(width, height);
+            surface.Clear(0);
+            const double ns = TimeWindowedMax(surface, windowCount, windowSize, threadCount, opsPerThread);
+            printf("%-10s %10.2f %14.1f %12s\n", "dense", ns, width * static_cast<double>(height) * sizeof(uint64_t) / (1024.0 * 1024.0), "-");
+        }
+        {
+            HostSparseAtomicSurface64 surface(width, height);
+            const double ns = TimeWindowedMax(surface, windowCount, windowSize, threadCount, opsPerThread);
+            char tiles[32];
+            snprintf(tiles, sizeof(tiles), "%u / %u", surface.GetResidentTileCount(), surface.GetTilesX() * surface.GetTilesY());
+            printf("%-10s %10.2f %14.1f %12s\n", "sparse", ns, surface.GetResidentBytes() / (1024.0 * 1024.0), tiles);
+        }
+    }
+
+    //
+    // 3D-to-2D volume mappings.
+    //
+
+    enum class VolumePattern
+    {
+        Stencil,    // 7-point stencil swept in x-fastest order.
+        Box,        // 3x3x3 neighbourhoods around random voxels.
+        Column,     // Walks along z at random (x, y).
+    };
+
+    const char* VolumePatternName(VolumePattern pattern)
+    {
+        switch (pattern)
+        {
+        case VolumePattern::Stencil:    return "7-point stencil";
+        case VolumePattern::Box:        return "3x3x3 box";
+        case VolumePattern::Column:     return "z column";
+        }
+        return "unknown";
+    }
+
+    double TimeVolumePattern(HostAtomicVolume64& volume, VolumePattern pattern, uint32_t threadCount)
+    {
+        const HostVolumeLayout& layout = volume.GetLayout();
+        const uint32_t stencilSlices = 32;
+        const uint64_t boxCenters = 1 << 19;
+        const uint64_t columns = 1 << 16;
+
+        std::atomic<uint64_t> totalOps(0);
+        const double seconds = RunOnThreads(threadCount, [&](uint32_t threadIndex)
+        {
+            XorShift64 rng(threadIndex + 1);
+            uint64_t ops = 0;
+            switch (pattern)
+            {
+            case VolumePattern::Stencil:
+                for (uint32_t z = 1 + threadIndex; z <= stencilSlices; z += threadCount)
+                {
+                    for (uint32_t y = 1; y + 1 < layout.height; y++)
+                    {
+                        for (uint32_t x = 1; x + 1 < layout.width; x++)
+                        {
+                            const uint64_t value = x ^ y ^ z;
+                            volume.InterlockedMax(x, y, z, value);
+                            volume.InterlockedMax(x - 1, y, z, value);
+                            volume.InterlockedMax(x + 1, y, z, value);
+                            volume.InterlockedMax(x, y - 1, z, value);
+                            volume.InterlockedMax(x, y + 1, z, value);
+                            volume.InterlockedMax(x, y, z - 1, value);
+                            volume.InterlockedMax(x, y, z + 1, value);
+                            ops += 7;
+                        }
+                    }
+                }
+                break;
+            case VolumePattern::Box:
+                for (uint64_t i = threadIndex; i < boxCenters; i += threadCount)
+                {
+                    const uint64_t random = rng.Next();
+                    const uint32_t cx = 1 + static_cast<uint32_t>(random & 0xFFFF) % (layout.width - 2);
+                    const uint32_t cy = 1 + static_cast<uint32_t>((random >> 16) & 0xFFFF) % (layout.height - 2);
+                    const uint32_t cz = 1 + static_cast<uint32_t>((random >> 32) & 0xFFFF) % (layout.depth - 2);
+                    for (uint32_t z = cz - 1; z <= cz + 1; z++)
+                    {
+                        for (uint32_t y = cy - 1; y <= cy + 1; y++)
+                        {
+                            for (uint32_t x = cx - 1; x <= cx + 1; x++)
+                            {
+                                volume.InterlockedMax(x, y, z, random >> 48);
+                            }
+                        }
+                    }
+                    ops += 27;
+                }
+                break;
+            case VolumePattern::Column:
+                for (uint64_t i = threadIndex; i < columns; i += threadCount)
+                {
+                    const uint64_t random = rng.Next();
+                    const uint32_t x = static_cast<uint32_t>(random & 0xFFFF) % layout.width;
+                    const uint32_t y = static_cast<uint32_t>((random >> 16) & 0xFFFF) % layout.height;
+                    for (uint32_t z = 0; z < layout.depth; z++)
+                    {
+                        volume.InterlockedMax(x, y, z, z);
+                    }
+                    ops += layout.depth;
+                }
+                break;
+            }
+            totalOps.fetch_add(ops);
+        });
+
+        return seconds * 1e9 / static_cast<double>(totalOps.load());
+    }
+
+    void BenchmarkVolumeMappings()
+    {
+        const uint32_t size = 256;
+        const uint32_t threadCount = HostWorkerCount();
+        const HostVolumeMapping mappings[] = { HostVolumeMapping::SliceTiled, HostVolumeMapping::SliceTiledMorton };
+        const VolumePattern patterns[] = { VolumePattern::Stencil, VolumePattern::Box, VolumePattern::Column };
+
+        printf("%u^3 volume, %u threads, InterlockedMax, ns/op\n", size, threadCount);
+        printf("%-20s", "mapping");
+        for (VolumePattern pattern : patterns)
+        {
+            printf(" %16s", VolumePatternName(pattern));
+        }
+        printf("\n");
+
+        for (HostVolumeMapping mapping : mappings)
+        {
+            HostAtomicVolume64 volume(HostMakeVolumeLayout(size, size, size, mapping));
+            volume.Clear(0);
+            printf("%-20s", HostVolumeMappingName(mapping));
+            for (VolumePattern pattern : patterns)
+            {
+                printf(" %16.2f", TimeVolumePattern(volume, pattern, threadCount));
+            }
+            printf("\n");
+        }
+    }
+
+    //
+    // Placed-resource heap suballocation.
+    //
+
+    void BenchmarkHeapSuballocator()
+    {
+        const uint64_t operations = 1 << 22;
+        const size_t maxLive = 256;
+
+        // Surface footprints from 64 KiB to 16 MiB, log-uniform.
+        XorShift64 rng(1);
+        auto randomSize = [&rng]()
+        {
+            const uint64_t random = rng.Next();
+            return (HostPlacementAlignment << (random % 9)) + (random >> 40) % HostPlacementAlignment;
+        };
+
+        HostHeapSuballocator allocator;
+        std::vector<HostHeapAllocation> live;
+        live.reserve(maxLive);
+        uint64_t peakHeaps = 0;
+
+        // Fill to maxLive, then churn: every step frees a random surface and allocates a new one.
+        Stopwatch stopwatch;
+        for (uint64_t i = 0; i < operations; i++)
+        {
+            if (live.size() < maxLive)
+            {
+                live.push_back(allocator.Allocate(randomSize()));
+                continue;
+            }
+            const size_t index = static_cast<size_t>(rng.Next() % live.size());
+            allocator.Free(live[index]);
+            live[index] = allocator.Allocate(randomSize());
+            if ((i & 0xFFFF) == 0)
+            {
+                const uint64_t heapCount = allocator.GetStats().heapCount;
+                peakHeaps = heapCount > peakHeaps ? heapCount : peakHeaps;
+            }
+        }
+        const double ns = stopwatch.ElapsedSeconds() * 1e9 / static_cast<double>(operations);
+
+        const HostHeapStats stats = allocator.GetStats();
+        printf("buddy suballocator: %llu steps of random free + allocate, %llu live surfaces of 64 KiB - 16 MiB\n",
+            static_cast<unsigned long long>(operations), static_cast<unsigned long long>(maxLive));
+        printf("  %.1f ns/step, %llu live in %llu heaps (peak %llu) instead of %llu committed resources, %.1f%% of heap bytes in use\n",
+            ns, static_cast<unsigned long long>(stats.allocationCount), static_cast<unsigned long long>(stats.heapCount),
+            static_cast<unsigned long long>(peakHeaps), static_cast<unsigned long long>(stats.allocationCount),
+            100.0 * static_cast<double>(stats.allocatedBytes) / static_cast<double>(stats.heapBytes));
+
+        // Frame graph of transient surfaces, each live for a few consecutive passes.
+        const uint32_t passCount = 16;
+        std::vector<HostTransientSurface> transients(64);
+        uint64_t unaliasedBytes = 0;
+        for (HostTransientSurface& surface : transients)
+        {
+            surface.size = randomSize();
+            surface.firstPass = static_cast<uint32_t>(rng.Next() % passCount);
+            surface.lastPass = surface.firstPass + static_cast<uint32_t>(rng.Next() % 3);
+            unaliasedBytes += (surface.size + HostPlacementAlignment - 1) & ~(HostPlacementAlignment - 1);
+        }
+        stopwatch = Stopwatch();
+        const uint64_t aliasedBytes = HostPlanAliasing(transients.data(), transients.size());
+        printf("aliasing: %zu transient surfaces over %u passes, %.1f MiB unaliased, %.1f MiB aliased (%.2f ms to plan)\n",
+            transients.size(), passCount, unaliasedBytes / (1024.0 * 1024.0), aliasedBytes / (1024.0 * 1024.0),
+            stopwatch.ElapsedSeconds() * 1e3);
+    }
+
+    // Returns the fraction of touched bytes that were in video memory.
+    double RunVidmemFrames(HostVidmemManager& manager, HostSimulatedVidmemBudget& budget, const std::vector<uint32_t>& buffers,
+        const std::vector<uint64_t>& sizes, uint32_t frameCount, bool rebalance, double* rebalanceMicroseconds)
+    {
+        const uint64_t MiB = 1024 * 1024;
+        XorShift64 rng(7);
+        uint64_t touchedBytes = 0;
+        uint64_t vidmemBytes = 0;
+        double rebalanceSeconds = 0.0;
+
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            // Another application holds 160 MiB of the budget in the middle third.
+            budget.SetExternalUsage(frame >= frameCount / 3 && frame < 2 * frameCount / 3 ? 160 * MiB : 0);
+
+            // The hot set drifts: a window of 16 buffers that advances every 8 frames.
+            const size_t first = (frame / 8) % buffers.size();
+            for (size_t i = 0; i < 16; i++)
+            {
+                const size_t index = (first + i + static_cast<size_t>(rng.Next() % 4)) % buffers.size();
+                manager.Touch(buffers[index]);
+                touchedBytes += sizes[index];
+                vidmemBytes += manager.GetPool(buffers[index]) == HostMemoryPool::CpuVisibleVidmem ? sizes[index] : 0;
+            }
+
+            if (rebalance)
+            {
+                Stopwatch stopwatch;
+                manager.Rebalance();
+                rebalanceSeconds += stopwatch.ElapsedSeconds();
+            }
+        }
+
+        *rebalanceMicroseconds = rebalanceSeconds * 1e6 / frameCount;
+        return static_cast<double>(vidmemBytes) / static_cast<double>(touchedBytes);
+    }
+
+    void BenchmarkVidmemBudget()
+    {
+        const uint64_t MiB = 1024 * 1024;
+        const uint32_t frameCount = 3000;
+        const size_t bufferCount = 64;
+
+        for (int rebalance = 0; rebalance < 2; rebalance++)
+        {
+            // 256 MiB of CPU-visible video memory for 64 buffers of 1-16 MiB.
+            // The place callback charges the simulated budget and gives the
+            // bytes back when a buffer leaves video memory.
+            HostSimulatedVidmemBudget budget(256 * MiB);
+            std::vector<HostMemoryPool> pools(bufferCount, HostMemoryPool::System);
+            HostVidmemManager manager(budget,
+                [&budget, &pools](uint32_t buffer, uint64_t size, HostBufferKind, HostMemoryPool pool)
+                {
+                    if (pool == HostMemoryPool::CpuVisibleVidmem && !budget.Commit(size))
+                    {
+                        return false;
+                    }
+                    if (pools[buffer] == HostMemoryPool::CpuVisibleVidmem)
+                    {
+                        budget.Decommit(size);
+                    }
+                    pools[buffer] = pool;
+                    return true;
+                });
+
+            std::vector<uint64_t> sizes(bufferCount);
+            std::vector<uint32_t> buffers(bufferCount);
+            XorShift64 rng(3);
+            for (size_t i = 0; i < bufferCount; i++)
+            {
+                sizes[i] = (1 + rng.Next() % 16) * MiB;
+                buffers[i] = manager.Allocate(sizes[i], i % 2 == 0 ? HostBufferKind::Upload : HostBufferKind::Readback);
+            }
+
+            double rebalanceMicroseconds = 0.0;
+            const double hitRatio = RunVidmemFrames(manager, budget, buffers, sizes, frameCount, rebalance != 0, &rebalanceMicroseconds);
+            const HostVidmemStats stats = manager.GetStats();
+            printf("%-22s %5.1f%% of touched bytes in vidmem, %llu fallbacks, %llu demotions, %llu promotions, %.2f us/rebalance\n",
+                rebalance ? "lru rebalance:" : "first come, no moves:", 100.0 * hitRatio,
+                static_cast<unsigned long long>(stats.fallbacks), static_cast<unsigned long long>(stats.demotions),
+                static_cast<unsigned long long>(stats.promotions), rebalanceMicroseconds);
+        }
+    }
+
+    void BenchmarkDescriptorAllocator()
+    {
+        const uint32_t threadCount = HostWorkerCount();
+        const uint32_t frames = 64;
+        const uint32_t tablesPerThread = std::min<uint32_t>(4096, 100000 / threadCount);
+        const uint32_t blocks = tablesPerThread * threadCount;
+
+        // Lock-free free list. One frame slot, so blocks freed in a frame are
+        // reusable after the next BeginFrame.
+        HostDescriptorAllocator allocator(blocks, tablesPerThread * threadCount * 2, 1);
+        double lockFreeSeconds = 0.0;
+        double transientSeconds = 0.0;
+        std::atomic<uint32_t> transientFailures(0);
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            lockFreeSeconds += RunOnThreads(threadCount, [&](uint32_t)
+            {
+                std::vector<HostDescriptorTable> tables(tablesPerThread);
+                for (HostDescriptorTable& table : tables)
+                {
+                    table = allocator.AllocatePersistent(1);
+                }
+                for (const HostDescriptorTable& table : tables)
+                {
+                    allocator.FreePersistent(table);
+                }
+            });
+            transientSeconds += RunOnThreads(threadCount, [&](uint32_t)
+            {
+                uint32_t failed = 0;
+                for (uint32_t i = 0; i < tablesPerThread * 2; i++)
+                {
+                    failed += allocator.AllocateTransient(0).IsValid() ? 0 : 1;
+                }
+                transientFailures.fetch_add(failed, std::memory_order_relaxed);
+            });
+            allocator.BeginFrame();
+        }
+
+        // Mutex-guarded stack of free blocks for comparison.
+        std::mutex mutex;
+        std::vector<uint32_t> freeBlocks(blocks);
+        for (uint32_t block = 0; block < blocks; block++)
+        {
+            freeBlocks[block] = block;
+        }
+        double mutexSeconds = 0.0;
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            mutexSeconds += RunOnThreads(threadCount, [&](uint32_t)
+            {
+                std::vector<uint32_t> tables(tablesPerThread);
+                for (uint32_t& table : tables)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    table = freeBlocks.back();
+                    freeBlocks.pop_back();
+                }
+                for (uint32_t table : tables)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    freeBlocks.push_back(table);
+                }
+            });
+        }
+
+        const double persistentOps = 2.0 * frames * tablesPerThread * threadCount;
+        const double transientOps = 2.0 * frames * tablesPerThread * threadCount;
+        printf("%u threads, %u frames of %u persistent tables per thread\n", threadCount, frames, tablesPerThread);
+        printf("  lock-free free list: %.1f ns per allocate or free\n", lockFreeSeconds * 1e9 / persistentOps);
+        printf("  mutex free list:     %.1f ns per allocate or free\n", mutexSeconds * 1e9 / persistentOps);
+        printf("  transient ring:      %.1f ns per table, %u failed\n", transientSeconds * 1e9 / transientOps,
+            transientFailures.load());
+    }
+
+    void BenchmarkSurfacePool()
+    {
+        const uint32_t frames = 2000;
+        const uint32_t gpuLatency = 2;      // Frames the GPU runs behind the CPU.
+        const HostSurfaceKey keys[] =
+        {
+            { 640, 480, 36, true },         // DXGI_FORMAT_R32G32_UINT
+            { 1920, 1080, 36, true },
+            { 1920, 1080, 42, false },      // DXGI_FORMAT_R32_UINT
+            { 3840, 2160, 36, true },
+        };
+
+        uint64_t creates = 0;
+        HostSurfacePool pool(
+            [&creates](uint32_t, const HostSurfaceKey& key)
+            {
+                creates++;
+                return static_cast<uint64_t>(key.width) * key.height * (key.format == 36 ? 8 : 4);
+            },
+            HostSurfacePool::DestroyCallback());
+
+        HostSimulatedFence fence;
+        XorShift64 rng(5);
+        uint64_t acquires = 0;
+        uint64_t peakBytes = 0;
+        uint64_t trimmedBytes = 0;
+        Stopwatch stopwatch;
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            const uint64_t frameFence = fence.GetSignaledValue() + 1;
+            pool.Recycle(fence.GetCompletedValue());
+
+            // Two to six scratch surfaces per frame; the 4K one (last key)
+            // only in the first half of the run.
+            const uint32_t count = 2 + static_cast<uint32_t>(rng.Next() % 5);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const uint32_t key = static_cast<uint32_t>(rng.Next() % (frame < frames / 2 ? 4 : 3));
+                pool.Acquire(keys[key], frameFence);
+                acquires++;
+            }
+
+            fence.Signal();
+            if (fence.GetSignaledValue() > gpuLatency)
+            {
+                fence.Complete(fence.GetSignaledValue() - gpuLatency);
+            }
+
+            const uint64_t bytesHeld = pool.GetStats().bytesHeld;
+            peakBytes = bytesHeld > peakBytes ? bytesHeld : peakBytes;
+
+            // Memory pressure every 500 frames: keep at most 64 MiB idle.
+            if (frame % 500 == 499)
+            {
+                trimmedBytes += pool.Trim(64ull * 1024 * 1024);
+            }
+        }
+        const double us = stopwatch.ElapsedSeconds() * 1e6 / frames;
+
+        const HostSurfacePoolStats stats = pool.GetStats();
+        printf("%u frames, %llu scratch surfaces acquired, GPU %u frames behind\n",
+            frames, static_cast<unsigned long long>(acquires), gpuLatency);
+        printf("  %.1f%% hit rate, %llu creates instead of %llu, %llu trimmed (%.0f MiB under pressure)\n",
+            100.0 * static_cast<double>(stats.hits) / static_cast<double>(acquires), static_cast<unsigned long long>(creates),
+            static_cast<unsigned long long>(acquires), static_cast<unsigned long long>(stats.trimmed), trimmedBytes / (1024.0 * 1024.0));
+        printf("  %.0f MiB held at the end (peak %.0f MiB), %.2f us of pool work per frame\n",
+            stats.bytesHeld / (1024.0 * 1024.0), peakBytes / (1024.0 * 1024.0), us);
+    }
+
+    void BenchmarkSplitPlanes()
+    {
+        const uint32_t width = 3840;
+        const uint32_t height = 2160;
+        const uint32_t passes = 20;
+        const size_t count = static_cast<size_t>(width) * height;
+
+        // Depth in the high half, primitive ID in the low half.
+        std::vector<uint64_t> packed(count);
+        XorShift64 rng(6);
+        for (uint64_t& texel : packed)
+        {
+            texel = rng.Next();
+        }
+        const uint32_t threshold = 0xC0000000u;
+
+        HostSplitSurface64 split(width, height);
+        Stopwatch resolveWatch;
+        for (uint32_t pass = 0; pass < passes; pass++)
+        {
+            split.Resolve(packed.data(), width);
+        }
+        const double resolveNs = resolveWatch.ElapsedSeconds() * 1e9 / (static_cast<double>(passes) * count);
+
+        printf("%ux%u, high-key scan (count above threshold, min, max) over %u passes\n", width, height, passes);
+        double packedNs = 0.0;
+        double splitNs = 0.0;
+        const uint32_t workerCounts[] = { 1, HostWorkerCount() };
+        for (uint32_t workers : workerCounts)
+        {
+            if (workers == 1 && packedNs != 0.0)
+            {
+                continue;
+            }
+
+            HostHighKeyStats packedStats = {};
+            Stopwatch packedWatch;
+            for (uint32_t pass = 0; pass < passes; pass++)
+            {
+                packedStats = HostScanHighKeysPacked(packed.data(), count, threshold, workers);
+            }
+            packedNs = packedWatch.ElapsedSeconds() * 1e9 / (static_cast<double>(passes) * count);
+
+            HostHighKeyStats splitStats = {};
+            Stopwatch splitWatch;
+            for (uint32_t pass = 0; pass < passes; pass++)
+            {
+                splitStats = split.ScanHighKeys(threshold, workers);
+            }
+            splitNs = splitWatch.ElapsedSeconds() * 1e9 / (static_cast<double>(passes) * count);
+
+            printf("  %2u workers: packed %.3f ns/texel, split %.3f ns/texel (%.2fx)%s\n", workers, packedNs, splitNs,
+                packedNs / splitNs, Check(packedStats.countAbove == splitStats.countAbove) ? "" : " MISMATCH");
+        }
+
+        printf("  resolve into planes: %.3f ns/texel", resolveNs);
+        if (packedNs > splitNs)
+        {
+            printf(", pays off after %.1f scans per frame\n", resolveNs / (packedNs - splitNs));
+        }
+        else
+        {
+            printf(", never pays off here\n");
+        }
+    }
+
+    void BenchmarkReadbackDestride()
+    {
+        struct Resolution
+        {
+            const char* name;
+            uint32_t width;
+            uint32_t height;
+            uint32_t passes;
+        };
+        const Resolution resolutions[] =
+        {
+            { "4K", 3840, 2160, 20 },
+            { "16K", 15360, 8640, 2 },
+        };
+
+        for (const Resolution& resolution : resolutions)
+        {
+            // RowPitch as CopyTextureRegion lays it out (256-byte aligned).
+            const size_t rowBytes = static_cast<size_t>(resolution.width) * sizeof(uint64_t);
+            const size_t rowPitch = (rowBytes + 255) & ~static_cast<size_t>(255);
+            std::vector<uint8_t> readback(rowPitch * resolution.height, 0x5A);
+            std::vector<uint64_t> texels(static_cast<size_t>(resolution.width) * resolution.height, 0);
+            const double gigabytes = static_cast<double>(rowBytes) * resolution.height * resolution.passes / 1e9;
+
+            Stopwatch memcpyWatch;
+            for (uint32_t pass = 0; pass < resolution.passes; pass++)
+            {
+                for (uint32_t y = 0; y < resolution.height; y++)
+                {
+                    memcpy(texels.data() + static_cast<size_t>(y) * resolution.width, readback.data() + y * rowPitch, rowBytes);
+                }
+            }
+            const double memcpySeconds = memcpyWatch.ElapsedSeconds();
+
+            printf("%s (%ux%u, %.0f MiB):\n", resolution.name, resolution.width, resolution.height,
+                static_cast<double>(rowBytes) * resolution.height / (1024.0 * 1024.0));
+            printf("  memcpy per row, 1 thread: %.1f GB/s\n", gigabytes / memcpySeconds);
+
+            const HostCopyMode modes[] = { HostCopyMode::Cached, HostCopyMode::Streaming };
+            for (HostCopyMode mode : modes)
+            {
+                Stopwatch copyWatch;
+                for (uint32_t pass = 0; pass < resolution.passes; pass++)
+                {
+                    HostCopyPitchedRows(texels.data(), rowBytes, readback.data(), rowPitch, rowBytes, resolution.height, 0, mode);
+                }
+                printf("  %s stores, %u workers: %.1f GB/s\n", mode == HostCopyMode::Cached ? "cached" : "streaming",
+                    HostWorkerCount(), gigabytes / copyWatch.ElapsedSeconds());
+            }
+        }
+    }
+
+    void BenchmarkDirtyTiles()
+    {
+        const uint32_t width = 3840;
+        const uint32_t height = 2160;
+        const uint32_t frames = 30;
+        const uint32_t tileSize = HostDirtyTileMask::DefaultTileSize;
+        const size_t slotRowPitch = tileSize * sizeof(uint64_t);
+        const size_t rowBytes = static_cast<size_t>(width) * sizeof(uint64_t);
+        const double fullBytes = static_cast<double>(rowBytes) * height;
+
+        std::vector<uint64_t> surface(static_cast<size_t>(width) * height, 0);
+        std::vector<uint64_t> mirror(surface.size(), 1);
+        std::vector<uint64_t> fullCopy(surface.size(), 0);
+
+        // Time of a full de-strided readback, for comparison.
+        Stopwatch fullWatch;
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            HostCopyPitchedRows(fullCopy.data(), rowBytes, surface.data(), rowBytes, rowBytes, height);
+        }
+        const double fullMs = fullWatch.ElapsedSeconds() * 1e3 / frames;
+        printf("%ux%u, %ux%u tiles, full readback %.1f MiB and %.2f ms to de-stride per frame\n",
+            width, height, tileSize, tileSize, fullBytes / (1024.0 * 1024.0), fullMs);
+
+        const double changedFractions[] = { 0.01, 0.1, 0.5 };
+        for (double fraction : changedFractions)
+        {
+            HostDirtyTileMask mask(width, height, tileSize);
+            HostTileStagingRing ring(mask.GetTileCount());
+            std::vector<uint8_t> staging(ring.GetSlotCount() * slotRowPitch * tileSize);
+            std::vector<uint32_t> tiles;
+            std::vector<HostTileCopy> copies;
+            XorShift64 rng(7);
+
+            uint64_t copiedBytes = 0;
+            double readbackSeconds = 0.0;
+            for (uint32_t frame = 1; frame <= frames + 4; frame++)
+            {
+                // Stage the tiles earlier frames changed (the GPU's copies),
+                // then patch them on the host; the ring is retired at once,
+                // as if the GPU kept up. Frame 1 fills the mirror and is not
+                // timed.
+                tiles.clear();
+                copies.clear();
+                mask.Collect(tiles, ring.GetFreeCount());
+                for (uint32_t tile : tiles)
+                {
+                    const HostTileCopy copy = { tile, ring.Allocate(frame) };
+                    uint32_t left;
+                    uint32_t top;
+                    uint32_t tileWidth;
+                    uint32_t tileHeight;
+                    mask.GetTileRect(tile, left, top, tileWidth, tileHeight);
+                    HostCopyPitchedRows(staging.data() + copy.slot * slotRowPitch * tileSize, slotRowPitch,
+                        surface.data() + static_cast<size_t>(top) * width + left, rowBytes,
+                        tileWidth * sizeof(uint64_t), tileHeight, 1, HostCopyMode::Cached);
+                    copies.push_back(copy);
+                    copiedBytes += static_cast<uint64_t>(tileWidth) * tileHeight * sizeof(uint64_t);
+                }
+                Stopwatch patchWatch;
+                HostPatchTiles(mask, mirror.data(), rowBytes, staging.data(), slotRowPitch, copies.data(), copies.size());
+                if (frame > 1)
+                {
+                    readbackSeconds += patchWatch.ElapsedSeconds();
+                }
+                ring.Retire(frame);
+
+                // The last frames only drain the mask.
+                if (frame > frames)
+                {
+                    continue;
+                }
+
+                // Change about fraction of the surface in 48x48 rectangles.
+                const uint64_t rects = static_cast<uint64_t>(fraction * width * height / (48.0 * 48.0)) + 1;
+                for (uint64_t r = 0; r < rects; r++)
+                {
+                    const uint64_t random = rng.Next();
+                    const uint32_t left = static_cast<uint32_t>(random % (width - 48));
+                    const uint32_t top = static_cast<uint32_t>((random >> 32) % (height - 48));
+                    for (uint32_t y = top; y < top + 48; y++)
+                    {
+                        for (uint32_t x = left; x < left + 48; x++)
+                        {
+                            surface[static_cast<size_t>(y) * width + x] = (static_cast<uint64_t>(frame) << 32) | r;
+                        }
+                    }
+                    mask.MarkRect(left, top, left + 48, top + 48);
+                }
+            }
+            const double ms = readbackSeconds * 1e3 / frames;
+
+            // The first frame copies every tile to fill the mirror.
+            const double perFrame = (static_cast<double>(copiedBytes) - fullBytes) / frames;
+            printf("  %4.0f%% changed: %6.2f MiB per frame (%5.1f%% of full), %.2f ms to patch%s\n",
+                fraction * 100.0, perFrame / (1024.0 * 1024.0), 100.0 * perFrame / fullBytes, ms,
+                Check(mirror == surface) ? "" : " MISMATCH");
+        }
+    }
+
+    void BenchmarkSurfaceStats()
+    {
+        const uint32_t width = 3840;
+        const uint32_t height = 2160;
+        const uint32_t passes = 10;
+        const size_t count = static_cast<size_t>(width) * height;
+        const double gigabytes = static_cast<double>(count) * sizeof(uint64_t) * passes / 1e9;
+
+        // CSMain-like content: mostly the two sentinels, some small values.
+        std::vector<uint64_t> texels(count);
+        XorShift64 rng(8);
+        for (uint64_t& texel : texels)
+        {
+            const uint64_t random = rng.Next();
+            texel = (random & 3) == 0 ? random >> 40 : ((random & 3) == 1 ? 0 : ~0ull);
+        }
+
+        // Bandwidth reference: a plain scalar sum.
+        uint64_t reference = 0;
+        Stopwatch referenceWatch;
+        for (uint32_t pass = 0; pass < passes; pass++)
+        {
+            for (uint64_t texel : texels)
+            {
+                reference += texel;
+            }
+        }
+        printf("%ux%u, %u passes; scalar sum %.1f GB/s (checksum %llu)\n", width, height, passes,
+            gigabytes / referenceWatch.ElapsedSeconds(), static_cast<unsigned long long>(reference & 0xFF));
+
+        HostSummaryOptions minMaxSum;
+        HostSummaryOptions everything;
+        everything.countValues = { 0, ~0ull };
+        everything.binWidth = 1ull << 16;
+        everything.binCount = 256;
+        everything.perRow = true;
+        everything.tileSize = 32;
+
+        struct Case
+        {
+            const char* name;
+            const HostSummaryOptions* options;
+            uint32_t workers;
+        };
+        const Case cases[] =
+        {
+            { "min/max/sum", &minMaxSum, 1 },
+            { "min/max/sum", &minMaxSum, 0 },
+            { "+ counts, histogram, rows, tiles", &everything, 1 },
+            { "+ counts, histogram, rows, tiles", &everything, 0 },
+        };
+        for (const Case& test : cases)
+        {
+            // Zero is every worker, the same as one on a single core.
+            const uint32_t workers = test.workers == 0 ? HostWorkerCount() : test.workers;
+            if (test.workers == 0 && workers == 1)
+            {
+                continue;
+            }
+            HostSurfaceSummary summary;
+            Stopwatch watch;
+            for (uint32_t pass = 0; pass < passes; pass++)
+            {
+                summary = HostSummarizeSurface(texels.data(), width, width, height, *test.options, workers);
+            }
+            printf("  %-34s %2u workers: %.1f GB/s\n", test.name, workers, gigabytes / watch.ElapsedSeconds());
+        }
+    }
+
+    void BenchmarkSurfaceDump()
+    {
+        const uint32_t width = 1920;
+        const uint32_t height = 1080;
+        const uint32_t frames = 60;
+        const char* path = "host_surface_dump.bin";
+
+        const size_t rowBytes = static_cast<size_t>(width) * sizeof(uint64_t);
+        const size_t rowPitch = (rowBytes + 255) & ~static_cast<size_t>(255);
+        std::vector<uint8_t> readback(rowPitch * height);
+        XorShift64 rng(9);
+        for (size_t i = 0; i < readback.size(); i += sizeof(uint64_t))
+        {
+            const uint64_t random = rng.Next();
+            memcpy(&readback[i], &random, sizeof(random));
+        }
+
+        // Baseline: the frame loop writes each frame itself through stdio.
+        double blockingMax = 0;
+        Stopwatch blockingWatch;
+        FILE* file = fopen(path, "wb");
+        if (file == nullptr)
+        {
+            printf("cannot create %s\n", path);
+            return;
+        }
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            Stopwatch frameWatch;
+            for (uint32_t y = 0; y < height; y++)
+            {
+                fwrite(&readback[y * rowPitch], 1, rowPitch, file);
+            }
+            blockingMax = std::max(blockingMax, frameWatch.ElapsedSeconds());
+        }
+        fclose(file);
+        const double blockingSeconds = blockingWatch.ElapsedSeconds();
+        printf("%ux%u, %u frames of %.1f MiB\n", width, height, frames, static_cast<double>(rowPitch) * height / (1024.0 * 1024.0));
+        printf("  blocking fwrite:  %6.2f ms per frame, %6.2f ms worst\n", blockingSeconds * 1e3 / frames, blockingMax * 1e3);
+
+        // The writer, with the frame loop pacing itself at 60 Hz. Each frame
+        // stamps its number into the first texel of every row, so the reader
+        // can tell the records apart.
+        std::vector<uint64_t> firstColumn(height);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            memcpy(&firstColumn[y], &readback[y * rowPitch], sizeof(uint64_t));
+        }
+        auto stamp = [](uint64_t frame) { return frame * 0x9E3779B97F4A7C15ull; };
+        HostSurfaceDumpStats stats = {};
+        double submitSeconds = 0;
+        double submitMax = 0;
+        double flushSeconds = 0;
+        bool unbuffered = false;
+        {
+            HostSurfaceDumpWriter writer(path, width, height);
+            unbuffered = writer.IsUnbuffered();
+            for (uint32_t frame = 0; frame < frames; frame++)
+            {
+                for (uint32_t y = 0; y < height; y++)
+                {
+                    const uint64_t first = firstColumn[y] ^ stamp(frame);
+                    memcpy(&readback[y * rowPitch], &first, sizeof(first));
+                }
+                Stopwatch frameWatch;
+                writer.Submit(readback.data(), rowPitch, frame, frame + 1);
+                const double seconds = frameWatch.ElapsedSeconds();
+                submitSeconds += seconds;
+                submitMax = std::max(submitMax, seconds);
+                std::this_thread::sleep_for(std::chrono::microseconds(16667) - std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::duration<double>(seconds)));
+            }
+            Stopwatch flushWatch;
+            writer.Flush();
+            flushSeconds = flushWatch.ElapsedSeconds();
+            stats = writer.GetStats();
+        }
+        printf("  dump writer (%s): %6.2f ms per frame, %6.2f ms worst; %llu written, %llu dropped, %llu failed, %.2f ms final flush\n",
+            unbuffered ? "unbuffered" : "buffered", submitSeconds * 1e3 / frames, submitMax * 1e3,
+            static_cast<unsigned long long>(stats.written), static_cast<unsigned long long>(stats.dropped),
+            static_cast<unsigned long long>(stats.failed), flushSeconds * 1e3);
+
+        // Zero-copy read back: every record in place against the frame that
+        // was submitted. Dropped frames leave gaps, but frames stay in order.
+        Stopwatch readWatch;
+        size_t records = 0;
+        size_t badRecords = 0;
+        {
+            HostSurfaceDumpReader reader(path);
+            records = reader.GetRecordCount();
+            uint64_t previousFrame = 0;
+            for (size_t record = 0; record < records; record++)
+            {
+                const HostSurfaceDumpHeader& header = reader.GetHeader(record);
+                bool good = header.magic == HostSurfaceDumpMagic && header.version == HostSurfaceDumpVersion &&
+                    header.width == width && header.height == height && header.rowPitch == rowPitch &&
+                    header.frame < frames && (record == 0 || header.frame > previousFrame) && header.fence == header.frame + 1;
+                previousFrame = header.frame;
+
+                const uint64_t* texels = reader.GetTexels(record);
+                for (uint32_t y = 0; y < height && good; y++)
+                {
+                    const uint64_t* row = texels + y * (rowPitch / sizeof(uint64_t));
+                    good = row[0] == (firstColumn[y] ^ stamp(header.frame)) &&
+                        memcmp(row + 1, &readback[y * rowPitch + sizeof(uint64_t)], rowBytes - sizeof(uint64_t)) == 0;
+                }
+                badRecords += good ? 0 : 1;
+            }
+        }
+        const bool complete = records == stats.written;
+        printf("  mapped reader: %zu records in %.1f ms, %zu differ from their frame%s\n", records, readWatch.ElapsedSeconds() * 1e3,
+            badRecords, Check(badRecords == 0 && complete) ? "" : " MISMATCH");
+        remove(path);
+    }
+
+    void BenchmarkSurfaceCompression()
+    {
+        const uint32_t width = 3840;
+        const uint32_t height = 2160;
+        const uint32_t passes = 5;
+        const size_t count = static_cast<size_t>(width) * height;
+
+        // CSMain-like content: bands of all-ones and zero with a sprinkling of
+        // other values, and random texels as the worst case.
+        std::vector<uint64_t> banded(count);
+        std::vector<uint64_t> random(count);
+        XorShift64 rng(10);
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint32_t x = static_cast<uint32_t>(i % width);
+            const uint64_t noise = rng.Next();
+            banded[i] = (noise & 1023) == 0 ? noise >> 40 : ((x / 200) % 2 == 0 ? ~0ull : 0);
+            random[i] = rng.Next();
+        }
+
+        struct Content
+        {
+            const char* name;
+            const std::vector<uint64_t>* texels;
+        };
+        const Content contents[] =
+        {
+            { "banded", &banded },
+            { "random", &random },
+        };
+        const double gigabytes = static_cast<double>(count) * sizeof(uint64_t) * passes / 1e9;
+        std::vector<uint8_t> stream;
+        std::vector<uint64_t> decoded(count);
+        for (const Content& content : contents)
+        {
+            HostCompressionStats stats = {};
+            Stopwatch encodeWatch;
+            for (uint32_t pass = 0; pass < passes; pass++)
+            {
+                stats = HostCompressSurface(stream, content.texels->data(), width, width, height);
+            }
+            const double encodeSeconds = encodeWatch.ElapsedSeconds();
+
+            const HostCompressedSurface surface(stream.data(), stream.size());
+            Stopwatch decodeWatch;
+            for (uint32_t pass = 0; pass < passes; pass++)
+            {
+                surface.Decode(decoded.data(), width);
+            }
+            const double decodeSeconds = decodeWatch.ElapsedSeconds();
+            const bool exact = decoded == *content.texels;
+
+            const uint32_t loads = 1000000;
+            uint64_t checksum = 0;
+            Stopwatch loadWatch;
+            for (uint32_t i = 0; i < loads; i++)
+            {
+                const uint64_t r = rng.Next();
+                checksum += surface.Load(static_cast<uint32_t>(r % width), static_cast<uint32_t>((r >> 32) % height));
+            }
+            const double loadNs = loadWatch.ElapsedSeconds() * 1e9 / loads;
+
+            printf("%s %ux%u: %.1f MiB -> %.2f MiB (%.0fx); %llu constant, %llu run-length, %llu raw tiles%s\n",
+                content.name, width, height,
+                static_cast<double>(stats.uncompressedBytes) / (1024.0 * 1024.0),
+                static_cast<double>(stats.compressedBytes) / (1024.0 * 1024.0),
+                static_cast<double>(stats.uncompressedBytes) / static_cast<double>(stats.compressedBytes),
+                static_cast<unsigned long long>(stats.constantTiles),
+                static_cast<unsigned long long>(stats.runLengthTiles),
+                static_cast<unsigned long long>(stats.rawTiles),
+                Check(exact) ? "" : " MISMATCH");
+            printf("  encode %.1f GB/s, decode %.1f GB/s, random Load %.1f ns (%u workers, checksum %llu)\n",
+                gigabytes / encodeSeconds, gigabytes / decodeSeconds, loadNs, HostWorkerCount(),
+                static_cast<unsigned long long>(checksum & 0xFF));
+        }
+    }
+
+    void BenchmarkVisualize()
+    {
+        const uint32_t width = 3840;
+        const uint32_t height = 2160;
+        const uint32_t passes = 5;
+        const size_t count = static_cast<size_t>(width) * height;
+
+        // Values spread over the whole 64-bit range, so every branch of the
+        // log and word modes is taken.
+        std::vector<uint64_t> texels(count);
+        XorShift64 rng(11);
+        for (uint64_t& texel : texels)
+        {
+            const uint64_t r = rng.Next();
+            texel = r >> (r & 63);
+        }
+
+        struct Mode
+        {
+            const char* name;
+            HostVisualizeMode mode;
+        };
+        const Mode modes[] =
+        {
+            { "low word", HostVisualizeMode::LowWord },
+            { "high word", HostVisualizeMode::HighWord },
+            { "log2", HostVisualizeMode::Log2 },
+            { "id hash", HostVisualizeMode::IdHash },
+        };
+        const double gigabytes = static_cast<double>(count) * sizeof(uint64_t) * passes / 1e9;
+        std::vector<uint32_t> rgba(count);
+        for (const Mode& mode : modes)
+        {
+            const HostVisualizeConstants constants = HostMakeVisualizeConstants(mode.mode);
+            Stopwatch watch;
+            for (uint32_t pass = 0; pass < passes; pass++)
+            {
+                HostVisualizeSurface(rgba.data(), width, texels.data(), width, width, height, constants);
+            }
+            const double seconds = watch.ElapsedSeconds();
+
+            // Every texel against the scalar conversion, so a vectorized or
+            // threaded path that drifts from it shows up here.
+            size_t mismatches = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                mismatches += rgba[i] != HostVisualizeTexel(texels[i], constants) ? 1 : 0;
+            }
+            printf("%-9s %ux%u: %.1f GB/s of source, %.2f ms per frame (%u workers)%s\n",
+                mode.name, width, height, gigabytes / seconds, seconds * 1e3 / passes, HostWorkerCount(),
+                Check(mismatches == 0) ? "" : " MISMATCH");
+        }
+    }
+
+    void BenchmarkSurfaceDiff()
+    {
+        // A quarter of a 16K x 16K surface, to stay within small hosts'
+        // memory; times are scaled up to the whole surface.
+        const uint32_t width = 16384;
+        const uint32_t height = 4096;
+        const uint32_t scale = 4;
+        const uint32_t passes = 3;
+        const size_t count = static_cast<size_t>(width) * height;
+
+        // Doubles, and a capture that differs from the golden in one texel
+        // in ten thousand, by one ULP in half of those.
+        std::vector<uint64_t> golden(count);
+        std::vector<uint64_t> actual(count);
+        std::vector<size_t> injected;
+        const uint64_t farUlp = 1ull << 40;
+        const uint64_t mask = ~0ull << 32;
+        XorShift64 rng(12);
+        for (size_t i = 0; i < count; i++)
+        {
+            double value = static_cast<double>(i % width) / 7.0 + static_cast<double>(i / width);
+            memcpy(&golden[i], &value, sizeof(value));
+            actual[i] = golden[i];
+            const uint64_t r = rng.Next();
+            if (r % 10000 == 0)
+            {
+                actual[i] += (r >> 32) % 2 == 0 ? 1 : farUlp;
+                injected.push_back(i);
+            }
+        }
+
+        struct Case
+        {
+            const char* name;
+            HostDiffMode mode;
+            const std::vector<uint64_t>* actual;
+        };
+        const Case cases[] =
+        {
+            { "identical", HostDiffMode::Exact, &golden },
+            { "exact", HostDiffMode::Exact, &actual },
+            { "masked", HostDiffMode::Masked, &actual },
+            { "double ulp", HostDiffMode::DoubleUlp, &actual },
+        };
+        const double gigabytes = 2.0 * count * sizeof(uint64_t) * passes / 1e9;
+        HostSurfaceDiff diff = {};
+        for (const Case& test : cases)
+        {
+            HostDiffOptions options;
+            options.mode = test.mode;
+            options.bitMask = mask;
+            options.ulpTolerance = 1;
+            Stopwatch watch;
+            for (uint32_t pass = 0; pass < passes; pass++)
+            {
+                HostDiffSurfaces(diff, test.actual->data(), width, golden.data(), width, width, height, options);
+            }
+            const double seconds = watch.ElapsedSeconds();
+
+            // What the diff must find among the injected texels: all of them
+            // exactly, those that touch the high word masked, and the far ones
+            // at one ULP of tolerance (the doubles are positive, so ULPs are
+            // integer steps). Every other texel is identical.
+            std::vector<uint64_t> expectedTiles(diff.tileMismatches.size(), 0);
+            std::vector<HostDiffMismatch> expectedFirst;
+            uint64_t expectedCount = 0;
+            for (size_t i : injected)
+            {
+                const uint64_t a = (*test.actual)[i];
+                const bool mismatch =
+                    test.mode == HostDiffMode::Masked ? ((a ^ golden[i]) & mask) != 0 :
+                    test.mode == HostDiffMode::DoubleUlp ? a - golden[i] > options.ulpTolerance :
+                    a != golden[i];
+                if (!mismatch)
+                {
+                    continue;
+                }
+                const uint32_t x = static_cast<uint32_t>(i % width);
+                const uint32_t y = static_cast<uint32_t>(i / width);
+                expectedCount++;
+                expectedTiles[static_cast<size_t>(y / options.tileSize) * diff.tilesX + x / options.tileSize]++;
+                if (expectedFirst.size() < options.maxMismatches)
+                {
+                    expectedFirst.push_back({ x, y, a, golden[i] });
+                }
+            }
+            bool match = diff.mismatchCount == expectedCount && diff.tileMismatches == expectedTiles &&
+                diff.mismatches.size() == expectedFirst.size();
+            for (size_t i = 0; i < expectedFirst.size() && match; i++)
+            {
+                const HostDiffMismatch& found = diff.mismatches[i];
+                const HostDiffMismatch& expected = expectedFirst[i];
+                match = found.x == expected.x && found.y == expected.y &&
+                    found.actual == expected.actual && found.golden == expected.golden;
+            }
+            if (test.mode == HostDiffMode::DoubleUlp)
+            {
+                match = match && diff.maxUlpDistance == farUlp;
+            }
+
+            printf("%-10s %ux%u: %.1f GB/s, %.0f ms per 16K x 16K (%u workers); %llu mismatches, max %llu ULP%s\n",
+                test.name, width, height, gigabytes / seconds, seconds * 1e3 * scale / passes, HostWorkerCount(),
+                static_cast<unsigned long long>(diff.mismatchCount),
+                static_cast<unsigned long long>(diff.maxUlpDistance),
+                Check(match) ? "" : " MISMATCH");
+        }
+    }
+
+    // Records the sample's steady-state frame three ways: re-recording every
+    // command and recomputing the readback footprint, as OnRender did;
+    // setting root arguments around pre-recorded bundles with a cached copy
+    // plan; and patching the constants of a stream recorded once.
+    void BenchmarkCommandRecording()
+    {
+        enum : uint32_t
+        {
+            RenderTarget = 1, ComputeTexture, ReadbackBuffer,
+            GraphicsRoot = 10, ComputeRoot, GraphicsPipeline, ComputePipeline,
+            Present = 0, RenderTargetState = 4, UnorderedAccess = 8, CopySource = 0x800,
+        };
+        const uint32_t frames = 200000;
+        const uint32_t width = 640;
+        const uint32_t height = 480;
+
+        struct View
+        {
+            uint32_t originX;
+            uint32_t originY;
+            uint32_t width;
+            uint32_t height;
+        };
+        View view = { 0, 0, width, height };
+
+        // What GetCopyableFootprints works out for the view.
+        auto copyPlan = [](const View& v)
+        {
+            HostCopyRegion region = {};
+            region.source = ComputeTexture;
+            region.destination = ReadbackBuffer;
+            region.rowPitch = (v.width * 8 + 255) & ~255u;
+            region.left = v.originX;
+            region.top = v.originY;
+            region.right = v.originX + v.width;
+            region.bottom = v.originY + v.height;
+            return region;
+        };
+
+        uint64_t checksum = 0;
+        auto consume = [&](const HostCommand& command)
+        {
+            checksum += static_cast<uint32_t>(command.type) + command.argCount;
+        };
+
+        // The commands a list replays, with bundles expanded, as type,
+        // argCount, args... words. All three ways of building the frame
+        // must replay the same sequence.
+        auto flatten = [](const HostCommandRecorder& list)
+        {
+            std::vector<uint32_t> words;
+            list.Replay([&](const HostCommand& command)
+            {
+                words.push_back(static_cast<uint32_t>(command.type));
+                words.push_back(command.argCount);
+                words.insert(words.end(), command.args, command.args + command.argCount);
+            });
+            return words;
+        };
+
+        HostCommandRecorder direct;
+        Stopwatch recordWatch;
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            view.originX = frame & 1;
+            direct.Reset();
+            direct.SetRootSignature(GraphicsRoot);
+            direct.SetDescriptorTable(0, 0);
+            direct.Barrier(RenderTarget, Present, RenderTargetState);
+            direct.Draw(3, 1);
+            direct.SetRootSignature(ComputeRoot);
+            direct.SetDescriptorTable(0, 8);
+            direct.SetRootConstants(1, 4, &view);
+            direct.SetPipelineState(ComputePipeline);
+            direct.Dispatch((view.width + 31) / 32, (view.height + 31) / 32, 1);
+            direct.Barrier(ComputeTexture, UnorderedAccess, CopySource);
+            direct.CopyRegion(copyPlan(view));
+            direct.Barrier(ComputeTexture, CopySource, UnorderedAccess);
+            direct.Barrier(RenderTarget, RenderTargetState, Present);
+        }
+        const double recordSeconds = recordWatch.ElapsedSeconds();
+        const std::vector<uint32_t> recordWords = flatten(direct);
+        const size_t recordCommands = direct.GetCommandCount();
+
+        HostCommandRecorder drawBundle(HostCommandListType::Bundle);
+        drawBundle.Draw(3, 1);
+        HostCommandRecorder computeBundle(HostCommandListType::Bundle);
+        computeBundle.SetPipelineState(ComputePipeline);
+        computeBundle.Dispatch((view.width + 31) / 32, (view.height + 31) / 32, 1);
+        const HostCopyRegion cachedPlan = copyPlan(view);
+        Stopwatch bundleWatch;
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            view.originX = frame & 1;
+            direct.Reset();
+            direct.SetRootSignature(GraphicsRoot);
+            direct.SetDescriptorTable(0, 0);
+            direct.Barrier(RenderTarget, Present, RenderTargetState);
+            direct.ExecuteBundle(drawBundle);
+            direct.SetRootSignature(ComputeRoot);
+            direct.SetDescriptorTable(0, 8);
+            direct.SetRootConstants(1, 4, &view);
+            direct.ExecuteBundle(computeBundle);
+            direct.Barrier(ComputeTexture, UnorderedAccess, CopySource);
+            direct.CopyRegion(cachedPlan);
+            direct.Barrier(ComputeTexture, CopySource, UnorderedAccess);
+            direct.Barrier(RenderTarget, RenderTargetState, Present);
+        }
+        const double bundleSeconds = bundleWatch.ElapsedSeconds();
+        const bool bundleMatches = flatten(direct) == recordWords;
+        const size_t bundleCommands = direct.GetCommandCount();
+
+        HostCommandRecorder recorded;
+        recorded.SetRootSignature(GraphicsRoot);
+        recorded.SetDescriptorTable(0, 0);
+        recorded.Barrier(RenderTarget, Present, RenderTargetState);
+        recorded.ExecuteBundle(drawBundle);
+        recorded.SetRootSignature(ComputeRoot);
+        recorded.SetDescriptorTable(0, 8);
+        const uint32_t viewSlot = recorded.SetPatchableRootConstants(1, 4, &view);
+        recorded.ExecuteBundle(computeBundle);
+        recorded.Barrier(ComputeTexture, UnorderedAccess, CopySource);
+        recorded.CopyRegion(cachedPlan);
+        recorded.Barrier(ComputeTexture, CopySource, UnorderedAccess);
+        recorded.Barrier(RenderTarget, RenderTargetState, Present);
+        Stopwatch patchWatch;
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            view.originX = frame & 1;
+            recorded.Patch(viewSlot, &view);
+        }
+        const double patchSeconds = patchWatch.ElapsedSeconds();
+
+        // The last patch left the last frame's view, which both direct runs
+        // also ended with.
+        const bool patchMatches = flatten(recorded) == recordWords;
+
+        Stopwatch replayWatch;
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            recorded.Replay(consume);
+        }
+        const double replaySeconds = replayWatch.ElapsedSeconds();
+
+        printf("re-record every frame:     %6.1f ns per frame (%zu commands)\n", recordSeconds * 1e9 / frames, recordCommands);
+        printf("root arguments + bundles:  %6.1f ns per frame (%zu commands)%s\n", bundleSeconds * 1e9 / frames, bundleCommands,
+            Check(bundleMatches) ? "" : " MISMATCH");
+        printf("patch a recorded stream:   %6.1f ns per frame (%zu bytes recorded)%s\n", patchSeconds * 1e9 / frames, recorded.GetByteCount(),
+            Check(patchMatches) ? "" : " MISMATCH");
+        printf("replay the recorded frame: %6.1f ns per frame (checksum %llu)\n", replaySeconds * 1e9 / frames,
+            static_cast<unsigned long long>(checksum));
+    }
+
+    // Time that moves only when the limiter sleeps or spins, or when the
+    // caller advances it. Every sleep returns oversleep late.
+    class SimulatedFrameClock : public HostFrameClock
+    {
+    public:
+        static const int64_t SpinStep = 1000;
+
+        explicit SimulatedFrameClock(int64_t oversleep) :
+            m_oversleep(oversleep)
+        {
+        }
+
+        int64_t Now() override
+        {
+            return m_now;
+        }
+
+        void SleepUntil(int64_t deadline) override
+        {
+            m_now = deadline + m_oversleep > m_now ? deadline + m_oversleep : m_now;
+        }
+
+        void Spin() override
+        {
+            m_now += SpinStep;
+        }
+
+        void Advance(int64_t nanoseconds)
+        {
+            m_now += nanoseconds;
+        }
+
+    private:
+        int64_t m_now = 0;
+        int64_t m_oversleep;
+    };
+
+    // Plays back one visibility per pump and counts what the loop asks for.
+    class SimulatedFrameLoopHost : public HostFrameLoopHost
+    {
+    public:
+        explicit SimulatedFrameLoopHost(std::vector<bool> visibility) :
+            m_visibility(std::move(visibility))
+        {
+        }
+
+        bool PumpEvents() override
+        {
+            if (m_pump == m_visibility.size())
+            {
+                return false;
+            }
+            m_visible = m_visibility[m_pump++];
+            m_waitsThisPump = 0;
+            return true;
+        }
+
+        void WaitForEvents() override
+        {
+            waits++;
+            visibleWaits += m_visible ? 1 : 0;
+            repeatedWaits += m_waitsThisPump++ > 0 ? 1 : 0;
+        }
+
+        bool IsVisible() override
+        {
+            return m_visible;
+        }
+
+        void RenderFrame() override
+        {
+            renders++;
+            hiddenRenders += m_visible ? 0 : 1;
+        }
+
+        uint64_t waits = 0;
+        uint64_t visibleWaits = 0;
+        uint64_t repeatedWaits = 0;     // Beyond the first in one pump.
+        uint64_t renders = 0;
+        uint64_t hiddenRenders = 0;
+
+    private:
+        std::vector<bool> m_visibility;
+        size_t m_pump = 0;
+        bool m_visible = false;
+        uint32_t m_waitsThisPump = 0;
+    };
+
+    // Paces empty frames on the system clock and reports how close to the
+    // deadlines they start, and how much of the time the limiter spins.
+    void BenchmarkFrameLimiter()
+    {
+        const double rates[] = { 60.0, 240.0, 1000.0 };
+        const double seconds = 0.5;
+        for (double rate : rates)
+        {
+            HostFrameLimiter limiter(rate);
+            const uint32_t frames = static_cast<uint32_t>(rate * seconds);
+            Stopwatch watch;
+            for (uint32_t frame = 0; frame < frames; frame++)
+            {
+                limiter.WaitForNextFrame();
+            }
+            const double elapsed = watch.ElapsedSeconds();
+
+            const HostFrameLimiterStats& stats = limiter.GetStats();
+            printf("%6.0f Hz: %u frames in %.3f s; start error mean %.1f us, max %.1f us; spinning %.1f%%, sleeping %.1f%% (spin window %.0f us)\n",
+                rate, frames, elapsed,
+                static_cast<double>(stats.totalErrorNanoseconds) / 1e3 / frames,
+                static_cast<double>(stats.maxErrorNanoseconds) / 1e3,
+                static_cast<double>(stats.spinNanoseconds) / 1e7 / elapsed,
+                static_cast<double>(stats.sleepNanoseconds) / 1e7 / elapsed,
+                static_cast<double>(limiter.GetSpinWindow()) / 1e3);
+        }
+
+        // The same schedule against simulated time, where every start can be
+        // checked exactly. Frames take a quarter of the interval to render
+        // and sleeps return 300 us late.
+        SimulatedFrameClock clock(300000);
+        HostFrameLimiter limiter(240.0, clock);
+        const int64_t interval = limiter.GetInterval();
+        const int64_t work = interval / 4;
+
+        // Starts no earlier than their deadline and within one spin step of
+        // it, interval apart from the first.
+        limiter.WaitForNextFrame();
+        const int64_t first = clock.Now();
+        bool spaced = true;
+        const uint32_t frames = 100;
+        for (uint32_t frame = 1; frame < frames; frame++)
+        {
+            clock.Advance(work);
+            limiter.WaitForNextFrame();
+            const int64_t deadline = first + frame * interval;
+            spaced = spaced && clock.Now() >= deadline && clock.Now() - deadline < SimulatedFrameClock::SpinStep;
+        }
+        const HostFrameLimiterStats& stats = limiter.GetStats();
+        const bool slept = stats.spinNanoseconds < stats.sleepNanoseconds / 4;
+
+        // A frame more than an interval behind starts at once and restarts the
+        // schedule from there.
+        clock.Advance(3 * interval);
+        const int64_t stalled = clock.Now();
+        limiter.WaitForNextFrame();
+        const bool restarted = clock.Now() == stalled && stats.lateFrames == 1;
+        clock.Advance(work);
+        limiter.WaitForNextFrame();
+        const bool respaced = clock.Now() >= stalled + interval && clock.Now() - (stalled + interval) < SimulatedFrameClock::SpinStep;
+
+        // One less than an interval behind also starts at once, but keeps
+        // the schedule and is not counted.
+        clock.Advance(interval + interval / 2);
+        const int64_t behind = clock.Now();
+        limiter.WaitForNextFrame();
+        bool caughtUp = clock.Now() == behind && stats.lateFrames == 1;
+        clock.Advance(work);
+        limiter.WaitForNextFrame();
+        caughtUp = caughtUp && clock.Now() >= stalled + 3 * interval && clock.Now() - (stalled + 3 * interval) < SimulatedFrameClock::SpinStep;
+
+        // Hidden pumps wait for events once each and never render or reach
+        // the limiter.
+        std::vector<bool> visibility(20, false);
+        for (size_t pump = 5; pump < 12; pump++)
+        {
+            visibility[pump] = true;
+        }
+        SimulatedFrameLoopHost host(visibility);
+        HostFrameLimiter loopLimiter(60.0, clock);
+        const HostFrameLoopStats loop = HostRunFrameLoop(host, &loopLimiter);
+        const bool idle = host.hiddenRenders == 0 && host.visibleWaits == 0 && host.repeatedWaits == 0 &&
+            host.waits == 13 && loop.idleWaits == 13;
+        const bool rendered = host.renders == 7 && loop.frames == 7 && loopLimiter.GetStats().frames == 7;
+
+        printf("simulated 240 Hz: deadlines spaced %s, mostly slept %s, late frame restarts %s, restarted schedule spaced %s, slightly late keeps schedule %s\n",
+            Check(spaced) ? "yes" : "NO", Check(slept) ? "yes" : "NO", Check(restarted) ? "yes" : "NO",
+            Check(respaced) ? "yes" : "NO", Check(caughtUp) ? "yes" : "NO");
+        printf("simulated loop: hidden pumps wait once and never render %s, visible pumps render once each %s\n",
+            Check(idle) ? "yes" : "NO", Check(rendered) ? "yes" : "NO");
+    }
+
+    void BenchmarkParallelRecording()
+    {
+        // Four streams of compute passes, each pass depending on the one
+        // after it in its stream, so the submission order differs from pass
+        // order; every pass is a run of small dispatches with their own root
+        // constants.
+        const uint32_t passCount = 32;
+        const uint32_t dispatchesPerPass = 1024;
+        const uint32_t streams = 4;
+        const uint32_t frameCount = 2;
+        const uint32_t frames = 200;
+
+        std::vector<HostRecordingPass> passes(passCount);
+        for (uint32_t pass = 0; pass < passCount; pass++)
+        {
+            if (pass + streams < passCount)
+            {
+                passes[pass].dependencies.push_back(pass + streams);
+            }
+            passes[pass].record = [pass](HostCommandRecorder& list)
+            {
+                list.SetPipelineState(pass);
+                list.SetRootSignature(1);
+                list.SetDescriptorTable(0, pass * 8);
+                for (uint32_t dispatch = 0; dispatch < dispatchesPerPass; dispatch++)
+                {
+                    const uint32_t constants[4] = { pass, dispatch, dispatch * 64, 64 };
+                    list.SetRootConstants(1, 4, constants);
+                    list.Dispatch(2, 2, 1);
+                }
+                list.Barrier(pass, 8, 8);
+            };
+        }
+
+        double baseline = 0;
+        for (uint32_t workers = 1; ; workers *= 2)
+        {
+            workers = workers < HostWorkerCount() ? workers : HostWorkerCount();
+            HostParallelRecorder recorder(frameCount, workers);
+            recorder.SetPasses(passes);
+            recorder.RecordFrame(0);    // Warm the allocators.
+
+            size_t commands = 0;
+            const std::vector<const HostCommandRecorder*>* lists = nullptr;
+            Stopwatch watch;
+            for (uint32_t frame = 0; frame < frames; frame++)
+            {
+                lists = &recorder.RecordFrame(frame % frameCount);
+                for (const HostCommandRecorder* list : *lists)
+                {
+                    commands += list->GetCommandCount();
+                }
+            }
+            const double seconds = watch.ElapsedSeconds();
+            baseline = workers == 1 ? seconds : baseline;
+
+            // Each list starts with its pass's pipeline. Every pass must be
+            // submitted once, whole, and after the passes it depends on.
+            std::vector<bool> submitted(passCount, false);
+            bool ordered = lists->size() == passCount;
+            for (const HostCommandRecorder* list : *lists)
+            {
+                uint32_t pass = passCount;
+                list->Replay([&](const HostCommand& command)
+                {
+                    if (pass == passCount && command.type == HostCommandType::SetPipelineState)
+                    {
+                        pass = command.args[0];
+                    }
+                });
+                if (pass >= passCount || submitted[pass] || list->GetCommandCount() != 4 + 2 * dispatchesPerPass)
+                {
+                    ordered = false;
+                    break;
+                }
+                for (uint32_t dependency : passes[pass].dependencies)
+                {
+                    ordered = ordered && submitted[dependency];
+                }
+                submitted[pass] = true;
+            }
+
+            printf("%3u workers: %.3f ms per frame, %.1f M commands/s, %.2fx; dependency order %s\n",
+                workers, seconds * 1e3 / frames, commands / seconds / 1e6, baseline / seconds, Check(ordered) ? "yes" : "NO");
+            if (workers == HostWorkerCount())
+            {
+                break;
+            }
+        }
+    }
+
+    void BenchmarkFrameTimeline()
+    {
+        const uint32_t scopes = 4000000;
+
+        // A null timeline is what instrumented code costs with -timeline off.
+        HostFrameTimeline* const disabled = nullptr;
+        uint64_t sink = 0;
+        Stopwatch offWatch;
+        for (uint32_t i = 0; i < scopes; i++)
+        {
+            HostTimelineScope scope(disabled, i & 7);
+            sink += i;
+        }
+        const double offSeconds = offWatch.ElapsedSeconds();
+
+        HostFrameTimeline timeline({ "a", "b", "c", "d", "e", "f", "g", "h" });
+        Stopwatch onWatch;
+        for (uint32_t i = 0; i < scopes; i++)
+        {
+            HostTimelineScope scope(&timeline, i & 7);
+            sink += i;
+        }
+        const double onSeconds = onWatch.ElapsedSeconds();
+
+        // Every worker files into its own log.
+        const uint32_t workers = HostWorkerCount();
+        Stopwatch parallelWatch;
+        HostParallelRun(workers, [&](uint32_t worker)
+        {
+            for (uint32_t i = 0; i < scopes / workers; i++)
+            {
+                HostTimelineScope scope(&timeline, (i + worker) & 7);
+            }
+        });
+        const double parallelSeconds = parallelWatch.ElapsedSeconds();
+
+        Stopwatch summaryWatch;
+        const std::vector<HostTimelinePhaseSummary> summary = timeline.Summarize();
+        const double summarySeconds = summaryWatch.ElapsedSeconds();
+
+        uint64_t count = 0;
+        for (const HostTimelinePhaseSummary& phase : summary)
+        {
+            count += phase.count;
+        }
+        printf("disabled: %.2f ns per scope (sink %llu)\n", offSeconds * 1e9 / scopes, static_cast<unsigned long long>(sink & 1));
+        printf("enabled: %.1f ns per scope, one thread; %.1f ns per scope per thread on %u threads\n",
+            onSeconds * 1e9 / scopes, parallelSeconds * 1e9 * workers / (scopes / workers * workers), workers);
+        printf("summary of %llu events in %.3f ms; counter at %.3f GHz; phase a p50 %.3f us, p99 %.3f us\n",
+            static_cast<unsigned long long>(count), summarySeconds * 1e3, timeline.GetTicksPerSecond() / 1e9,
+            summary[0].p50Microseconds, summary[0].p99Microseconds);
+    }
+
+    void BenchmarkAtlas()
+    {
+        // Max pyramids in even slices and Min pyramids in odd ones. The odd
+        // layout exercises the folded last row and column at every level.
+        const HostAtlasLayout layouts[] =
+        {
+            { 512, 256, 2, 4 },
+            { 517, 259, 3, HostFullMipCount(517, 259) },
+            { 2048, 2048, 2, HostFullMipCount(2048, 2048) },
+        };
+
+        printf("%-22s %12s %8s\n", "mip 0 x slices, mips", "build ms", "match");
+        for (const HostAtlasLayout& layout : layouts)
+        {
+            HostAtomicSurface64 surface(layout.AtlasWidth(), layout.AtlasHeight());
+            surface.Clear(0);
+            XorShift64 rng(layout.width);
+            for (uint32_t slice = 0; slice < layout.arraySize; slice++)
+            {
+                const HostTexelCoord origin = layout.Origin(slice, 0);
+                for (uint32_t y = 0; y < layout.height; y++)
+                {
+                    for (uint32_t x = 0; x < layout.width; x++)
+                    {
+                        surface.Store(origin.x + x, origin.y + y, rng.Next());
+                    }
+                }
+            }
+
+            Stopwatch watch;
+            for (uint32_t slice = 0; slice < layout.arraySize; slice++)
+            {
+                HostBuildAtlasMips(surface, layout, slice, slice % 2 == 0 ? HostAtomicOp::Max : HostAtomicOp::Min);
+            }
+            const double seconds = watch.ElapsedSeconds();
+
+            // Texel x of level L covers mip 0 columns [x << L, (x + 1) << L),
+            // and the last texel also takes the columns folded into it.
+            bool match = true;
+            for (uint32_t slice = 0; slice < layout.arraySize && match; slice++)
+            {
+                const HostAtomicOp op = slice % 2 == 0 ? HostAtomicOp::Max : HostAtomicOp::Min;
+                const HostTexelCoord base = layout.Origin(slice, 0);
+                for (uint32_t level = 1; level < layout.mipLevels && match; level++)
+                {
+                    const uint32_t width = layout.MipWidth(level);
+                    const uint32_t height = layout.MipHeight(level);
+                    for (uint32_t y = 0; y < height && match; y++)
+                    {
+                        const uint32_t y0 = y << level;
+                        const uint32_t y1 = y + 1 == height ? layout.height : (y + 1) << level;
+                        for (uint32_t x = 0; x < width && match; x++)
+                        {
+                            const uint32_t x0 = x << level;
+                            const uint32_t x1 = x + 1 == width ? layout.width : (x + 1) << level;
+                            uint64_t expected = surface.Load(base.x + x0, base.y + y0);
+                            for (uint32_t sy = y0; sy < y1; sy++)
+                            {
+                                for (uint32_t sx = x0; sx < x1; sx++)
+                                {
+                                    expected = HostAtomicCombine(op, expected, surface.Load(base.x + sx, base.y + sy));
+                                }
+                            }
+                            const HostTexelCoord texel = layout.Address(slice, level, x, y);
+                            match = surface.Load(texel.x, texel.y) == expected;
+                        }
+                    }
+                }
+            }
+
+            char name[32];
+            snprintf(name, sizeof(name), "%u x %u x %u, %u", layout.width, layout.height, layout.arraySize, layout.mipLevels);
+            printf("%-22s %12.2f %8s\n", name, seconds * 1e3, Check(match) ? "yes" : "NO");
+        }
+    }
+
+    struct HostBenchmark
+    {
+        const char* name;
+        void (*run)();
+    };
+
+    const HostBenchmark s_benchmarks[] =
+    {
+        { "emulated-atomics", BenchmarkEmulatedAtomics },
+        { "paired-atomics-128", BenchmarkPairedAtomics128 },
+        { "monotone-filter", BenchmarkMonotoneFilter },
+        { "sort-then-apply", BenchmarkSortThenApply },
+        { "huge-page-arena", BenchmarkHugePageArena },
+        { "sparse-surface", BenchmarkSparseSurface },
+        { "volume-mappings", BenchmarkVolumeMappings },
+        { "heap-suballocator", BenchmarkHeapSuballocator },
+        { "vidmem-budget", BenchmarkVidmemBudget },
+        { "descriptor-allocator", BenchmarkDescriptorAllocator },
+        { "surface-pool", BenchmarkSurfacePool },
+        { "split-planes", BenchmarkSplitPlanes },
+        { "readback-destride", BenchmarkReadbackDestride },
+        { "dirty-tiles", BenchmarkDirtyTiles },
+        { "surface-stats", BenchmarkSurfaceStats },
+        { "surface-dump", BenchmarkSurfaceDump },
+        { "surface-compression", BenchmarkSurfaceCompression },
+        { "visualize", BenchmarkVisualize },
+        { "surface-diff", BenchmarkSurfaceDiff },
+        { "command-recording", BenchmarkCommandRecording },
+        { "frame-limiter", BenchmarkFrameLimiter },
+        { "parallel-recording", BenchmarkParallelRecording },
+        { "frame-timeline", BenchmarkFrameTimeline },
+        { "atlas", BenchmarkAtlas },
+    };
+}
+
+int RunHostBenchmarks(const char* filter)
+{
+    bool ran = false;
+    s_failedChecks = 0;
+    for (const HostBenchmark& benchmark : s_benchmarks)
+    {
+        if (filter != nullptr && filter[0] != '\0' && strstr(benchmark.name, filter) == nullptr)
+        {
+            continue;
+        }
+        printf("== %s ==\n", benchmark.name);
+        const uint32_t failedBefore = s_failedChecks;
+        benchmark.run();
+        if (s_failedChecks != failedBefore)
+        {
+            printf("%u checks FAILED\n", s_failedChecks - failedBefore);
+        }
+        printf("\n");
+        ran = true;
+    }
+    return ran ? static_cast<int>(s_failedChecks) : -1;
+}
+
+#ifdef HOST_BENCHMARK_MAIN
+int main(int argc, char* argv[])
+{
+    return RunHostBenchmarks(argc > 1 ? argv[1] : nullptr) == 0 ? 0 : 1;
+}
+#endif
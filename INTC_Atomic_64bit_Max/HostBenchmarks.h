@@ -0,0 +1,11 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#pragma once
+
+// Runs every host benchmark whose name contains filter, or all of them when
+// filter is null or empty. Results are printed to stdout. Returns the number
+// of correctness checks that failed, or -1 when no benchmark matched filter.
+int RunHostBenchmarks(const char* filter);
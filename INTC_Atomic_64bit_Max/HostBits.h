@@ -0,0 +1,40 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Small bit and alignment helpers shared by the host passes.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Rounds value up to a multiple of alignment, which must be a power of two.
+inline size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Index of the highest set bit of a non-zero value (firstbithigh).
+inline uint32_t HighestBit(uint64_t value)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long bit;
+    _BitScanReverse64(&bit, value);
+    return bit;
+#elif defined(__GNUC__)
+    return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#else
+    uint32_t bit = 0;
+    while (value >>= 1)
+    {
+        bit++;
+    }
+    return bit;
+#endif
+}
@@ -0,0 +1,119 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostCommandRecorder.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+HostCommandRecorder::HostCommandRecorder(HostCommandListType type) :
+    m_type(type)
+{
+}
+
+void HostCommandRecorder::Reset()
+{
+    m_words.clear();
+    m_bundles.clear();
+    m_patchSlots.clear();
+    m_commandCount = 0;
+}
+
+uint32_t* HostCommandRecorder::Append(HostCommandType type, uint32_t argCount)
+{
+    const size_t begin = m_words.size();
+    m_words.resize(begin + 2 + argCount);
+    m_words[begin] = static_cast<uint32_t>(type);
+    m_words[begin + 1] = argCount;
+    m_commandCount++;
+    return &m_words[begin + 2];
+}
+
+void HostCommandRecorder::RequireDirect(const char* command) const
+{
+    if (m_type != HostCommandListType::Direct)
+    {
+        throw std::invalid_argument(std::string("HostCommandRecorder: ") + command + " is not allowed in a bundle");
+    }
+}
+
+void HostCommandRecorder::SetPipelineState(uint32_t pipeline)
+{
+    Append(HostCommandType::SetPipelineState, 1)[0] = pipeline;
+}
+
+void HostCommandRecorder::SetRootSignature(uint32_t rootSignature)
+{
+    Append(HostCommandType::SetRootSignature, 1)[0] = rootSignature;
+}
+
+void HostCommandRecorder::SetDescriptorTable(uint32_t parameter, uint32_t descriptor)
+{
+    uint32_t* args = Append(HostCommandType::SetDescriptorTable, 2);
+    args[0] = parameter;
+    args[1] = descriptor;
+}
+
+void HostCommandRecorder::SetRootConstants(uint32_t parameter, uint32_t count, const void* values)
+{
+    uint32_t* args = Append(HostCommandType::SetRootConstants, 1 + count);
+    args[0] = parameter;
+    memcpy(args + 1, values, count * sizeof(uint32_t));
+}
+
+void HostCommandRecorder::Dispatch(uint32_t x, uint32_t y, uint32_t z)
+{
+    uint32_t* args = Append(HostCommandType::Dispatch, 3);
+    args[0] = x;
+    args[1] = y;
+    args[2] = z;
+}
+
+void HostCommandRecorder::Draw(uint32_t vertexCount, uint32_t instanceCount)
+{
+    uint32_t* args = Append(HostCommandType::Draw, 2);
+    args[0] = vertexCount;
+    args[1] = instanceCount;
+}
+
+void HostCommandRecorder::Barrier(uint32_t resource, uint32_t before, uint32_t after)
+{
+    RequireDirect("Barrier");
+    uint32_t* args = Append(HostCommandType::Barrier, 3);
+    args[0] = resource;
+    args[1] = before;
+    args[2] = after;
+}
+
+void HostCommandRecorder::CopyRegion(const HostCopyRegion& region)
+{
+    RequireDirect("CopyRegion");
+    memcpy(Append(HostCommandType::CopyRegion, sizeof(region) / sizeof(uint32_t)), &region, sizeof(region));
+}
+
+void HostCommandRecorder::ExecuteBundle(const HostCommandRecorder& bundle)
+{
+    RequireDirect("ExecuteBundle");
+    if (bundle.m_type != HostCommandListType::Bundle)
+    {
+        throw std::invalid_argument("HostCommandRecorder: ExecuteBundle of a direct list");
+    }
+    Append(HostCommandType::ExecuteBundle, 1)[0] = static_cast<uint32_t>(m_bundles.size());
+    m_bundles.push_back(&bundle);
+}
+
+uint32_t HostCommandRecorder::SetPatchableRootConstants(uint32_t parameter, uint32_t count, const void* values)
+{
+    m_patchSlots.push_back(m_words.size());
+    SetRootConstants(parameter, count, values);
+    return static_cast<uint32_t>(m_patchSlots.size() - 1);
+}
+
+void HostCommandRecorder::Patch(uint32_t slot, const void* values)
+{
+    const size_t command = m_patchSlots.at(slot);
+    memcpy(&m_words[command + 3], values, (m_words[command + 1] - 1) * sizeof(uint32_t));
+}
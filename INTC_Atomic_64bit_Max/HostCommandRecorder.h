@@ -0,0 +1,125 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// A command list without a GPU: commands are encoded into a flat word stream
+// the way a driver encodes them, so the cost of recording a frame can be
+// measured, and the recorded sequence checked, on any host. The command set
+// is the subset the sample records, with D3D12's rules for bundles: a
+// bundle holds no barriers, copies or nested bundles, and inherits the root
+// arguments set before ExecuteBundle.
+//
+// A stream recorded once is replayed every frame. Parameters that change
+// per frame go in patch slots (SetPatchableRootConstants), whose values
+// Patch overwrites in place without re-recording. Reset keeps the storage,
+// so steady-state recording does not allocate.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class HostCommandListType : uint32_t
+{
+    Direct,
+    Bundle,
+};
+
+enum class HostCommandType : uint32_t
+{
+    SetPipelineState,       // pipeline
+    SetRootSignature,       // rootSignature
+    SetDescriptorTable,     // parameter, descriptor
+    SetRootConstants,       // parameter, values...
+    Barrier,                // resource, before, after
+    CopyRegion,             // HostCopyRegion
+    Dispatch,               // x, y, z
+    Draw,                   // vertexCount, instanceCount
+    ExecuteBundle,          // bundle index
+};
+
+// A texture region copied to a buffer footprint.
+struct HostCopyRegion
+{
+    uint32_t source;
+    uint32_t destination;
+    uint64_t offset;
+    uint32_t rowPitch;
+    uint32_t left;
+    uint32_t top;
+    uint32_t right;
+    uint32_t bottom;
+    uint32_t reserved;
+};
+
+struct HostCommand
+{
+    HostCommandType type;
+    uint32_t argCount;
+    const uint32_t* args;
+};
+
+class HostCommandRecorder
+{
+public:
+    explicit HostCommandRecorder(HostCommandListType type = HostCommandListType::Direct);
+
+    HostCommandListType GetType() const { return m_type; }
+
+    // Discards the commands and patch slots, keeping their storage.
+    void Reset();
+
+    void SetPipelineState(uint32_t pipeline);
+    void SetRootSignature(uint32_t rootSignature);
+    void SetDescriptorTable(uint32_t parameter, uint32_t descriptor);
+    void SetRootConstants(uint32_t parameter, uint32_t count, const void* values);
+    void Dispatch(uint32_t x, uint32_t y, uint32_t z);
+    void Draw(uint32_t vertexCount, uint32_t instanceCount);
+
+    // Direct lists only; throw std::invalid_argument on a bundle.
+    void Barrier(uint32_t resource, uint32_t before, uint32_t after);
+    void CopyRegion(const HostCopyRegion& region);
+
+    // The bundle must outlive this list's replays. Throws
+    // std::invalid_argument on a bundle, or for a list that is not one.
+    void ExecuteBundle(const HostCommandRecorder& bundle);
+
+    // Records root constants and returns the slot that Patch overwrites.
+    uint32_t SetPatchableRootConstants(uint32_t parameter, uint32_t count, const void* values);
+    void Patch(uint32_t slot, const void* values);
+
+    size_t GetCommandCount() const  { return m_commandCount; }
+    size_t GetByteCount() const     { return m_words.size() * sizeof(uint32_t); }
+
+    // Calls visitor(const HostCommand&) for each command in order, expanding
+    // bundles in place as the GPU would execute them.
+    template <typename Visitor>
+    void Replay(Visitor&& visitor) const
+    {
+        for (size_t i = 0; i < m_words.size(); i += 2 + m_words[i + 1])
+        {
+            const HostCommand command = { static_cast<HostCommandType>(m_words[i]), m_words[i + 1], &m_words[i + 2] };
+            if (command.type == HostCommandType::ExecuteBundle)
+            {
+                m_bundles[command.args[0]]->Replay(visitor);
+            }
+            else
+            {
+                visitor(command);
+            }
+        }
+    }
+
+private:
+    // Appends a command and returns its argCount argument words.
+    uint32_t* Append(HostCommandType type, uint32_t argCount);
+    void RequireDirect(const char* command) const;
+
+    HostCommandListType m_type;
+    std::vector<uint32_t> m_words;      // type, argCount, args..., per command.
+    std::vector<const HostCommandRecorder*> m_bundles;
+    std::vector<size_t> m_patchSlots;   // Word index of each slot's SetRootConstants.
+    size_t m_commandCount = 0;
+};
@@ -0,0 +1,214 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostDescriptorAllocator.h"
+
+#include <stdexcept>
+
+namespace
+{
+    inline uint64_t PackHead(uint64_t tag, uint32_t block)
+    {
+        return (tag << 32) | block;
+    }
+}
+
+const uint32_t HostDescriptorTable::InvalidIndex;
+const uint32_t HostDescriptorAllocator::DefaultBlockSize;
+
+HostDescriptorAllocator::HostDescriptorAllocator(uint32_t persistentBlocks, uint32_t ringPerFrame, uint32_t frameCount,
+    uint32_t blockSize, GrowCallback grow) :
+    m_blockSize(blockSize),
+    m_frameCount(frameCount),
+    m_persistentBlocks(persistentBlocks),
+    m_ringPerFrame(ringPerFrame),
+    m_grow(grow),
+    m_freeHead(PackHead(0, EmptyStack)),
+    m_blocksInUse(0),
+    m_frame(0),
+    m_ringCursor(0),
+    m_persistentExhausted(false),
+    m_ringExhausted(false),
+    m_growCount(0)
+{
+    if (blockSize < 2 || frameCount == 0 || persistentBlocks == 0 || ringPerFrame == 0)
+    {
+        throw std::invalid_argument("HostDescriptorAllocator: empty layout");
+    }
+    if (static_cast<uint64_t>(persistentBlocks) * blockSize + static_cast<uint64_t>(frameCount) * ringPerFrame > HostMaxShaderVisibleDescriptors)
+    {
+        throw std::invalid_argument("HostDescriptorAllocator: layout exceeds the shader-visible heap limit");
+    }
+
+    m_next.reset(new std::atomic<uint32_t>[persistentBlocks]);
+    m_retiredHeads.reset(new std::atomic<uint64_t>[frameCount]);
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        m_retiredHeads[frame].store(PackHead(0, EmptyStack), std::memory_order_relaxed);
+    }
+
+    // Push in reverse so the lowest blocks are handed out first.
+    for (uint32_t block = persistentBlocks; block-- > 0;)
+    {
+        Push(m_freeHead, block);
+    }
+
+    if (m_grow)
+    {
+        m_grow(GetCapacity(), 0);
+    }
+}
+
+uint32_t HostDescriptorAllocator::Pop(std::atomic<uint64_t>& head)
+{
+    uint64_t current = head.load(std::memory_order_acquire);
+    for (;;)
+    {
+        const uint32_t block = static_cast<uint32_t>(current);
+        if (block == EmptyStack)
+        {
+            return EmptyStack;
+        }
+        // m_next[block] may be stale if another thread popped block first; the
+        // tag then makes the exchange fail.
+        const uint32_t next = m_next[block].load(std::memory_order_relaxed);
+        if (head.compare_exchange_weak(current, PackHead((current >> 32) + 1, next), std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return block;
+        }
+    }
+}
+
+void HostDescriptorAllocator::Push(std::atomic<uint64_t>& head, uint32_t block)
+{
+    uint64_t current = head.load(std::memory_order_relaxed);
+    do
+    {
+        m_next[block].store(static_cast<uint32_t>(current), std::memory_order_relaxed);
+    } while (!head.compare_exchange_weak(current, PackHead((current >> 32) + 1, block), std::memory_order_release, std::memory_order_relaxed));
+}
+
+HostDescriptorTable HostDescriptorAllocator::AllocatePersistent(uint32_t resourceCount)
+{
+    if (resourceCount + 1 > m_blockSize)
+    {
+        throw std::invalid_argument("HostDescriptorAllocator: table does not fit a persistent block");
+    }
+
+    const uint32_t block = Pop(m_freeHead);
+    if (block == EmptyStack)
+    {
+        m_persistentExhausted.store(true, std::memory_order_relaxed);
+        return HostDescriptorTable{ HostDescriptorTable::InvalidIndex, resourceCount };
+    }
+    m_blocksInUse.fetch_add(1, std::memory_order_relaxed);
+    return HostDescriptorTable{ block * m_blockSize, resourceCount };
+}
+
+void HostDescriptorAllocator::FreePersistent(const HostDescriptorTable& table)
+{
+    if (!table.IsValid())
+    {
+        return;
+    }
+    Push(m_retiredHeads[m_frame], table.base / m_blockSize);
+    m_blocksInUse.fetch_sub(1, std::memory_order_relaxed);
+}
+
+HostDescriptorTable HostDescriptorAllocator::AllocateTransient(uint32_t resourceCount)
+{
+    const uint32_t count = resourceCount + 1;
+    const uint32_t offset = m_ringCursor.fetch_add(count, std::memory_order_relaxed);
+    if (offset + count > m_ringPerFrame || offset + count < offset)
+    {
+        m_ringExhausted.store(true, std::memory_order_relaxed);
+        return HostDescriptorTable{ HostDescriptorTable::InvalidIndex, resourceCount };
+    }
+    return HostDescriptorTable{ m_persistentBlocks * m_blockSize + m_frame * m_ringPerFrame + offset, resourceCount };
+}
+
+void HostDescriptorAllocator::Grow()
+{
+    const bool growPersistent = m_persistentExhausted.exchange(false, std::memory_order_relaxed);
+    const bool growRing = m_ringExhausted.exchange(false, std::memory_order_relaxed);
+    if (!growPersistent && !growRing)
+    {
+        return;
+    }
+
+    // Double what ran out, or as much of it as still fits the heap limit.
+    auto fits = [this](uint32_t blocks, uint32_t ring)
+    {
+        return static_cast<uint64_t>(blocks) * m_blockSize + static_cast<uint64_t>(m_frameCount) * ring <= HostMaxShaderVisibleDescriptors;
+    };
+    uint32_t persistentBlocks = growPersistent ? m_persistentBlocks * 2 : m_persistentBlocks;
+    uint32_t ringPerFrame = growRing ? m_ringPerFrame * 2 : m_ringPerFrame;
+    if (!fits(persistentBlocks, ringPerFrame))
+    {
+        if (growPersistent && fits(persistentBlocks, m_ringPerFrame))
+        {
+            ringPerFrame = m_ringPerFrame;
+        }
+        else if (growRing && fits(m_persistentBlocks, ringPerFrame))
+        {
+            persistentBlocks = m_persistentBlocks;
+        }
+        else
+        {
+            return;
+        }
+    }
+
+    std::unique_ptr<std::atomic<uint32_t>[]> next(new std::atomic<uint32_t>[persistentBlocks]);
+    for (uint32_t block = 0; block < m_persistentBlocks; block++)
+    {
+        next[block].store(m_next[block].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    m_next.swap(next);
+
+    const uint32_t oldBlocks = m_persistentBlocks;
+    m_persistentBlocks = persistentBlocks;
+    m_ringPerFrame = ringPerFrame;
+    for (uint32_t block = persistentBlocks; block-- > oldBlocks;)
+    {
+        Push(m_freeHead, block);
+    }
+
+    m_growCount++;
+    if (m_grow)
+    {
+        m_grow(GetCapacity(), oldBlocks * m_blockSize);
+    }
+}
+
+void HostDescriptorAllocator::BeginFrame()
+{
+    m_frame = (m_frame + 1) % m_frameCount;
+
+    // Blocks freed the last time this slot was current are no longer in use.
+    const uint64_t retired = m_retiredHeads[m_frame].exchange(PackHead(0, EmptyStack), std::memory_order_acquire);
+    for (uint32_t block = static_cast<uint32_t>(retired); block != EmptyStack;)
+    {
+        const uint32_t next = m_next[block].load(std::memory_order_relaxed);
+        Push(m_freeHead, block);
+        block = next;
+    }
+
+    Grow();
+    m_ringCursor.store(0, std::memory_order_relaxed);
+}
+
+HostDescriptorStats HostDescriptorAllocator::GetStats() const
+{
+    HostDescriptorStats stats;
+    stats.capacity = GetCapacity();
+    stats.persistentBlocks = m_persistentBlocks;
+    stats.persistentBlocksInUse = m_blocksInUse.load(std::memory_order_relaxed);
+    stats.ringPerFrame = m_ringPerFrame;
+    const uint32_t cursor = m_ringCursor.load(std::memory_order_relaxed);
+    stats.ringUsed = cursor < m_ringPerFrame ? cursor : m_ringPerFrame;
+    stats.growCount = m_growCount;
+    return stats;
+}
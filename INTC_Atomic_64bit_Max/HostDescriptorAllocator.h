@@ -0,0 +1,117 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Index management for one large shader-visible CBV/SRV/UAV heap, so the
+// application binds a single heap per frame instead of one heap per view.
+// The heap is laid out as
+//
+//   [ persistent blocks | frame 0 ring | frame 1 ring | ... ]
+//
+// Persistent tables take one fixed-size block each from a lock-free free list.
+// Transient tables are bump-allocated from the current frame's ring and
+// recycled wholesale when that frame slot comes round again. Every table
+// reserves the descriptor after its resources for the Intel extension UAV
+// (INTEL_SHADER_EXT_UAV_SLOT, u7), which root signatures append as their last
+// range. This file has no D3D12 dependency; ShaderVisibleDescriptorHeap binds
+// it to a device through the grow callback.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+// D3D12 limit for shader-visible CBV/SRV/UAV heaps on resource binding tier 1.
+static const uint32_t HostMaxShaderVisibleDescriptors = 1000000;
+
+struct HostDescriptorTable
+{
+    static const uint32_t InvalidIndex = ~0u;
+
+    uint32_t base;              // Heap index of the first resource descriptor.
+    uint32_t resourceCount;
+
+    bool IsValid() const                { return base != InvalidIndex; }
+    uint32_t ExtensionSlot() const      { return base + resourceCount; }
+    uint32_t DescriptorCount() const    { return resourceCount + 1; }
+};
+
+struct HostDescriptorStats
+{
+    uint32_t capacity;
+    uint32_t persistentBlocks;
+    uint32_t persistentBlocksInUse;
+    uint32_t ringPerFrame;
+    uint32_t ringUsed;          // In the current frame.
+    uint32_t growCount;
+};
+
+class HostDescriptorAllocator
+{
+public:
+    static const uint32_t DefaultBlockSize = 8;
+
+    // Called with the initial capacity from the constructor and with the new
+    // one from BeginFrame when the heap grows. Persistent indices survive
+    // growth: the callee creates the new heap and copies the first
+    // persistentDescriptors descriptors over from the old one.
+    typedef std::function<void(uint32_t capacity, uint32_t persistentDescriptors)> GrowCallback;
+
+    // Throws std::invalid_argument when the layout is empty or exceeds
+    // HostMaxShaderVisibleDescriptors.
+    HostDescriptorAllocator(uint32_t persistentBlocks, uint32_t ringPerFrame, uint32_t frameCount,
+        uint32_t blockSize = DefaultBlockSize, GrowCallback grow = GrowCallback());
+
+    // Lock free. resourceCount + 1 must fit a block. Returns an invalid table
+    // when no block is free; the persistent region then doubles at the next
+    // BeginFrame.
+    HostDescriptorTable AllocatePersistent(uint32_t resourceCount);
+
+    // Lock free. The block is reused only after frameCount BeginFrame calls,
+    // once the GPU can no longer reference it.
+    void FreePersistent(const HostDescriptorTable& table);
+
+    // Lock free. Valid until the current frame slot is reused. Returns an
+    // invalid table when the ring is full; the ring then doubles at the next
+    // BeginFrame.
+    HostDescriptorTable AllocateTransient(uint32_t resourceCount);
+
+    // Advances to the next frame slot, whose previous frame the caller
+    // guarantees the GPU has finished: recycles its ring and retired
+    // persistent blocks, and grows the heap if an allocation failed. Must
+    // not run concurrently with any other call.
+    void BeginFrame();
+
+    uint32_t GetCapacity() const        { return m_persistentBlocks * m_blockSize + m_frameCount * m_ringPerFrame; }
+    uint32_t GetBlockSize() const       { return m_blockSize; }
+    HostDescriptorStats GetStats() const;
+
+private:
+    static const uint32_t EmptyStack = ~0u;
+
+    uint32_t Pop(std::atomic<uint64_t>& head);
+    void Push(std::atomic<uint64_t>& head, uint32_t block);
+    void Grow();
+
+    uint32_t m_blockSize;
+    uint32_t m_frameCount;
+    uint32_t m_persistentBlocks;
+    uint32_t m_ringPerFrame;
+    GrowCallback m_grow;
+
+    // Treiber stacks of block indices threaded through m_next. The head packs
+    // a 32-bit ABA tag above the top block index.
+    std::unique_ptr<std::atomic<uint32_t>[]> m_next;
+    std::atomic<uint64_t> m_freeHead;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_retiredHeads;    // Per frame slot.
+    std::atomic<uint32_t> m_blocksInUse;
+
+    uint32_t m_frame;                       // Current frame slot.
+    std::atomic<uint32_t> m_ringCursor;     // Descriptors used in the current slot.
+    std::atomic<bool> m_persistentExhausted;
+    std::atomic<bool> m_ringExhausted;
+    uint32_t m_growCount;
+};
@@ -0,0 +1,219 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostDirtyTiles.h"
+#include "HostParallel.h"
+#include "HostReadbackCopy.h"
+
+#include <stdexcept>
+
+const uint32_t HostDirtyTileMask::DefaultTileSize;
+const uint32_t HostTileStagingRing::InvalidSlot;
+
+//
+// HostDirtyTileMask
+//
+
+HostDirtyTileMask::HostDirtyTileMask(uint32_t width, uint32_t height, uint32_t tileSize) :
+    m_width(width),
+    m_height(height),
+    m_tileSize(tileSize)
+{
+    if (width == 0 || height == 0)
+    {
+        throw std::invalid_argument("HostDirtyTileMask: empty surface");
+    }
+    if (tileSize == 0)
+    {
+        throw std::invalid_argument("HostDirtyTileMask: zero tile size");
+    }
+    m_tilesX = (width + tileSize - 1) / tileSize;
+    m_tilesY = (height + tileSize - 1) / tileSize;
+    m_maskWidth = (m_tilesX + 63) / 64;
+    m_words.reset(new std::atomic<uint64_t>[static_cast<size_t>(m_maskWidth) * m_tilesY]());
+    MarkAll();
+}
+
+void HostDirtyTileMask::MarkRect(uint32_t left, uint32_t top, uint32_t right, uint32_t bottom)
+{
+    right = right < m_width ? right : m_width;
+    bottom = bottom < m_height ? bottom : m_height;
+    if (left >= right || top >= bottom)
+    {
+        return;
+    }
+
+    const uint32_t lastX = (right - 1) / m_tileSize;
+    const uint32_t lastY = (bottom - 1) / m_tileSize;
+    for (uint32_t tileY = top / m_tileSize; tileY <= lastY; tileY++)
+    {
+        for (uint32_t tileX = left / m_tileSize; tileX <= lastX; tileX++)
+        {
+            MarkTile(tileX, tileY);
+        }
+    }
+}
+
+void HostDirtyTileMask::MarkAll()
+{
+    for (uint32_t tileY = 0; tileY < m_tilesY; tileY++)
+    {
+        for (uint32_t word = 0; word < m_maskWidth; word++)
+        {
+            // The last word of a row only has bits for existing tiles.
+            const uint32_t bits = word + 1 < m_maskWidth ? 64 : m_tilesX - word * 64;
+            const uint64_t value = bits == 64 ? ~0ull : (1ull << bits) - 1;
+            m_words[static_cast<size_t>(tileY) * m_maskWidth + word].fetch_or(value, std::memory_order_relaxed);
+        }
+    }
+}
+
+void HostDirtyTileMask::Clear()
+{
+    const size_t count = static_cast<size_t>(m_maskWidth) * m_tilesY;
+    for (size_t i = 0; i < count; i++)
+    {
+        m_words[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void HostDirtyTileMask::MergeWords(const uint64_t* words, size_t wordPitch)
+{
+    for (uint32_t tileY = 0; tileY < m_tilesY; tileY++)
+    {
+        for (uint32_t word = 0; word < m_maskWidth; word++)
+        {
+            const uint64_t value = words[tileY * wordPitch + word];
+            if (value != 0)
+            {
+                m_words[static_cast<size_t>(tileY) * m_maskWidth + word].fetch_or(value, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+uint32_t HostDirtyTileMask::Collect(std::vector<uint32_t>& tiles, uint32_t maxTiles)
+{
+    uint32_t count = 0;
+    for (uint32_t tileY = 0; tileY < m_tilesY && count < maxTiles; tileY++)
+    {
+        for (uint32_t word = 0; word < m_maskWidth && count < maxTiles; word++)
+        {
+            std::atomic<uint64_t>& entry = m_words[static_cast<size_t>(tileY) * m_maskWidth + word];
+            uint64_t bits = entry.load(std::memory_order_relaxed);
+            uint64_t taken = 0;
+            while (bits != 0 && count < maxTiles)
+            {
+                uint32_t bit = 0;
+                while (((bits >> bit) & 1) == 0)
+                {
+                    bit++;
+                }
+                bits &= bits - 1;
+                taken |= 1ull << bit;
+                tiles.push_back(tileY * m_tilesX + word * 64 + bit);
+                count++;
+            }
+            if (taken != 0)
+            {
+                entry.fetch_and(~taken, std::memory_order_relaxed);
+            }
+        }
+    }
+    return count;
+}
+
+uint32_t HostDirtyTileMask::CountDirty() const
+{
+    uint32_t count = 0;
+    const size_t wordCount = static_cast<size_t>(m_maskWidth) * m_tilesY;
+    for (size_t i = 0; i < wordCount; i++)
+    {
+        for (uint64_t bits = m_words[i].load(std::memory_order_relaxed); bits != 0; bits &= bits - 1)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+void HostDirtyTileMask::GetTileRect(uint32_t tile, uint32_t& left, uint32_t& top, uint32_t& width, uint32_t& height) const
+{
+    left = (tile % m_tilesX) * m_tileSize;
+    top = (tile / m_tilesX) * m_tileSize;
+    width = m_width - left < m_tileSize ? m_width - left : m_tileSize;
+    height = m_height - top < m_tileSize ? m_height - top : m_tileSize;
+}
+
+//
+// HostTileStagingRing
+//
+
+HostTileStagingRing::HostTileStagingRing(uint32_t slotCount) :
+    m_slotCount(slotCount),
+    m_head(0),
+    m_tail(0)
+{
+    if (slotCount == 0)
+    {
+        throw std::invalid_argument("HostTileStagingRing: zero slots");
+    }
+}
+
+uint32_t HostTileStagingRing::Allocate(uint64_t fence)
+{
+    if (m_head - m_tail == m_slotCount)
+    {
+        return InvalidSlot;
+    }
+
+    const uint32_t slot = static_cast<uint32_t>(m_head % m_slotCount);
+    m_head++;
+    if (m_frames.empty() || m_frames.back().fence != fence)
+    {
+        m_frames.push_back(Frame{ fence, m_head });
+    }
+    else
+    {
+        m_frames.back().head = m_head;
+    }
+    return slot;
+}
+
+void HostTileStagingRing::Retire(uint64_t completedFence)
+{
+    while (!m_frames.empty() && m_frames.front().fence <= completedFence)
+    {
+        m_tail = m_frames.front().head;
+        m_frames.pop_front();
+    }
+}
+
+//
+// HostPatchTiles
+//
+
+void HostPatchTiles(const HostDirtyTileMask& mask, uint64_t* mirror, size_t mirrorPitch, const void* staging,
+    size_t slotRowPitch, const HostTileCopy* copies, size_t copyCount, uint32_t workerCount)
+{
+    const size_t slotBytes = slotRowPitch * mask.GetTileSize();
+    const uint8_t* stagingBytes = static_cast<const uint8_t*>(staging);
+    uint8_t* mirrorBytes = reinterpret_cast<uint8_t*>(mirror);
+
+    HostParallelRanges(copyCount, workerCount == 0 ? HostWorkerCount() : workerCount, [&](uint32_t, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            uint32_t left;
+            uint32_t top;
+            uint32_t width;
+            uint32_t height;
+            mask.GetTileRect(copies[i].tile, left, top, width, height);
+            HostCopyPitchedRows(mirrorBytes + top * mirrorPitch + left * sizeof(uint64_t), mirrorPitch,
+                stagingBytes + copies[i].slot * slotBytes, slotRowPitch, width * sizeof(uint64_t), height, 1,
+                HostCopyMode::Cached);
+        }
+    });
+}
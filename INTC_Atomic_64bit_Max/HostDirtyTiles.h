@@ -0,0 +1,129 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Dirty-tile tracking for incremental readback. Writers set one bit per
+// tileSize x tileSize tile in a mask of 64-bit words, 64 tiles of a tile row
+// per word: the GPU with a 64-bit atomic OR on a mask texel (DirtyTiles.hlsl),
+// the host with MarkTexel / MarkRect. Collect takes the dirty tiles, each is
+// copied into a slot of a HostTileStagingRing, and HostPatchTiles writes the
+// staged tiles into a host mirror, so transfer bytes scale with the changed
+// area instead of the surface size.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+class HostDirtyTileMask
+{
+public:
+    static const uint32_t DefaultTileSize = 32;
+
+    // Starts with every tile dirty, so the first readback fills the mirror.
+    HostDirtyTileMask(uint32_t width, uint32_t height, uint32_t tileSize = DefaultTileSize);
+
+    uint32_t GetWidth() const       { return m_width; }
+    uint32_t GetHeight() const      { return m_height; }
+    uint32_t GetTileSize() const    { return m_tileSize; }
+    uint32_t GetTilesX() const      { return m_tilesX; }
+    uint32_t GetTilesY() const      { return m_tilesY; }
+    uint32_t GetTileCount() const   { return m_tilesX * m_tilesY; }
+
+    // Mask words per tile row, i.e. the width of the GPU mask texture.
+    uint32_t GetMaskWidth() const   { return m_maskWidth; }
+
+    // Safe to call from any number of threads. Already-set bits are not
+    // written again.
+    void MarkTexel(uint32_t x, uint32_t y)
+    {
+        MarkTile(x / m_tileSize, y / m_tileSize);
+    }
+
+    // Marks every tile overlapping [left, right) x [top, bottom).
+    void MarkRect(uint32_t left, uint32_t top, uint32_t right, uint32_t bottom);
+    void MarkAll();
+    void Clear();
+
+    // ORs in a mask read back from the GPU, wordPitch words per tile row.
+    void MergeWords(const uint64_t* words, size_t wordPitch);
+
+    // Moves up to maxTiles dirty tiles, in row-major order, to tiles and
+    // clears their bits. Tiles marked meanwhile stay dirty. Returns the count.
+    uint32_t Collect(std::vector<uint32_t>& tiles, uint32_t maxTiles);
+
+    uint32_t CountDirty() const;
+
+    // Texel rectangle of a tile; tiles on the right and bottom edges may be
+    // smaller than tileSize.
+    void GetTileRect(uint32_t tile, uint32_t& left, uint32_t& top, uint32_t& width, uint32_t& height) const;
+
+private:
+    void MarkTile(uint32_t tileX, uint32_t tileY)
+    {
+        std::atomic<uint64_t>& word = m_words[static_cast<size_t>(tileY) * m_maskWidth + tileX / 64];
+        const uint64_t bit = 1ull << (tileX % 64);
+        if ((word.load(std::memory_order_relaxed) & bit) == 0)
+        {
+            word.fetch_or(bit, std::memory_order_relaxed);
+        }
+    }
+
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_tileSize;
+    uint32_t m_tilesX;
+    uint32_t m_tilesY;
+    uint32_t m_maskWidth;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_words;
+};
+
+// Fixed number of tile-sized staging slots handed out in ring order. Slots
+// allocated with a fence value are reused once that fence has completed.
+class HostTileStagingRing
+{
+public:
+    static const uint32_t InvalidSlot = ~0u;
+
+    explicit HostTileStagingRing(uint32_t slotCount);
+
+    uint32_t GetSlotCount() const { return m_slotCount; }
+    uint32_t GetFreeCount() const { return m_slotCount - static_cast<uint32_t>(m_head - m_tail); }
+
+    // fence is the value signaled after the frame that fills the slot, and
+    // must not decrease between calls. Returns InvalidSlot when the ring is
+    // full.
+    uint32_t Allocate(uint64_t fence);
+
+    void Retire(uint64_t completedFence);
+
+private:
+    struct Frame
+    {
+        uint64_t fence;
+        uint64_t head;      // m_head after the frame's last allocation.
+    };
+
+    uint32_t m_slotCount;
+    uint64_t m_head;
+    uint64_t m_tail;
+    std::deque<Frame> m_frames;
+};
+
+// A tile staged in a ring slot.
+struct HostTileCopy
+{
+    uint32_t tile;
+    uint32_t slot;
+};
+
+// Copies staged tiles into mirror (mirrorPitch bytes per row). Slot s starts
+// at staging + s * slotRowPitch * tileSize, with its rows slotRowPitch bytes
+// apart. A workerCount of zero uses HostWorkerCount() threads.
+void HostPatchTiles(const HostDirtyTileMask& mask, uint64_t* mirror, size_t mirrorPitch, const void* staging,
+    size_t slotRowPitch, const HostTileCopy* copies, size_t copyCount, uint32_t workerCount = 0);
@@ -0,0 +1,204 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostFrameLoop.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+// Windows 10 1803 and later; older systems fail the call and get a standard timer.
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+namespace
+{
+    // Starting guess for oversleep: a standard 1 ms timer tick.
+    const int64_t InitialOversleep = 1000000;
+
+    // Spin at least this long, for wake-up jitter the mean does not show.
+    const int64_t MinSpinWindow = 20000;
+
+    class SystemClock : public HostFrameClock
+    {
+    public:
+        SystemClock()
+        {
+#ifdef _WIN32
+            m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+            if (m_timer == nullptr)
+            {
+                m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+            }
+#endif
+        }
+
+        ~SystemClock()
+        {
+#ifdef _WIN32
+            if (m_timer != nullptr)
+            {
+                CloseHandle(m_timer);
+            }
+#endif
+        }
+
+        int64_t Now() override
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        void SleepUntil(int64_t deadline) override
+        {
+            const int64_t remaining = deadline - Now();
+            if (remaining <= 0)
+            {
+                return;
+            }
+#ifdef _WIN32
+            // Relative due times are negative, in 100 ns units.
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -(remaining / 100);
+            if (m_timer != nullptr && SetWaitableTimer(m_timer, &dueTime, 0, nullptr, nullptr, FALSE))
+            {
+                WaitForSingleObject(m_timer, INFINITE);
+                return;
+            }
+            Sleep(static_cast<DWORD>(remaining / 1000000));
+#else
+            std::this_thread::sleep_for(std::chrono::nanoseconds(remaining));
+#endif
+        }
+
+        void Spin() override
+        {
+            std::this_thread::yield();
+        }
+
+    private:
+#ifdef _WIN32
+        HANDLE m_timer = nullptr;
+#endif
+    };
+
+    inline int64_t Abs(int64_t value)
+    {
+        return value < 0 ? -value : value;
+    }
+}
+
+HostFrameClock& HostSystemClock()
+{
+    static SystemClock clock;
+    return clock;
+}
+
+//
+// HostFrameLimiter
+//
+
+HostFrameLimiter::HostFrameLimiter(double framesPerSecond, HostFrameClock& clock) :
+    m_clock(clock),
+    m_oversleep(InitialOversleep),
+    m_oversleepDeviation(0)
+{
+    if (!(framesPerSecond > 0))
+    {
+        throw std::invalid_argument("HostFrameLimiter: the frame rate must be positive");
+    }
+    m_interval = static_cast<int64_t>(1e9 / framesPerSecond);
+    m_interval = m_interval > 0 ? m_interval : 1;
+}
+
+int64_t HostFrameLimiter::GetSpinWindow() const
+{
+    const int64_t window = m_oversleep + 4 * m_oversleepDeviation;
+    return window < MinSpinWindow ? MinSpinWindow : window;
+}
+
+void HostFrameLimiter::WaitForNextFrame()
+{
+    int64_t now = m_clock.Now();
+    if (!m_started || now - m_next > m_interval)
+    {
+        // First frame, or too far behind to catch up: start the schedule over.
+        m_stats.lateFrames += m_started ? 1 : 0;
+        m_started = true;
+        m_next = now;
+    }
+
+    const int64_t sleepTarget = m_next - GetSpinWindow();
+    if (now < sleepTarget)
+    {
+        m_clock.SleepUntil(sleepTarget);
+        const int64_t woke = m_clock.Now();
+        m_stats.sleepNanoseconds += woke - now;
+
+        // Early wake-ups count as on time.
+        const int64_t late = woke > sleepTarget ? woke - sleepTarget : 0;
+        m_oversleepDeviation += (Abs(late - m_oversleep) - m_oversleepDeviation) / 8;
+        m_oversleep += (late - m_oversleep) / 8;
+        now = woke;
+    }
+    else if (m_next - now > MinSpinWindow)
+    {
+        // The whole wait was spun. Let the estimate shrink so that a later
+        // frame sleeps again and measures the timer afresh.
+        m_oversleep -= m_oversleep / 64;
+        m_oversleepDeviation -= m_oversleepDeviation / 64;
+    }
+
+    const int64_t spinStart = now;
+    while (now < m_next)
+    {
+        m_clock.Spin();
+        now = m_clock.Now();
+    }
+    m_stats.spinNanoseconds += now - spinStart;
+
+    const int64_t error = now - m_next;
+    m_stats.totalErrorNanoseconds += error;
+    m_stats.maxErrorNanoseconds = error > m_stats.maxErrorNanoseconds ? error : m_stats.maxErrorNanoseconds;
+    m_stats.frames++;
+    m_next += m_interval;
+}
+
+//
+// HostRunFrameLoop
+//
+
+HostFrameLoopStats HostRunFrameLoop(HostFrameLoopHost& host, HostFrameLimiter* limiter)
+{
+    HostFrameLoopStats stats = {};
+    while (host.PumpEvents())
+    {
+        // Nothing to show: sleep in the event queue rather than render.
+        if (!host.IsVisible())
+        {
+            host.WaitForEvents();
+            stats.idleWaits++;
+            continue;
+        }
+
+        if (limiter != nullptr)
+        {
+            limiter->WaitForNextFrame();
+        }
+        host.RenderFrame();
+        stats.frames++;
+    }
+    return stats;
+}
@@ -0,0 +1,116 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Main-loop policy, kept apart from the window system so it runs headless.
+// The loop renders continuously while the window is visible and blocks on
+// the event queue while it is not. Frames are paced by the present mode:
+//
+//   Vsync      Present waits for the display (sync interval 1);
+//   Uncapped   frames run back to back (sync interval 0, tearing allowed);
+//   FixedRate  a HostFrameLimiter starts frames at a fixed rate.
+//
+// The limiter sleeps until shortly before each deadline and spins for the
+// rest. How early it wakes follows the measured oversleep of the platform
+// timer (a high-resolution waitable timer on Windows, nanosleep elsewhere),
+// so it is accurate to well under a millisecond without spinning for most
+// of the interval. The clock is an interface, so schedules can be checked
+// against simulated time.
+
+#pragma once
+
+#include <cstdint>
+
+enum class HostPresentMode : uint32_t
+{
+    Vsync,
+    Uncapped,
+    FixedRate,
+};
+
+inline uint32_t HostSyncInterval(HostPresentMode mode)
+{
+    return mode == HostPresentMode::Vsync ? 1 : 0;
+}
+
+// Monotonic nanoseconds and a sleep that may overshoot.
+class HostFrameClock
+{
+public:
+    virtual ~HostFrameClock() {}
+
+    virtual int64_t Now() = 0;
+    virtual void SleepUntil(int64_t deadline) = 0;
+
+    // One step of a busy wait.
+    virtual void Spin() = 0;
+};
+
+// The steady clock and the platform's finest sleep. For one thread at a time.
+HostFrameClock& HostSystemClock();
+
+struct HostFrameLimiterStats
+{
+    uint64_t frames;
+    uint64_t lateFrames;        // Started more than an interval behind; the schedule restarts.
+    int64_t sleepNanoseconds;
+    int64_t spinNanoseconds;    // The limiter's CPU cost.
+    int64_t totalErrorNanoseconds;  // Sum of |start - deadline|.
+    int64_t maxErrorNanoseconds;
+};
+
+class HostFrameLimiter
+{
+public:
+    // Throws std::invalid_argument unless framesPerSecond is positive.
+    explicit HostFrameLimiter(double framesPerSecond, HostFrameClock& clock = HostSystemClock());
+
+    // Returns once the next frame is due. The first frame starts at once.
+    void WaitForNextFrame();
+
+    int64_t GetInterval() const     { return m_interval; }
+
+    // Time before a deadline that is spun rather than slept.
+    int64_t GetSpinWindow() const;
+
+    const HostFrameLimiterStats& GetStats() const { return m_stats; }
+
+private:
+    HostFrameClock& m_clock;
+    int64_t m_interval;
+    int64_t m_next = 0;
+    bool m_started = false;
+
+    // Running mean and mean deviation of how late sleeps return.
+    int64_t m_oversleep;
+    int64_t m_oversleepDeviation;
+
+    HostFrameLimiterStats m_stats = {};
+};
+
+// What the loop needs from the window system and the renderer.
+class HostFrameLoopHost
+{
+public:
+    virtual ~HostFrameLoopHost() {}
+
+    // Handles pending events without blocking; false once the loop should end.
+    virtual bool PumpEvents() = 0;
+
+    // Blocks until at least one event is pending.
+    virtual void WaitForEvents() = 0;
+
+    virtual bool IsVisible() = 0;
+    virtual void RenderFrame() = 0;
+};
+
+struct HostFrameLoopStats
+{
+    uint64_t frames;
+    uint64_t idleWaits;
+};
+
+// Runs until PumpEvents returns false, pacing frames with limiter when it is
+// not null.
+HostFrameLoopStats HostRunFrameLoop(HostFrameLoopHost& host, HostFrameLimiter* limiter);
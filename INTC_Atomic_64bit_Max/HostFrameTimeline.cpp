@@ -0,0 +1,374 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostFrameTimeline.h"
+#include "HostBits.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HOST_TIMELINE_X86 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace
+{
+    // Durations below 16 ticks have a bucket each; above, every octave is
+    // split into 16 buckets.
+    const uint32_t SubBucketBits = 4;
+    const uint32_t SubBuckets = 1u << SubBucketBits;
+    const uint32_t BucketCount = (64 - SubBucketBits + 1) * SubBuckets;
+
+    // Shortest time GetTicksPerSecond measures the counter over.
+    const int64_t MinCalibrationNanoseconds = 20000000;
+
+    std::atomic<uint64_t> s_nextTimelineId(1);
+
+    int64_t NowNanoseconds()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    inline uint32_t BucketIndex(uint64_t ticks)
+    {
+        if (ticks < SubBuckets)
+        {
+            return static_cast<uint32_t>(ticks);
+        }
+        const uint32_t octave = HighestBit(ticks) - SubBucketBits;
+        const uint32_t sub = static_cast<uint32_t>(ticks >> octave) & (SubBuckets - 1);
+        return (octave + 1) * SubBuckets + sub;
+    }
+
+    // Middle of the durations a bucket holds.
+    inline double BucketMidpoint(uint32_t index)
+    {
+        if (index < SubBuckets)
+        {
+            return index;
+        }
+        const uint32_t octave = index / SubBuckets - 1;
+        const uint64_t lower = static_cast<uint64_t>(SubBuckets + index % SubBuckets) << octave;
+        return static_cast<double>(lower) + static_cast<double>((1ull << octave) - 1) / 2;
+    }
+
+    // Single-writer counter: no read-modify-write needed.
+    inline void Add(std::atomic<uint64_t>& counter, uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+}
+
+// One thread's events. Only the owning thread writes; readers take relaxed
+// snapshots. A thread that ends hands its log to the next new thread.
+struct HostFrameTimeline::ThreadLog
+{
+    struct Slot
+    {
+        std::atomic<uint64_t> phase;
+        std::atomic<uint64_t> start;
+        std::atomic<uint64_t> end;
+    };
+
+    ThreadLog(uint32_t index, uint32_t phaseCount, uint32_t eventsPerThread) :
+        thread(index),
+        inUse(true),
+        claimed(0),
+        published(0),
+        events(new Slot[eventsPerThread]),
+        buckets(new std::atomic<uint64_t>[static_cast<size_t>(phaseCount) * BucketCount]),
+        totalTicks(new std::atomic<uint64_t>[phaseCount]),
+        maxTicks(new std::atomic<uint64_t>[phaseCount])
+    {
+        for (size_t i = 0; i < static_cast<size_t>(phaseCount) * BucketCount; i++)
+        {
+            buckets[i].store(0, std::memory_order_relaxed);
+        }
+        for (uint32_t phase = 0; phase < phaseCount; phase++)
+        {
+            totalTicks[phase].store(0, std::memory_order_relaxed);
+            maxTicks[phase].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    const uint32_t thread;
+    std::atomic<bool> inUse;
+
+    // Events started and finished. A reader discards the slots a write past
+    // its snapshot may have reached, seqlock style.
+    std::atomic<uint64_t> claimed;
+    std::atomic<uint64_t> published;
+    std::unique_ptr<Slot[]> events;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets;  // phase * BucketCount + bucket.
+    std::unique_ptr<std::atomic<uint64_t>[]> totalTicks;
+    std::unique_ptr<std::atomic<uint64_t>[]> maxTicks;
+};
+
+namespace
+{
+    // The logs of the current thread, by timeline id. Releases them when the
+    // thread ends.
+    struct ThreadLogs
+    {
+        std::vector<std::pair<uint64_t, std::shared_ptr<HostFrameTimeline::ThreadLog>>> logs;
+
+        ~ThreadLogs()
+        {
+            for (auto& entry : logs)
+            {
+                entry.second->inUse.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    thread_local ThreadLogs t_threadLogs;
+}
+
+uint64_t HostTimelineTicks()
+{
+#ifdef HOST_TIMELINE_X86
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(NowNanoseconds());
+#endif
+}
+
+//
+// HostFrameTimeline
+//
+
+HostFrameTimeline::HostFrameTimeline(std::vector<std::string> phaseNames, uint32_t eventsPerThread) :
+    m_id(s_nextTimelineId++),
+    m_phaseNames(std::move(phaseNames)),
+    m_eventsPerThread(eventsPerThread),
+    m_startTicks(HostTimelineTicks()),
+    m_startNanoseconds(NowNanoseconds())
+{
+    if (m_phaseNames.empty() || eventsPerThread == 0)
+    {
+        throw std::invalid_argument("HostFrameTimeline: no phases or no events per thread");
+    }
+}
+
+HostFrameTimeline::ThreadLog& HostFrameTimeline::GetThreadLog()
+{
+    for (auto& entry : t_threadLogs.logs)
+    {
+        if (entry.first == m_id)
+        {
+            return *entry.second;
+        }
+    }
+
+    // The thread's first event: forget logs of timelines that are gone, then
+    // take a log a finished thread left, or start one.
+    std::vector<std::pair<uint64_t, std::shared_ptr<ThreadLog>>>& logs = t_threadLogs.logs;
+    logs.erase(std::remove_if(logs.begin(), logs.end(),
+        [](const std::pair<uint64_t, std::shared_ptr<ThreadLog>>& entry) { return entry.second.use_count() == 1; }),
+        logs.end());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::shared_ptr<ThreadLog> log;
+    for (const std::shared_ptr<ThreadLog>& candidate : m_logs)
+    {
+        bool expected = false;
+        if (candidate->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        {
+            log = candidate;
+            break;
+        }
+    }
+    if (!log)
+    {
+        log = std::make_shared<ThreadLog>(static_cast<uint32_t>(m_logs.size()), GetPhaseCount(), m_eventsPerThread);
+        m_logs.push_back(log);
+    }
+    logs.emplace_back(m_id, log);
+    return *log;
+}
+
+void HostFrameTimeline::Record(uint32_t phase, uint64_t start, uint64_t end)
+{
+    if (phase >= GetPhaseCount())
+    {
+        return;
+    }
+    ThreadLog& log = GetThreadLog();
+
+    const uint64_t index = log.claimed.load(std::memory_order_relaxed);
+    log.claimed.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ThreadLog::Slot& slot = log.events[index % m_eventsPerThread];
+    slot.phase.store(phase, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    log.published.store(index + 1, std::memory_order_release);
+
+    const uint64_t ticks = end > start ? end - start : 0;
+    Add(log.buckets[static_cast<size_t>(phase) * BucketCount + BucketIndex(ticks)], 1);
+    Add(log.totalTicks[phase], ticks);
+    if (ticks > log.maxTicks[phase].load(std::memory_order_relaxed))
+    {
+        log.maxTicks[phase].store(ticks, std::memory_order_relaxed);
+    }
+}
+
+double HostFrameTimeline::GetTicksPerSecond() const
+{
+#ifdef HOST_TIMELINE_X86
+    int64_t nanoseconds = NowNanoseconds() - m_startNanoseconds;
+    if (nanoseconds < MinCalibrationNanoseconds)
+    {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(MinCalibrationNanoseconds - nanoseconds));
+    }
+    const uint64_t ticks = HostTimelineTicks() - m_startTicks;
+    nanoseconds = NowNanoseconds() - m_startNanoseconds;
+    return static_cast<double>(ticks) * 1e9 / static_cast<double>(nanoseconds);
+#else
+    return 1e9;
+#endif
+}
+
+std::vector<HostTimelinePhaseSummary> HostFrameTimeline::Summarize() const
+{
+    const double microsecondsPerTick = 1e6 / GetTicksPerSecond();
+    const uint32_t phaseCount = GetPhaseCount();
+
+    std::vector<uint64_t> buckets(static_cast<size_t>(phaseCount) * BucketCount, 0);
+    std::vector<uint64_t> totalTicks(phaseCount, 0);
+    std::vector<uint64_t> maxTicks(phaseCount, 0);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const std::shared_ptr<ThreadLog>& log : m_logs)
+        {
+            for (size_t i = 0; i < buckets.size(); i++)
+            {
+                buckets[i] += log->buckets[i].load(std::memory_order_relaxed);
+            }
+            for (uint32_t phase = 0; phase < phaseCount; phase++)
+            {
+                totalTicks[phase] += log->totalTicks[phase].load(std::memory_order_relaxed);
+                maxTicks[phase] = std::max(maxTicks[phase], log->maxTicks[phase].load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+    std::vector<HostTimelinePhaseSummary> summaries(phaseCount);
+    for (uint32_t phase = 0; phase < phaseCount; phase++)
+    {
+        const uint64_t* histogram = &buckets[static_cast<size_t>(phase) * BucketCount];
+        uint64_t count = 0;
+        for (uint32_t bucket = 0; bucket < BucketCount; bucket++)
+        {
+            count += histogram[bucket];
+        }
+
+        // Nearest rank; bucket midpoints never exceed the largest duration.
+        auto percentile = [&](double fraction)
+        {
+            const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * static_cast<double>(count) + 0.999999));
+            uint64_t seen = 0;
+            for (uint32_t bucket = 0; bucket < BucketCount; bucket++)
+            {
+                seen += histogram[bucket];
+                if (seen >= rank)
+                {
+                    return std::min(BucketMidpoint(bucket), static_cast<double>(maxTicks[phase])) * microsecondsPerTick;
+                }
+            }
+            return 0.0;
+        };
+
+        HostTimelinePhaseSummary& summary = summaries[phase];
+        summary.name = m_phaseNames[phase];
+        summary.count = count;
+        summary.totalMicroseconds = static_cast<double>(totalTicks[phase]) * microsecondsPerTick;
+        summary.meanMicroseconds = count != 0 ? summary.totalMicroseconds / static_cast<double>(count) : 0;
+        summary.p50Microseconds = count != 0 ? percentile(0.50) : 0;
+        summary.p99Microseconds = count != 0 ? percentile(0.99) : 0;
+        summary.maxMicroseconds = static_cast<double>(maxTicks[phase]) * microsecondsPerTick;
+    }
+    return summaries;
+}
+
+std::vector<HostTimelineEvent> HostFrameTimeline::GetEvents() const
+{
+    std::vector<HostTimelineEvent> events;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const std::shared_ptr<ThreadLog>& log : m_logs)
+    {
+        const uint64_t published = log->published.load(std::memory_order_acquire);
+        const uint64_t first = published > m_eventsPerThread ? published - m_eventsPerThread : 0;
+        const size_t begin = events.size();
+        for (uint64_t index = first; index < published; index++)
+        {
+            const ThreadLog::Slot& slot = log->events[index % m_eventsPerThread];
+            events.push_back({ static_cast<uint32_t>(slot.phase.load(std::memory_order_relaxed)), log->thread,
+                slot.start.load(std::memory_order_relaxed), slot.end.load(std::memory_order_relaxed) });
+        }
+
+        // Drop the slots the writer may have reused while they were copied.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t claimed = log->claimed.load(std::memory_order_relaxed);
+        const uint64_t valid = claimed > m_eventsPerThread ? claimed - m_eventsPerThread : 0;
+        if (valid > first)
+        {
+            const size_t stale = static_cast<size_t>(std::min(valid, published) - first);
+            events.erase(events.begin() + begin, events.begin() + begin + stale);
+        }
+    }
+
+    std::sort(events.begin(), events.end(), [](const HostTimelineEvent& a, const HostTimelineEvent& b)
+    {
+        return a.start < b.start;
+    });
+    return events;
+}
+
+void HostFrameTimeline::WriteTrace(const char* path) const
+{
+    const double microsecondsPerTick = 1e6 / GetTicksPerSecond();
+    const std::vector<HostTimelineEvent> events = GetEvents();
+
+    std::ofstream file(path);
+    file.setf(std::ios::fixed);
+    file.precision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const HostTimelineEvent& event = events[i];
+        std::string name;
+        for (char c : m_phaseNames[event.phase])
+        {
+            if (c == '"' || c == '\\')
+            {
+                name += '\\';
+            }
+            name += c;
+        }
+        const double start = static_cast<double>(static_cast<int64_t>(event.start - m_startTicks)) * microsecondsPerTick;
+        const double duration = static_cast<double>(event.end > event.start ? event.end - event.start : 0) * microsecondsPerTick;
+        file << (i == 0 ? "\n" : ",\n") << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+            << ",\"ts\":" << start << ",\"dur\":" << duration << "}";
+    }
+    file << "\n]}\n";
+
+    file.close();
+    if (!file)
+    {
+        throw std::runtime_error("HostFrameTimeline: cannot write " + std::string(path));
+    }
+}
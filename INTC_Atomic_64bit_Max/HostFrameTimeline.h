@@ -0,0 +1,130 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// CPU time per phase of the frame. A HostTimelineScope stamps the start and
+// end of a phase with the timestamp counter (rdtsc on x86, the steady clock
+// elsewhere) and hands them to the timeline, which files them on the
+// calling thread's own storage: no locks and no shared cache lines after a
+// thread's first event.
+//
+// Each thread keeps two things per timeline:
+//
+//   a ring of its last eventsPerThread events, for WriteTrace;
+//   a log-linear histogram of durations per phase, at 1/16-octave steps,
+//       which keeps every event, so one-off phases like startup are never
+//       pushed out by the frame loop.
+//
+// Summarize reads both while threads keep recording and turns the
+// histograms into count, mean, p50, p99 and max per phase; percentiles are
+// within about 3% of the exact value. Ticks are converted to time with a
+// rate measured against the steady clock over the timeline's lifetime.
+//
+// A scope built with a null timeline records nothing and costs one branch,
+// so instrumentation can stay in place with the timeline switched off.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// The counter HostTimelineScope reads.
+uint64_t HostTimelineTicks();
+
+struct HostTimelineEvent
+{
+    uint32_t phase;
+    uint32_t thread;    // Log index; a thread that ends hands its log on.
+    uint64_t start;     // Ticks.
+    uint64_t end;
+};
+
+struct HostTimelinePhaseSummary
+{
+    std::string name;
+    uint64_t count;
+    double totalMicroseconds;
+    double meanMicroseconds;
+    double p50Microseconds;
+    double p99Microseconds;
+    double maxMicroseconds;
+};
+
+class HostFrameTimeline
+{
+public:
+    static const uint32_t DefaultEventsPerThread = 4096;
+
+    // Phase i is named phaseNames[i]. Throws std::invalid_argument for no
+    // phases or no events per thread.
+    explicit HostFrameTimeline(std::vector<std::string> phaseNames, uint32_t eventsPerThread = DefaultEventsPerThread);
+
+    HostFrameTimeline(const HostFrameTimeline&) = delete;
+    HostFrameTimeline& operator=(const HostFrameTimeline&) = delete;
+
+    // Files a phase on the calling thread. Phases out of range are ignored.
+    void Record(uint32_t phase, uint64_t start, uint64_t end);
+
+    uint32_t GetPhaseCount() const { return static_cast<uint32_t>(m_phaseNames.size()); }
+
+    // Ticks per second of HostTimelineTicks. On x86 this is measured, so
+    // the first call waits until the timeline is at least 20 ms old.
+    double GetTicksPerSecond() const;
+
+    std::vector<HostTimelinePhaseSummary> Summarize() const;
+
+    // The events the rings still hold, by start.
+    std::vector<HostTimelineEvent> GetEvents() const;
+
+    // Writes GetEvents as a Chrome trace (chrome://tracing, Perfetto).
+    // Throws std::runtime_error when the file cannot be written.
+    void WriteTrace(const char* path) const;
+
+    struct ThreadLog;
+
+private:
+    ThreadLog& GetThreadLog();
+
+    const uint64_t m_id;    // Tells this timeline's logs from a dead one's.
+    std::vector<std::string> m_phaseNames;
+    uint32_t m_eventsPerThread;
+
+    const uint64_t m_startTicks;
+    const int64_t m_startNanoseconds;
+
+    mutable std::mutex m_mutex;     // Guards m_logs; writers take it for their first event only.
+    std::vector<std::shared_ptr<ThreadLog>> m_logs;
+};
+
+// Times its own lifetime as one phase.
+class HostTimelineScope
+{
+public:
+    HostTimelineScope(HostFrameTimeline* timeline, uint32_t phase) :
+        m_timeline(timeline),
+        m_phase(phase),
+        m_start(timeline != nullptr ? HostTimelineTicks() : 0)
+    {
+    }
+
+    ~HostTimelineScope()
+    {
+        if (m_timeline != nullptr)
+        {
+            m_timeline->Record(m_phase, m_start, HostTimelineTicks());
+        }
+    }
+
+    HostTimelineScope(const HostTimelineScope&) = delete;
+    HostTimelineScope& operator=(const HostTimelineScope&) = delete;
+
+private:
+    HostFrameTimeline* m_timeline;
+    uint32_t m_phase;
+    uint64_t m_start;
+};
@@ -0,0 +1,392 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostHeapAllocator.h"
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+namespace
+{
+    inline bool IsPowerOfTwo(uint64_t value)
+    {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+
+    inline uint32_t CeilLog2(uint64_t value)
+    {
+        uint32_t log = 0;
+        while ((1ull << log) < value)
+        {
+            log++;
+        }
+        return log;
+    }
+
+    inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+//
+// HostBuddyAllocator
+//
+
+const uint64_t HostBuddyAllocator::InvalidOffset;
+const uint32_t HostBuddyAllocator::InvalidBlock;
+const uint8_t HostBuddyAllocator::NoOrder;
+
+HostBuddyAllocator::HostBuddyAllocator(uint64_t heapSize, uint64_t minBlockSize) :
+    m_minBlockSize(minBlockSize),
+    m_minBlockShift(CeilLog2(minBlockSize)),
+    m_maxOrder(0),
+    m_allocatedBytes(0)
+{
+    if (!IsPowerOfTwo(minBlockSize) || heapSize == 0)
+    {
+        throw std::invalid_argument("HostBuddyAllocator: block size must be a power of two");
+    }
+
+    m_maxOrder = CeilLog2((heapSize + minBlockSize - 1) >> m_minBlockShift);
+    if (m_maxOrder >= 32)
+    {
+        throw std::invalid_argument("HostBuddyAllocator: heap has too many blocks");
+    }
+
+    const size_t blockCount = static_cast<size_t>(1) << m_maxOrder;
+    m_freeHeads.assign(m_maxOrder + 1, InvalidBlock);
+    m_next.assign(blockCount, InvalidBlock);
+    m_prev.assign(blockCount, InvalidBlock);
+    m_freeOrder.assign(blockCount, NoOrder);
+    m_allocatedOrder.assign(blockCount, NoOrder);
+    PushFree(0, m_maxOrder);
+}
+
+uint32_t HostBuddyAllocator::OrderFor(uint64_t size) const
+{
+    return CeilLog2((size + m_minBlockSize - 1) >> m_minBlockShift);
+}
+
+void HostBuddyAllocator::PushFree(uint32_t block, uint32_t order)
+{
+    const uint32_t head = m_freeHeads[order];
+    m_next[block] = head;
+    m_prev[block] = InvalidBlock;
+    if (head != InvalidBlock)
+    {
+        m_prev[head] = block;
+    }
+    m_freeHeads[order] = block;
+    m_freeOrder[block] = static_cast<uint8_t>(order);
+}
+
+void HostBuddyAllocator::RemoveFree(uint32_t block, uint32_t order)
+{
+    const uint32_t next = m_next[block];
+    const uint32_t prev = m_prev[block];
+    if (prev != InvalidBlock)
+    {
+        m_next[prev] = next;
+    }
+    else
+    {
+        m_freeHeads[order] = next;
+    }
+    if (next != InvalidBlock)
+    {
+        m_prev[next] = prev;
+    }
+    m_freeOrder[block] = NoOrder;
+}
+
+uint64_t HostBuddyAllocator::Allocate(uint64_t size)
+{
+    const uint32_t order = OrderFor(size == 0 ? 1 : size);
+    if (order > m_maxOrder)
+    {
+        return InvalidOffset;
+    }
+
+    uint32_t found = order;
+    while (found <= m_maxOrder && m_freeHeads[found] == InvalidBlock)
+    {
+        found++;
+    }
+    if (found > m_maxOrder)
+    {
+        return InvalidOffset;
+    }
+
+    const uint32_t block = m_freeHeads[found];
+    RemoveFree(block, found);
+
+    // Split down to the requested order, returning upper halves to the free lists.
+    while (found > order)
+    {
+        found--;
+        PushFree(block + (1u << found), found);
+    }
+
+    m_allocatedOrder[block] = static_cast<uint8_t>(order);
+    m_allocatedBytes += m_minBlockSize << order;
+    return static_cast<uint64_t>(block) << m_minBlockShift;
+}
+
+void HostBuddyAllocator::Free(uint64_t offset)
+{
+    uint32_t block = static_cast<uint32_t>(offset >> m_minBlockShift);
+    uint32_t order = m_allocatedOrder[block];
+    m_allocatedOrder[block] = NoOrder;
+    m_allocatedBytes -= m_minBlockSize << order;
+
+    // Merge with the buddy for as long as it is free and whole.
+    while (order < m_maxOrder)
+    {
+        const uint32_t buddy = block ^ (1u << order);
+        if (m_freeOrder[buddy] != order)
+        {
+            break;
+        }
+        RemoveFree(buddy, order);
+        block &= ~(1u << order);
+        order++;
+    }
+    PushFree(block, order);
+}
+
+uint64_t HostBuddyAllocator::GetLargestFreeBlock() const
+{
+    for (uint32_t order = m_maxOrder + 1; order-- > 0;)
+    {
+        if (m_freeHeads[order] != InvalidBlock)
+        {
+            return m_minBlockSize << order;
+        }
+    }
+    return 0;
+}
+
+//
+// HostHeapSuballocator
+//
+
+const uint32_t HostHeapAllocation::InvalidHeap;
+const uint64_t HostHeapSuballocator::DefaultHeapSize;
+
+HostHeapSuballocator::HostHeapSuballocator(uint64_t heapSize, CreateHeapCallback createHeap, ReleaseHeapCallback releaseHeap) :
+    m_heapSize(heapSize),
+    m_createHeap(createHeap),
+    m_releaseHeap(releaseHeap),
+    m_allocatedBytes(0),
+    m_allocationCount(0)
+{
+    if (heapSize < HostPlacementAlignment)
+    {
+        throw std::invalid_argument("HostHeapSuballocator: heap smaller than the placement alignment");
+    }
+    // Buddy heaps are a power-of-two number of 64 KiB blocks.
+    m_heapSize = HostPlacementAlignment << CeilLog2(heapSize / HostPlacementAlignment);
+}
+
+uint32_t HostHeapSuballocator::AddHeap(uint64_t size, bool shared)
+{
+    uint32_t index;
+    if (!m_releasedHeaps.empty())
+    {
+        index = m_releasedHeaps.back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_heaps.size());
+    }
+
+    if (m_createHeap)
+    {
+        m_createHeap(index, size);
+    }
+
+    Heap heap;
+    heap.buddy.reset(shared ? new HostBuddyAllocator(size) : nullptr);
+    heap.size = size;
+    if (index == m_heaps.size())
+    {
+        m_heaps.push_back(std::move(heap));
+    }
+    else
+    {
+        m_releasedHeaps.pop_back();
+        m_heaps[index] = std::move(heap);
+    }
+    return index;
+}
+
+void HostHeapSuballocator::ReleaseHeap(uint32_t heap)
+{
+    if (m_releaseHeap)
+    {
+        m_releaseHeap(heap);
+    }
+    m_heaps[heap].buddy.reset();
+    m_heaps[heap].size = 0;
+    m_releasedHeaps.push_back(heap);
+}
+
+HostHeapAllocation HostHeapSuballocator::Allocate(uint64_t size)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    HostHeapAllocation allocation = { HostHeapAllocation::InvalidHeap, 0, 0 };
+    if (size > m_heapSize)
+    {
+        allocation.size = AlignUp(size, HostPlacementAlignment);
+        allocation.heap = AddHeap(allocation.size, false);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < m_heaps.size() && !allocation.IsValid(); i++)
+        {
+            if (m_heaps[i].buddy)
+            {
+                const uint64_t offset = m_heaps[i].buddy->Allocate(size);
+                if (offset != HostBuddyAllocator::InvalidOffset)
+                {
+                    allocation.heap = i;
+                    allocation.offset = offset;
+                }
+            }
+        }
+        if (!allocation.IsValid())
+        {
+            allocation.heap = AddHeap(m_heapSize, true);
+            allocation.offset = m_heaps[allocation.heap].buddy->Allocate(size);
+        }
+        allocation.size = m_heaps[allocation.heap].buddy->BlockSize(size == 0 ? 1 : size);
+    }
+
+    m_allocatedBytes += allocation.size;
+    m_allocationCount++;
+    return allocation;
+}
+
+void HostHeapSuballocator::Free(const HostHeapAllocation& allocation)
+{
+    if (!allocation.IsValid())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Heap& heap = m_heaps[allocation.heap];
+    if (heap.buddy)
+    {
+        heap.buddy->Free(allocation.offset);
+    }
+    else
+    {
+        ReleaseHeap(allocation.heap);
+    }
+    m_allocatedBytes -= allocation.size;
+    m_allocationCount--;
+}
+
+void HostHeapSuballocator::Trim()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (uint32_t i = 0; i < m_heaps.size(); i++)
+    {
+        if (m_heaps[i].buddy && m_heaps[i].buddy->IsEmpty())
+        {
+            ReleaseHeap(i);
+        }
+    }
+}
+
+HostHeapStats HostHeapSuballocator::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    HostHeapStats stats = {};
+    for (const Heap& heap : m_heaps)
+    {
+        if (heap.size != 0)
+        {
+            stats.heapBytes += heap.size;
+            stats.heapCount++;
+            stats.dedicatedHeapCount += heap.buddy ? 0 : 1;
+        }
+    }
+    stats.allocatedBytes = m_allocatedBytes;
+    stats.allocationCount = m_allocationCount;
+    return stats;
+}
+
+//
+// Aliasing
+//
+
+uint64_t HostPlanAliasing(HostTransientSurface* surfaces, size_t count, uint64_t alignment)
+{
+    if (!IsPowerOfTwo(alignment))
+    {
+        throw std::invalid_argument("HostPlanAliasing: alignment must be a power of two");
+    }
+
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+    {
+        return surfaces[a].size > surfaces[b].size;
+    });
+
+    struct Range
+    {
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    uint64_t blockSize = 0;
+    std::vector<size_t> placed;
+    std::vector<Range> busy;
+    placed.reserve(count);
+    busy.reserve(count);
+
+    for (size_t index : order)
+    {
+        HostTransientSurface& surface = surfaces[index];
+        const uint64_t size = AlignUp(surface.size, alignment);
+
+        // Memory taken by already placed surfaces that are live at the same time.
+        busy.clear();
+        for (size_t other : placed)
+        {
+            const HostTransientSurface& placedSurface = surfaces[other];
+            if (placedSurface.firstPass <= surface.lastPass && surface.firstPass <= placedSurface.lastPass)
+            {
+                busy.push_back(Range{ placedSurface.offset, placedSurface.offset + AlignUp(placedSurface.size, alignment) });
+            }
+        }
+        std::sort(busy.begin(), busy.end(), [](const Range& a, const Range& b) { return a.begin < b.begin; });
+
+        // Lowest gap that fits.
+        uint64_t offset = 0;
+        for (const Range& range : busy)
+        {
+            if (offset + size <= range.begin)
+            {
+                break;
+            }
+            offset = std::max(offset, range.end);
+        }
+
+        surface.offset = offset;
+        blockSize = std::max(blockSize, offset + size);
+        placed.push_back(index);
+    }
+    return blockSize;
+}
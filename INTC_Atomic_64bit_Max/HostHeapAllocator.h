@@ -0,0 +1,160 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Heap suballocation for placed 64-bit atomic surfaces. Instead of one
+// INTC_D3D12_CreateCommittedResource (one allocation and one residency object)
+// per surface, surfaces are placed with INTC_D3D12_CreatePlacedResource into a
+// few large heaps from INTC_D3D12_CreateHeap. This file holds the allocation
+// logic only, with no D3D12 dependency; AtomicSurfaceHeap wraps it for the
+// device.
+//
+//   HostBuddyAllocator     - power-of-two blocks within one heap, O(log n)
+//                            allocate and free with buddy merging.
+//   HostHeapSuballocator   - a growing set of buddy heaps plus dedicated heaps
+//                            for surfaces larger than a heap.
+//   HostPlanAliasing       - packs transient surfaces whose pass lifetimes do
+//                            not overlap into the same memory.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// D3D12 resource placement alignment (D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT).
+static const uint64_t HostPlacementAlignment = 64 * 1024;
+
+class HostBuddyAllocator
+{
+public:
+    static const uint64_t InvalidOffset = ~0ull;
+
+    // heapSize is rounded up to a power-of-two multiple of minBlockSize, which
+    // must itself be a power of two. Throws std::invalid_argument otherwise.
+    explicit HostBuddyAllocator(uint64_t heapSize, uint64_t minBlockSize = HostPlacementAlignment);
+
+    // Returns the offset of a block of at least size bytes, aligned to its own
+    // (power-of-two) size, or InvalidOffset when no block is free.
+    uint64_t Allocate(uint64_t size);
+
+    // offset must come from Allocate and not have been freed yet.
+    void Free(uint64_t offset);
+
+    uint64_t GetHeapSize() const        { return m_minBlockSize << m_maxOrder; }
+    uint64_t GetAllocatedBytes() const  { return m_allocatedBytes; }
+    uint64_t GetLargestFreeBlock() const;
+    bool IsEmpty() const                { return m_allocatedBytes == 0; }
+
+    // Size of the block that holds size bytes.
+    uint64_t BlockSize(uint64_t size) const { return m_minBlockSize << OrderFor(size); }
+
+private:
+    static const uint32_t InvalidBlock = ~0u;
+    static const uint8_t NoOrder = 0xFF;
+
+    uint32_t OrderFor(uint64_t size) const;
+    void PushFree(uint32_t block, uint32_t order);
+    void RemoveFree(uint32_t block, uint32_t order);
+
+    uint64_t m_minBlockSize;
+    uint32_t m_minBlockShift;
+    uint32_t m_maxOrder;
+    uint64_t m_allocatedBytes;
+
+    // Free lists are intrusive doubly linked lists threaded through the
+    // per-min-block arrays below, indexed by the first min-block of a block.
+    std::vector<uint32_t> m_freeHeads;      // Per order.
+    std::vector<uint32_t> m_next;
+    std::vector<uint32_t> m_prev;
+    std::vector<uint8_t> m_freeOrder;       // Order of the free block starting here, or NoOrder.
+    std::vector<uint8_t> m_allocatedOrder;  // Order of the allocated block starting here, or NoOrder.
+};
+
+struct HostHeapAllocation
+{
+    static const uint32_t InvalidHeap = ~0u;
+
+    uint32_t heap;      // Index passed to the create-heap callback.
+    uint64_t offset;    // Byte offset within the heap.
+    uint64_t size;      // Bytes reserved, including buddy rounding.
+
+    bool IsValid() const { return heap != InvalidHeap; }
+};
+
+struct HostHeapStats
+{
+    uint64_t heapBytes;         // Bytes in all live heaps.
+    uint64_t allocatedBytes;    // Bytes reserved by live allocations.
+    uint64_t heapCount;
+    uint64_t dedicatedHeapCount;
+    uint64_t allocationCount;
+};
+
+class HostHeapSuballocator
+{
+public:
+    static const uint64_t DefaultHeapSize = 64ull * 1024 * 1024;
+
+    // Called with the heap index and size before an allocation in a new heap is
+    // returned, and with the index when a heap is no longer used. The callbacks
+    // run under the allocator lock and may be empty.
+    typedef std::function<void(uint32_t heap, uint64_t size)> CreateHeapCallback;
+    typedef std::function<void(uint32_t heap)> ReleaseHeapCallback;
+
+    explicit HostHeapSuballocator(uint64_t heapSize = DefaultHeapSize,
+        CreateHeapCallback createHeap = CreateHeapCallback(), ReleaseHeapCallback releaseHeap = ReleaseHeapCallback());
+
+    // Allocations larger than the heap size get a dedicated heap of their own
+    // (64 KiB aligned). Exceptions from the create callback propagate and
+    // leave the allocator unchanged.
+    HostHeapAllocation Allocate(uint64_t size);
+
+    // Dedicated heaps are released immediately; shared heaps stay, so
+    // steady-state churn does not create and destroy heaps.
+    void Free(const HostHeapAllocation& allocation);
+
+    // Releases shared heaps that hold no allocations.
+    void Trim();
+
+    HostHeapStats GetStats() const;
+
+private:
+    struct Heap
+    {
+        std::unique_ptr<HostBuddyAllocator> buddy;  // Null for dedicated and released heaps.
+        uint64_t size;                              // Zero once released.
+    };
+
+    uint32_t AddHeap(uint64_t size, bool shared);
+    void ReleaseHeap(uint32_t heap);
+
+    mutable std::mutex m_mutex;
+    uint64_t m_heapSize;
+    CreateHeapCallback m_createHeap;
+    ReleaseHeapCallback m_releaseHeap;
+    std::vector<Heap> m_heaps;
+    std::vector<uint32_t> m_releasedHeaps;  // Indices available for reuse.
+    uint64_t m_allocatedBytes;
+    uint64_t m_allocationCount;
+};
+
+// A transient surface used by passes firstPass..lastPass (inclusive).
+struct HostTransientSurface
+{
+    uint64_t size;
+    uint32_t firstPass;
+    uint32_t lastPass;
+    uint64_t offset;    // Out: byte offset within the aliased block.
+};
+
+// Assigns offsets so that surfaces whose pass ranges overlap never share
+// memory, while surfaces that are never live together may. Offsets are
+// aligned to alignment. Returns the size of the block that holds all of them.
+// Largest surfaces are placed first, each at the lowest free offset. Aliased
+// surfaces need an aliasing barrier (and full initialization) when a new
+// surface starts using the memory.
+uint64_t HostPlanAliasing(HostTransientSurface* surfaces, size_t count, uint64_t alignment = HostPlacementAlignment);
@@ -0,0 +1,84 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Minimal fork-join helpers for the parallel host passes.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Number of threads the parallel host passes use by default.
+inline uint32_t HostWorkerCount()
+{
+    const uint32_t count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+// Worker count for a pass over the given number of bytes: workerCount, or
+// HostWorkerCount() when it is zero, capped so that each worker gets at least
+// 256 KB. Below that, threads cost more than they save.
+inline uint32_t HostWorkersForBytes(size_t bytes, uint32_t workerCount)
+{
+    const size_t MinBytesPerWorker = 256 * 1024;
+
+    if (workerCount == 0)
+    {
+        workerCount = HostWorkerCount();
+    }
+    const size_t maxWorkers = bytes / MinBytesPerWorker + 1;
+    return workerCount < maxWorkers ? workerCount : static_cast<uint32_t>(maxWorkers);
+}
+
+// Calls body(worker) once for every worker in [0, workerCount). Worker 0 runs on
+// the calling thread. Returns when all workers are done.
+template <typename Body>
+void HostParallelRun(uint32_t workerCount, Body body)
+{
+    if (workerCount <= 1)
+    {
+        body(0u);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(workerCount - 1);
+    for (uint32_t worker = 1; worker < workerCount; worker++)
+    {
+        threads.emplace_back(body, worker);
+    }
+    body(0u);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+// Splits [0, count) into workerCount contiguous ranges and calls
+// body(worker, begin, end) for each non-empty one.
+template <typename Body>
+void HostParallelRanges(size_t count, uint32_t workerCount, Body body)
+{
+    if (workerCount == 0)
+    {
+        workerCount = 1;
+    }
+    if (count < workerCount)
+    {
+        workerCount = static_cast<uint32_t>(count == 0 ? 1 : count);
+    }
+
+    HostParallelRun(workerCount, [&](uint32_t worker)
+    {
+        const size_t begin = count * worker / workerCount;
+        const size_t end = count * (worker + 1) / workerCount;
+        if (begin < end)
+        {
+            body(worker, begin, end);
+        }
+    });
+}
@@ -0,0 +1,123 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostParallelRecording.h"
+
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+std::vector<uint32_t> HostSubmissionOrder(const std::vector<std::vector<uint32_t>>& dependencies)
+{
+    const size_t passCount = dependencies.size();
+    std::vector<uint32_t> waiting(passCount, 0);
+    std::vector<std::vector<uint32_t>> dependents(passCount);
+    for (size_t pass = 0; pass < passCount; pass++)
+    {
+        for (uint32_t dependency : dependencies[pass])
+        {
+            if (dependency >= passCount)
+            {
+                throw std::invalid_argument("HostSubmissionOrder: dependency out of range");
+            }
+            dependents[dependency].push_back(static_cast<uint32_t>(pass));
+            waiting[pass]++;
+        }
+    }
+
+    // The lowest-numbered ready pass goes next.
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> ready;
+    for (size_t pass = 0; pass < passCount; pass++)
+    {
+        if (waiting[pass] == 0)
+        {
+            ready.push(static_cast<uint32_t>(pass));
+        }
+    }
+
+    std::vector<uint32_t> order;
+    order.reserve(passCount);
+    while (!ready.empty())
+    {
+        const uint32_t pass = ready.top();
+        ready.pop();
+        order.push_back(pass);
+        for (uint32_t dependent : dependents[pass])
+        {
+            if (--waiting[dependent] == 0)
+            {
+                ready.push(dependent);
+            }
+        }
+    }
+
+    if (order.size() != passCount)
+    {
+        throw std::invalid_argument("HostSubmissionOrder: the dependencies form a cycle");
+    }
+    return order;
+}
+
+//
+// HostParallelRecorder
+//
+
+HostParallelRecorder::HostParallelRecorder(uint32_t frameCount, uint32_t workerCount) :
+    m_frameCount(frameCount),
+    m_workerCount(workerCount)
+{
+    if (frameCount == 0 || workerCount == 0)
+    {
+        throw std::invalid_argument("HostParallelRecorder: zero frames or workers");
+    }
+    m_allocators.resize(static_cast<size_t>(frameCount) * workerCount);
+}
+
+void HostParallelRecorder::SetPasses(std::vector<HostRecordingPass> passes)
+{
+    std::vector<std::vector<uint32_t>> dependencies(passes.size());
+    for (size_t pass = 0; pass < passes.size(); pass++)
+    {
+        dependencies[pass] = passes[pass].dependencies;
+    }
+    m_order = HostSubmissionOrder(dependencies);
+    m_passes = std::move(passes);
+    m_passLists.assign(m_passes.size(), nullptr);
+    m_submission.assign(m_passes.size(), nullptr);
+}
+
+const std::vector<const HostCommandRecorder*>& HostParallelRecorder::RecordFrame(uint32_t frame)
+{
+    if (frame >= m_frameCount)
+    {
+        throw std::invalid_argument("HostParallelRecorder: frame out of range");
+    }
+
+    Allocator* allocators = &m_allocators[static_cast<size_t>(frame) * m_workerCount];
+    for (uint32_t worker = 0; worker < m_workerCount; worker++)
+    {
+        allocators[worker].used = 0;
+    }
+
+    HostRecordPasses(static_cast<uint32_t>(m_passes.size()), m_workerCount, [&](uint32_t worker, uint32_t pass)
+    {
+        Allocator& allocator = allocators[worker];
+        if (allocator.used == allocator.lists.size())
+        {
+            allocator.lists.emplace_back(new HostCommandRecorder());
+        }
+        HostCommandRecorder& list = *allocator.lists[allocator.used++];
+        list.Reset();
+        m_passes[pass].record(list);
+        m_passLists[pass] = &list;
+    });
+
+    for (size_t i = 0; i < m_order.size(); i++)
+    {
+        m_submission[i] = m_passLists[m_order[i]];
+    }
+    return m_submission;
+}
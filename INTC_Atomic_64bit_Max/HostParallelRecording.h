@@ -0,0 +1,119 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Recording a frame's passes on several threads. Each pass records into its
+// own command list, and each worker owns one allocator per frame in flight,
+// so no two threads ever share an allocator and an allocator is reset only
+// when its frame has completed. The lists are then submitted together, in
+// an order where every pass follows the passes it depends on.
+//
+// HostRecordPasses and HostSubmissionOrder are the API-neutral parts that
+// the sample drives with D3D12 command lists. HostParallelRecorder puts
+// them together over HostCommandRecorder, so recording throughput and its
+// scaling with workers can be measured without a GPU.
+
+#pragma once
+
+#include "HostCommandRecorder.h"
+#include "HostParallel.h"
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Orders passes so that each follows its dependencies (indices of other
+// passes), keeping pass order wherever the dependencies allow. Throws
+// std::invalid_argument for an index out of range or a cycle.
+std::vector<uint32_t> HostSubmissionOrder(const std::vector<std::vector<uint32_t>>& dependencies);
+
+// Calls record(worker, pass) once for each pass in [0, passCount) on up to
+// workerCount workers. Free workers take the next pass in order, and each
+// worker records one pass at a time, so lists that share a worker's
+// allocator are never open together. The first exception thrown by record
+// is rethrown on the calling thread once every worker has stopped.
+template <typename Record>
+void HostRecordPasses(uint32_t passCount, uint32_t workerCount, Record record)
+{
+    if (passCount == 0)
+    {
+        return;
+    }
+    workerCount = workerCount == 0 ? 1 : workerCount;
+    workerCount = workerCount < passCount ? workerCount : passCount;
+
+    std::atomic<uint32_t> next(0);
+    std::vector<std::exception_ptr> errors(workerCount);
+    HostParallelRun(workerCount, [&](uint32_t worker)
+    {
+        try
+        {
+            for (uint32_t pass = next++; pass < passCount; pass = next++)
+            {
+                record(worker, pass);
+            }
+        }
+        catch (...)
+        {
+            errors[worker] = std::current_exception();
+            next = passCount;
+        }
+    });
+
+    for (const std::exception_ptr& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+struct HostRecordingPass
+{
+    std::vector<uint32_t> dependencies;
+    std::function<void(HostCommandRecorder&)> record;
+};
+
+class HostParallelRecorder
+{
+public:
+    // Throws std::invalid_argument for zero frames or workers.
+    HostParallelRecorder(uint32_t frameCount, uint32_t workerCount);
+
+    // Replaces the passes and works out their submission order. Throws as
+    // HostSubmissionOrder does.
+    void SetPasses(std::vector<HostRecordingPass> passes);
+
+    // Resets frame's allocators, records every pass into a list from the
+    // allocator of the worker that takes it, and returns the lists in
+    // submission order: the array ExecuteCommandLists would take. The lists
+    // stay valid until frame is recorded again, so a frame may be recorded
+    // only once its previous lists have been consumed.
+    const std::vector<const HostCommandRecorder*>& RecordFrame(uint32_t frame);
+
+    uint32_t GetFrameCount() const  { return m_frameCount; }
+    uint32_t GetWorkerCount() const { return m_workerCount; }
+    const std::vector<uint32_t>& GetSubmissionOrder() const { return m_order; }
+
+private:
+    // A worker's lists for one frame. Reset keeps them, and their storage,
+    // for the next time the frame is recorded.
+    struct Allocator
+    {
+        std::vector<std::unique_ptr<HostCommandRecorder>> lists;
+        size_t used = 0;
+    };
+
+    uint32_t m_frameCount;
+    uint32_t m_workerCount;
+    std::vector<Allocator> m_allocators;    // frame * m_workerCount + worker.
+    std::vector<HostRecordingPass> m_passes;
+    std::vector<uint32_t> m_order;
+    std::vector<const HostCommandRecorder*> m_passLists;
+    std::vector<const HostCommandRecorder*> m_submission;
+};
@@ -0,0 +1,131 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostReadbackCopy.h"
+#include "HostParallel.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HOST_COPY_X86 1
+// MOVNTDQA is SSE4.1. MSVC emits it without /arch flags; GCC and Clang need
+// -msse4.1 or later, and fall back to ordinary loads otherwise.
+#if defined(_MSC_VER) || defined(__SSE4_1__)
+#define HOST_COPY_STREAM_LOADS 1
+#endif
+#endif
+
+namespace
+{
+#ifdef HOST_COPY_X86
+    template <bool AlignedSource, bool StreamStores>
+    void CopyRowBlocks(uint8_t* destination, const uint8_t* source, size_t blockCount)
+    {
+        for (size_t i = 0; i < blockCount; i++)
+        {
+            __m128i block[4];
+            for (int lane = 0; lane < 4; lane++)
+            {
+                __m128i* address = reinterpret_cast<__m128i*>(const_cast<uint8_t*>(source)) + lane;
+#ifdef HOST_COPY_STREAM_LOADS
+                block[lane] = AlignedSource ? _mm_stream_load_si128(address) : _mm_loadu_si128(address);
+#else
+                block[lane] = _mm_loadu_si128(address);
+#endif
+            }
+            for (int lane = 0; lane < 4; lane++)
+            {
+                __m128i* address = reinterpret_cast<__m128i*>(destination) + lane;
+                if (StreamStores)
+                {
+                    _mm_stream_si128(address, block[lane]);
+                }
+                else
+                {
+                    _mm_store_si128(address, block[lane]);
+                }
+            }
+            source += 64;
+            destination += 64;
+        }
+    }
+
+    // Copies one row: memcpy up to the first 16-byte boundary of the
+    // destination, 64-byte blocks, then memcpy of the tail.
+    template <bool StreamStores>
+    void CopyRow(uint8_t* destination, const uint8_t* source, size_t rowBytes)
+    {
+        size_t head = (16 - (reinterpret_cast<uintptr_t>(destination) & 15)) & 15;
+        head = head < rowBytes ? head : rowBytes;
+        memcpy(destination, source, head);
+        destination += head;
+        source += head;
+        rowBytes -= head;
+
+        const size_t blockCount = rowBytes / 64;
+        if ((reinterpret_cast<uintptr_t>(source) & 15) == 0)
+        {
+            CopyRowBlocks<true, StreamStores>(destination, source, blockCount);
+        }
+        else
+        {
+            CopyRowBlocks<false, StreamStores>(destination, source, blockCount);
+        }
+        memcpy(destination + blockCount * 64, source + blockCount * 64, rowBytes - blockCount * 64);
+    }
+#endif
+
+    template <bool StreamStores>
+    void CopyRows(uint8_t* destination, size_t destinationPitch, const uint8_t* source, size_t sourcePitch,
+        size_t rowBytes, size_t begin, size_t end)
+    {
+        for (size_t row = begin; row < end; row++)
+        {
+#ifdef HOST_COPY_X86
+            CopyRow<StreamStores>(destination + row * destinationPitch, source + row * sourcePitch, rowBytes);
+#else
+            memcpy(destination + row * destinationPitch, source + row * sourcePitch, rowBytes);
+#endif
+        }
+#ifdef HOST_COPY_X86
+        if (StreamStores)
+        {
+            // Streaming stores are weakly ordered; make them visible before
+            // the worker is joined.
+            _mm_sfence();
+        }
+#endif
+    }
+}
+
+void HostCopyPitchedRows(void* destination, size_t destinationPitch, const void* source, size_t sourcePitch,
+    size_t rowBytes, uint32_t rowCount, uint32_t workerCount, HostCopyMode mode)
+{
+    const size_t totalBytes = rowBytes * rowCount;
+    if (totalBytes == 0)
+    {
+        return;
+    }
+
+    workerCount = HostWorkersForBytes(totalBytes, workerCount);
+
+    const bool streamStores = mode == HostCopyMode::Streaming ||
+        (mode == HostCopyMode::Auto && totalBytes >= HostStreamingCopyThreshold);
+
+    uint8_t* destinationBytes = static_cast<uint8_t*>(destination);
+    const uint8_t* sourceBytes = static_cast<const uint8_t*>(source);
+    HostParallelRanges(rowCount, workerCount, [&](uint32_t, size_t begin, size_t end)
+    {
+        if (streamStores)
+        {
+            CopyRows<true>(destinationBytes, destinationPitch, sourceBytes, sourcePitch, rowBytes, begin, end);
+        }
+        else
+        {
+            CopyRows<false>(destinationBytes, destinationPitch, sourceBytes, sourcePitch, rowBytes, begin, end);
+        }
+    });
+}
@@ -0,0 +1,42 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Extraction of pitched readback rows into a tightly packed host array.
+// CopyTextureRegion lays rows out RowPitch bytes apart (rounded up to
+// D3D12_TEXTURE_DATA_PITCH_ALIGNMENT), so a readback buffer cannot be
+// indexed as width * height texels. The copy runs in parallel across rows.
+// On x86 it uses streaming (non-temporal) loads, which bypass the cache on
+// write-combined memory such as CPU-visible video memory. Large copies also
+// use streaming stores so the destination does not evict the working set.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum class HostCopyMode : uint32_t
+{
+    Auto,       // Streaming stores at or above HostStreamingCopyThreshold bytes.
+    Cached,
+    Streaming,
+};
+
+const size_t HostStreamingCopyThreshold = 8 * 1024 * 1024;
+
+// Copies rowCount rows of rowBytes each from source (sourcePitch bytes apart)
+// to destination (destinationPitch bytes apart). Any alignment and width is
+// accepted. A workerCount of zero uses HostWorkerCount() threads; small copies
+// use fewer.
+void HostCopyPitchedRows(void* destination, size_t destinationPitch, const void* source, size_t sourcePitch,
+    size_t rowBytes, uint32_t rowCount, uint32_t workerCount = 0, HostCopyMode mode = HostCopyMode::Auto);
+
+// Unpacks a width x height texel readback into a tight array of width * height
+// texels.
+inline void HostExtractReadback64(uint64_t* texels, const void* source, size_t rowPitch, uint32_t width, uint32_t height,
+    uint32_t workerCount = 0)
+{
+    const size_t rowBytes = static_cast<size_t>(width) * sizeof(uint64_t);
+    HostCopyPitchedRows(texels, rowBytes, source, rowPitch, rowBytes, height, workerCount);
+}
@@ -0,0 +1,157 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostSparseSurface64.h"
+
+#include <cstring>
+#include <stdexcept>
+
+HostSparseAtomicSurface64::HostSparseAtomicSurface64(uint32_t width, uint32_t height, uint64_t defaultValue) :
+    m_width(width),
+    m_height(height),
+    m_tilesX((width + TileWidth - 1) / TileWidth),
+    m_tilesY((height + TileHeight - 1) / TileHeight),
+    m_defaultValue(defaultValue),
+    m_residentTiles(0)
+{
+    if (width == 0 || height == 0)
+    {
+        throw std::invalid_argument("HostSparseAtomicSurface64: empty surface");
+    }
+    m_pageTable.reset(new std::atomic<Tile*>[static_cast<size_t>(m_tilesX) * m_tilesY]());
+}
+
+HostSparseAtomicSurface64::~HostSparseAtomicSurface64()
+{
+    Reset();
+}
+
+// Allocates a tile filled with the default value and publishes it. When two
+// threads race to allocate the same tile, the loser frees its copy and uses
+// the winner's.
+HostSparseAtomicSurface64::Tile* HostSparseAtomicSurface64::AllocateTile(size_t tileIndex)
+{
+    Tile* tile = new Tile;
+    for (std::atomic<uint64_t>& texel : tile->texels)
+    {
+        texel.store(m_defaultValue, std::memory_order_relaxed);
+    }
+
+    Tile* expected = nullptr;
+    if (m_pageTable[tileIndex].compare_exchange_strong(expected, tile, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        m_residentTiles.fetch_add(1, std::memory_order_relaxed);
+        return tile;
+    }
+
+    delete tile;
+    return expected;
+}
+
+uint64_t HostSparseAtomicSurface64::Load(uint32_t x, uint32_t y) const
+{
+    const Tile* tile = m_pageTable[TileIndex(x, y)].load(std::memory_order_acquire);
+    return tile == nullptr ? m_defaultValue : tile->texels[TexelIndex(x, y)].load(std::memory_order_relaxed);
+}
+
+void HostSparseAtomicSurface64::Store(uint32_t x, uint32_t y, uint64_t value)
+{
+    Apply(HostAtomicOp::Exchange, x, y, value);
+}
+
+uint64_t HostSparseAtomicSurface64::Apply(HostAtomicOp op, uint32_t x, uint32_t y, uint64_t value, uint64_t xchgValue)
+{
+    const size_t tileIndex = TileIndex(x, y);
+    Tile* tile = m_pageTable[tileIndex].load(std::memory_order_acquire);
+    if (tile == nullptr)
+    {
+        // Operations that cannot change a default texel are not writes.
+        const bool changesDefault = (op == HostAtomicOp::CompareExchange) ?
+            (value == m_defaultValue && xchgValue != m_defaultValue) :
+            (HostAtomicCombine(op, m_defaultValue, value) != m_defaultValue);
+        if (!changesDefault)
+        {
+            return m_defaultValue;
+        }
+        tile = AllocateTile(tileIndex);
+    }
+
+    std::atomic<uint64_t>& texel = tile->texels[TexelIndex(x, y)];
+    switch (op)
+    {
+    case HostAtomicOp::Add:         return texel.fetch_add(value);
+    case HostAtomicOp::And:         return texel.fetch_and(value);
+    case HostAtomicOp::Or:          return texel.fetch_or(value);
+    case HostAtomicOp::Xor:         return texel.fetch_xor(value);
+    case HostAtomicOp::Exchange:    return texel.exchange(value);
+    case HostAtomicOp::CompareExchange:
+        texel.compare_exchange_strong(value, xchgValue);
+        return value;
+    default:
+        break;
+    }
+
+    // Min / Max.
+    uint64_t current = texel.load(std::memory_order_relaxed);
+    while (HostAtomicCombine(op, current, value) != current && !texel.compare_exchange_weak(current, value))
+    {
+    }
+    return current;
+}
+
+bool HostSparseAtomicSurface64::IsTileResident(uint32_t tileX, uint32_t tileY) const
+{
+    return m_pageTable[static_cast<size_t>(tileY) * m_tilesX + tileX].load(std::memory_order_acquire) != nullptr;
+}
+
+uint32_t HostSparseAtomicSurface64::GetResidentTileCount() const
+{
+    return m_residentTiles.load(std::memory_order_relaxed);
+}
+
+uint64_t HostSparseAtomicSurface64::GetResidentBytes() const
+{
+    return static_cast<uint64_t>(GetResidentTileCount()) * sizeof(Tile) +
+        static_cast<uint64_t>(m_tilesX) * m_tilesY * sizeof(std::atomic<Tile*>);
+}
+
+void HostSparseAtomicSurface64::CopyTo(uint64_t* destination, size_t destinationPitch) const
+{
+    for (uint32_t y = 0; y < m_height; y++)
+    {
+        uint64_t* row = reinterpret_cast<uint64_t*>(reinterpret_cast<uint8_t*>(destination) + y * destinationPitch);
+        for (uint32_t tileX = 0; tileX < m_tilesX; tileX++)
+        {
+            const uint32_t x0 = tileX * TileWidth;
+            const uint32_t x1 = (x0 + TileWidth < m_width) ? x0 + TileWidth : m_width;
+            const Tile* tile = m_pageTable[static_cast<size_t>(y / TileHeight) * m_tilesX + tileX].load(std::memory_order_acquire);
+            if (tile == nullptr)
+            {
+                for (uint32_t x = x0; x < x1; x++)
+                {
+                    row[x] = m_defaultValue;
+                }
+            }
+            else
+            {
+                const std::atomic<uint64_t>* source = &tile->texels[(y % TileHeight) * TileWidth];
+                for (uint32_t x = x0; x < x1; x++)
+                {
+                    row[x] = source[x - x0].load(std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+}
+
+void HostSparseAtomicSurface64::Reset()
+{
+    const size_t tileCount = static_cast<size_t>(m_tilesX) * m_tilesY;
+    for (size_t i = 0; i < tileCount; i++)
+    {
+        delete m_pageTable[i].exchange(nullptr, std::memory_order_acq_rel);
+    }
+    m_residentTiles.store(0, std::memory_order_relaxed);
+}
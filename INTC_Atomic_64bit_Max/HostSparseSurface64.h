@@ -0,0 +1,89 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Sparse host 64-bit atomic surface, the host counterpart of a reserved
+// resource created with INTC_D3D12_CreateReservedResource. The surface is
+// split into 64 KiB tiles of 128 x 64 texels (the D3D12 standard tile shape
+// for 64 bpp formats). A flat page table holds one pointer per tile; tiles are
+// allocated on the first write that changes a texel and read back as the
+// default value until then, so memory is proportional to the touched area and
+// a lookup costs one extra load.
+
+#pragma once
+
+#include "HostAtomics64.h"
+
+class HostSparseAtomicSurface64
+{
+public:
+    static const uint32_t TileWidth = 128;
+    static const uint32_t TileHeight = 64;
+    static const uint32_t TileTexels = TileWidth * TileHeight;
+    static const size_t TileBytes = TileTexels * sizeof(uint64_t);
+
+    HostSparseAtomicSurface64(uint32_t width, uint32_t height, uint64_t defaultValue = 0);
+    ~HostSparseAtomicSurface64();
+
+    HostSparseAtomicSurface64(const HostSparseAtomicSurface64&) = delete;
+    HostSparseAtomicSurface64& operator=(const HostSparseAtomicSurface64&) = delete;
+
+    uint32_t GetWidth() const           { return m_width; }
+    uint32_t GetHeight() const          { return m_height; }
+    uint32_t GetTilesX() const          { return m_tilesX; }
+    uint32_t GetTilesY() const          { return m_tilesY; }
+    uint64_t GetDefaultValue() const    { return m_defaultValue; }
+
+    uint64_t Load(uint32_t x, uint32_t y) const;
+    void Store(uint32_t x, uint32_t y, uint64_t value);
+
+    // Same semantics as HostAtomicSurface64. An operation that would leave a
+    // texel of an unallocated tile at the default value does not allocate.
+    uint64_t InterlockedAdd(uint32_t x, uint32_t y, uint64_t value)       { return Apply(HostAtomicOp::Add, x, y, value); }
+    uint64_t InterlockedMin(uint32_t x, uint32_t y, uint64_t value)       { return Apply(HostAtomicOp::Min, x, y, value); }
+    uint64_t InterlockedMax(uint32_t x, uint32_t y, uint64_t value)       { return Apply(HostAtomicOp::Max, x, y, value); }
+    uint64_t InterlockedAnd(uint32_t x, uint32_t y, uint64_t value)       { return Apply(HostAtomicOp::And, x, y, value); }
+    uint64_t InterlockedOr(uint32_t x, uint32_t y, uint64_t value)        { return Apply(HostAtomicOp::Or, x, y, value); }
+    uint64_t InterlockedXor(uint32_t x, uint32_t y, uint64_t value)       { return Apply(HostAtomicOp::Xor, x, y, value); }
+    uint64_t InterlockedExchange(uint32_t x, uint32_t y, uint64_t value)  { return Apply(HostAtomicOp::Exchange, x, y, value); }
+    uint64_t InterlockedCompareExchange(uint32_t x, uint32_t y, uint64_t cmpValue, uint64_t xchgValue)
+    {
+        return Apply(HostAtomicOp::CompareExchange, x, y, cmpValue, xchgValue);
+    }
+
+    uint64_t Apply(HostAtomicOp op, uint32_t x, uint32_t y, uint64_t value, uint64_t xchgValue = 0);
+
+    bool IsTileResident(uint32_t tileX, uint32_t tileY) const;
+    uint32_t GetResidentTileCount() const;
+
+    // Tile memory plus the page table.
+    uint64_t GetResidentBytes() const;
+
+    // Writes the whole surface, row by row, to destination with the given row
+    // pitch in bytes. Unallocated tiles are filled with the default value.
+    void CopyTo(uint64_t* destination, size_t destinationPitch) const;
+
+    // Frees every tile; the surface reads as the default value again. No other
+    // thread may access the surface during the call.
+    void Reset();
+
+private:
+    struct Tile
+    {
+        std::atomic<uint64_t> texels[TileTexels];
+    };
+
+    size_t TileIndex(uint32_t x, uint32_t y) const  { return static_cast<size_t>(y / TileHeight) * m_tilesX + x / TileWidth; }
+    static uint32_t TexelIndex(uint32_t x, uint32_t y)  { return (y % TileHeight) * TileWidth + x % TileWidth; }
+
+    Tile* AllocateTile(size_t tileIndex);
+
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_tilesX;
+    uint32_t m_tilesY;
+    uint64_t m_defaultValue;
+    std::unique_ptr<std::atomic<Tile*>[]> m_pageTable;
+    std::atomic<uint32_t> m_residentTiles;
+};
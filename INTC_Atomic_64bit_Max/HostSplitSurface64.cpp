@@ -0,0 +1,236 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostSplitSurface64.h"
+#include "HostParallel.h"
+
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    inline uint32_t ResolveWorkers(uint32_t workerCount)
+    {
+        return workerCount == 0 ? HostWorkerCount() : workerCount;
+    }
+
+    // De-interleaves count packed texels into the two planes.
+    void SplitRow(const uint64_t* packed, uint32_t* low, uint32_t* high, size_t count)
+    {
+        size_t i = 0;
+#ifdef HOST_ATOMICS_X86
+        // Four texels per step: shuffle each pair of texels to (lo, lo, hi, hi)
+        // and recombine the halves.
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i a = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(packed + i)), _MM_SHUFFLE(3, 1, 2, 0));
+            const __m128i b = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(packed + i + 2)), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(low + i), _mm_unpacklo_epi64(a, b));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(high + i), _mm_unpackhi_epi64(a, b));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            low[i] = static_cast<uint32_t>(packed[i]);
+            high[i] = static_cast<uint32_t>(packed[i] >> 32);
+        }
+    }
+
+    void MergeStats(HostHighKeyStats& total, const HostHighKeyStats& part)
+    {
+        total.countAbove += part.countAbove;
+        total.minHigh = part.minHigh < total.minHigh ? part.minHigh : total.minHigh;
+        total.maxHigh = part.maxHigh > total.maxHigh ? part.maxHigh : total.maxHigh;
+    }
+
+    template <bool Split>
+    HostHighKeyStats ScanKeysScalar(size_t begin, size_t end, uint32_t threshold, const uint32_t* high,
+        const uint64_t* packed)
+    {
+        HostHighKeyStats stats = { 0, ~0u, 0 };
+        for (size_t i = begin; i < end; i++)
+        {
+            const uint32_t key = Split ? high[i] : static_cast<uint32_t>(packed[i] >> 32);
+            stats.countAbove += key > threshold ? 1 : 0;
+            stats.minHigh = key < stats.minHigh ? key : stats.minHigh;
+            stats.maxHigh = key > stats.maxHigh ? key : stats.maxHigh;
+        }
+        return stats;
+    }
+
+    // Scans the high keys of [begin, end), read from the high plane when Split
+    // is set and from the packed texels otherwise.
+    template <bool Split>
+    HostHighKeyStats ScanKeys(size_t begin, size_t end, uint32_t threshold, const uint32_t* high,
+        const uint64_t* packed)
+    {
+        size_t i = begin;
+        HostHighKeyStats stats = { 0, ~0u, 0 };
+#ifdef HOST_ATOMICS_X86
+        // SSE2 only has signed 32-bit compares, so keys are biased by 2^31.
+        // Four keys per step; lanes are folded into stats at the end.
+        const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+        const __m128i limit = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(threshold)), bias);
+        __m128i count = _mm_setzero_si128();
+        __m128i minKey = _mm_set1_epi32(0x7FFFFFFF);
+        __m128i maxKey = _mm_set1_epi32(static_cast<int>(0x80000000u));
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128i keys;
+            if (Split)
+            {
+                keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(high + i));
+            }
+            else
+            {
+                const __m128i a = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(packed + i)), _MM_SHUFFLE(3, 1, 2, 0));
+                const __m128i b = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(packed + i + 2)), _MM_SHUFFLE(3, 1, 2, 0));
+                keys = _mm_unpackhi_epi64(a, b);
+            }
+            keys = _mm_xor_si128(keys, bias);
+            count = _mm_sub_epi32(count, _mm_cmpgt_epi32(keys, limit));
+            const __m128i below = _mm_cmplt_epi32(keys, minKey);
+            minKey = _mm_or_si128(_mm_and_si128(below, keys), _mm_andnot_si128(below, minKey));
+            const __m128i above = _mm_cmpgt_epi32(keys, maxKey);
+            maxKey = _mm_or_si128(_mm_and_si128(above, keys), _mm_andnot_si128(above, maxKey));
+        }
+
+        uint32_t counts[4];
+        uint32_t mins[4];
+        uint32_t maxs[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(counts), count);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(mins), _mm_xor_si128(minKey, bias));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(maxs), _mm_xor_si128(maxKey, bias));
+        for (uint32_t lane = 0; lane < 4; lane++)
+        {
+            MergeStats(stats, HostHighKeyStats{ counts[lane], mins[lane], maxs[lane] });
+        }
+#endif
+        MergeStats(stats, ScanKeysScalar<Split>(i, end, threshold, high, packed));
+        return stats;
+    }
+
+    // Scans worker ranges with scan(begin, end) and merges the results.
+    template <typename Scan>
+    HostHighKeyStats ParallelScan(size_t count, uint32_t workerCount, Scan scan)
+    {
+        workerCount = ResolveWorkers(workerCount);
+        std::vector<HostHighKeyStats> parts(workerCount, HostHighKeyStats{ 0, ~0u, 0 });
+        HostParallelRanges(count, workerCount, [&](uint32_t worker, size_t begin, size_t end)
+        {
+            parts[worker] = scan(begin, end);
+        });
+
+        HostHighKeyStats total = { 0, ~0u, 0 };
+        for (const HostHighKeyStats& part : parts)
+        {
+            MergeStats(total, part);
+        }
+        return total;
+    }
+}
+
+HostSplitSurface64::HostSplitSurface64(uint32_t width, uint32_t height) :
+    m_width(width),
+    m_height(height)
+{
+    if (width == 0 || height == 0)
+    {
+        throw std::invalid_argument("HostSplitSurface64: empty surface");
+    }
+    const size_t count = static_cast<size_t>(width) * height;
+    m_low.reset(new uint32_t[count]());
+    m_high.reset(new uint32_t[count]());
+}
+
+void HostSplitSurface64::Clear(uint64_t value)
+{
+    const size_t count = static_cast<size_t>(m_width) * m_height;
+    const uint32_t low = static_cast<uint32_t>(value);
+    const uint32_t high = static_cast<uint32_t>(value >> 32);
+    for (size_t i = 0; i < count; i++)
+    {
+        m_low[i] = low;
+        m_high[i] = high;
+    }
+}
+
+uint64_t HostSplitSurface64::Apply(HostAtomicOp op, uint32_t x, uint32_t y, uint64_t value, uint64_t xchgValue)
+{
+    const uint64_t current = Load(x, y);
+    uint64_t next;
+    if (op == HostAtomicOp::CompareExchange)
+    {
+        next = current == value ? xchgValue : current;
+    }
+    else
+    {
+        next = HostAtomicCombine(op, current, value);
+    }
+    if (next != current)
+    {
+        Store(x, y, next);
+    }
+    return current;
+}
+
+void HostSplitSurface64::Resolve(const uint64_t* packed, size_t rowPitch, uint32_t workerCount)
+{
+    HostParallelRanges(m_height, ResolveWorkers(workerCount), [&](uint32_t, size_t begin, size_t end)
+    {
+        for (size_t y = begin; y < end; y++)
+        {
+            const size_t row = y * m_width;
+            SplitRow(packed + y * rowPitch, m_low.get() + row, m_high.get() + row, m_width);
+        }
+    });
+}
+
+void HostSplitSurface64::Resolve(const HostAtomicSurface64& shadow, uint32_t workerCount)
+{
+    if (shadow.GetWidth() != m_width || shadow.GetHeight() != m_height)
+    {
+        throw std::invalid_argument("HostSplitSurface64: shadow size mismatch");
+    }
+    HostParallelRanges(m_height, ResolveWorkers(workerCount), [&](uint32_t, size_t begin, size_t end)
+    {
+        for (uint32_t y = static_cast<uint32_t>(begin); y < end; y++)
+        {
+            for (uint32_t x = 0; x < m_width; x++)
+            {
+                Store(x, y, shadow.Load(x, y));
+            }
+        }
+    });
+}
+
+void HostSplitSurface64::Pack(uint64_t* packed, size_t rowPitch) const
+{
+    for (uint32_t y = 0; y < m_height; y++)
+    {
+        const size_t row = static_cast<size_t>(y) * m_width;
+        for (uint32_t x = 0; x < m_width; x++)
+        {
+            packed[y * rowPitch + x] = (static_cast<uint64_t>(m_high[row + x]) << 32) | m_low[row + x];
+        }
+    }
+}
+
+HostHighKeyStats HostSplitSurface64::ScanHighKeys(uint32_t threshold, uint32_t workerCount) const
+{
+    const uint32_t* high = m_high.get();
+    return ParallelScan(static_cast<size_t>(m_width) * m_height, workerCount, [=](size_t begin, size_t end)
+    {
+        return ScanKeys<true>(begin, end, threshold, high, nullptr);
+    });
+}
+
+HostHighKeyStats HostScanHighKeysPacked(const uint64_t* packed, size_t count, uint32_t threshold, uint32_t workerCount)
+{
+    return ParallelScan(count, workerCount, [=](size_t begin, size_t end)
+    {
+        return ScanKeys<false>(begin, end, threshold, nullptr, packed);
+    });
+}
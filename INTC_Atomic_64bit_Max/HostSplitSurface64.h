@@ -0,0 +1,79 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Structure-of-arrays layout for 64-bit texels: the low and high 32 bits live
+// in separate planes instead of interleaved as in the R32G32_UINT surface.
+// Scans that only look at the high key (depth in depth+ID packing, say) then
+// read half the bytes. The planes are plain memory meant for analysis:
+// atomics run on a packed shadow (HostAtomicSurface64 or a readback buffer)
+// that Resolve splits into the planes, or, for writers that own their texels
+// (partitioned batches), through the paired non-atomic Apply.
+
+#pragma once
+
+#include "HostAtomics64.h"
+
+#include <memory>
+
+// Result of a high-key scan.
+struct HostHighKeyStats
+{
+    uint64_t countAbove;    // Texels whose high key is greater than the threshold.
+    uint32_t minHigh;
+    uint32_t maxHigh;
+};
+
+class HostSplitSurface64
+{
+public:
+    HostSplitSurface64(uint32_t width, uint32_t height);
+
+    uint32_t GetWidth() const               { return m_width; }
+    uint32_t GetHeight() const              { return m_height; }
+    const uint32_t* GetLowPlane() const     { return m_low.get(); }
+    const uint32_t* GetHighPlane() const    { return m_high.get(); }
+
+    uint64_t Load(uint32_t x, uint32_t y) const
+    {
+        const size_t index = Index(x, y);
+        return (static_cast<uint64_t>(m_high[index]) << 32) | m_low[index];
+    }
+
+    void Store(uint32_t x, uint32_t y, uint64_t value)
+    {
+        const size_t index = Index(x, y);
+        m_low[index] = static_cast<uint32_t>(value);
+        m_high[index] = static_cast<uint32_t>(value >> 32);
+    }
+
+    void Clear(uint64_t value);
+
+    // Paired update of both planes, not atomic: the caller guarantees no other
+    // thread touches the texel. Returns the previous value.
+    uint64_t Apply(HostAtomicOp op, uint32_t x, uint32_t y, uint64_t value, uint64_t xchgValue = 0);
+
+    // Splits width x height packed texels, rowPitch texels apart, into the
+    // planes, in parallel across rows. A workerCount of zero uses
+    // HostWorkerCount() threads, here and in the scans.
+    void Resolve(const uint64_t* packed, size_t rowPitch, uint32_t workerCount = 0);
+    void Resolve(const HostAtomicSurface64& shadow, uint32_t workerCount = 0);
+
+    // Interleaves the planes back into packed texels.
+    void Pack(uint64_t* packed, size_t rowPitch) const;
+
+    HostHighKeyStats ScanHighKeys(uint32_t threshold, uint32_t workerCount = 0) const;
+
+private:
+    size_t Index(uint32_t x, uint32_t y) const { return static_cast<size_t>(y) * m_width + x; }
+
+    uint32_t m_width;
+    uint32_t m_height;
+    std::unique_ptr<uint32_t[]> m_low;
+    std::unique_ptr<uint32_t[]> m_high;
+};
+
+// The same scan over packed texels, for comparison with the split layout.
+HostHighKeyStats HostScanHighKeysPacked(const uint64_t* packed, size_t count, uint32_t threshold,
+    uint32_t workerCount = 0);
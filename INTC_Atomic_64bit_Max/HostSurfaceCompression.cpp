@@ -0,0 +1,468 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostSurfaceCompression.h"
+#include "HostBits.h"
+#include "HostParallel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HOST_COMPRESS_X86 1
+#endif
+
+namespace
+{
+    static_assert(sizeof(HostCompressedSurfaceHeader) % sizeof(uint64_t) == 0, "Header must keep the directory aligned");
+    static_assert(sizeof(HostCompressedTile) % sizeof(uint64_t) == 0, "Directory must keep the payload aligned");
+
+    size_t RunLengthBytes(size_t runCount)
+    {
+        return runCount * sizeof(uint64_t) + AlignUp(runCount * sizeof(uint16_t), sizeof(uint64_t));
+    }
+
+    // Index of the first texel in [begin, count) that differs from value, or
+    // count.
+    size_t FindMismatch(const uint64_t* texels, size_t begin, size_t count, uint64_t value)
+    {
+        size_t i = begin;
+#ifdef HOST_COMPRESS_X86
+        // 64-bit lanes are equal when both 32-bit halves are (PCMPEQQ is
+        // SSE4.1). Four texels per step.
+        const __m128i pattern = _mm_set1_epi64x(static_cast<long long>(value));
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i a = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + i)), pattern);
+            const __m128i b = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + i + 2)), pattern);
+            if (_mm_movemask_epi8(_mm_and_si128(a, b)) != 0xFFFF)
+            {
+                break;
+            }
+        }
+#endif
+        while (i < count && texels[i] == value)
+        {
+            i++;
+        }
+        return i;
+    }
+
+    // Number of texels in [1, count) that differ from the texel before them.
+    size_t CountChanges(const uint64_t* texels, size_t count)
+    {
+        size_t changes = 0;
+        size_t i = 1;
+#ifdef HOST_COMPRESS_X86
+        for (; i + 2 <= count; i += 2)
+        {
+            const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + i));
+            const __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + i - 1));
+            const int equal = _mm_movemask_epi8(_mm_cmpeq_epi32(current, previous));
+            changes += ((equal & 0xFF) != 0xFF) + ((equal >> 8) != 0xFF);
+        }
+#endif
+        for (; i < count; i++)
+        {
+            changes += texels[i] != texels[i - 1];
+        }
+        return changes;
+    }
+
+    size_t PayloadBytes(const HostCompressedTile& entry, uint32_t width, uint32_t height)
+    {
+        switch (entry.encoding)
+        {
+        case HostTileEncoding::RunLength:   return RunLengthBytes(entry.runCount);
+        case HostTileEncoding::Raw:         return static_cast<size_t>(width) * height * sizeof(uint64_t);
+        default:                            return 0;
+        }
+    }
+
+    // Picks the encoding of a tile (rows pitch texels apart). data is left
+    // zero for tiles with a payload.
+    HostCompressedTile ClassifyTile(const uint64_t* tile, size_t pitch, uint32_t width, uint32_t height)
+    {
+        HostCompressedTile entry = {};
+        const uint64_t first = tile[0];
+        uint32_t y = 0;
+        while (y < height && FindMismatch(tile + y * pitch, 0, width, first) == width)
+        {
+            y++;
+        }
+        if (y == height)
+        {
+            entry.data = first;
+            entry.encoding = HostTileEncoding::Constant;
+            return entry;
+        }
+
+        // Counting stops once runs would take more space than raw texels.
+        const size_t rawBytes = static_cast<size_t>(width) * height * sizeof(uint64_t);
+        size_t runCount = 1;
+        for (y = 0; y < height && RunLengthBytes(runCount) < rawBytes; y++)
+        {
+            const uint64_t* row = tile + y * pitch;
+            runCount += CountChanges(row, width) + (y > 0 && row[0] != row[-static_cast<ptrdiff_t>(pitch) + width - 1]);
+        }
+        if (RunLengthBytes(runCount) >= rawBytes)
+        {
+            entry.encoding = HostTileEncoding::Raw;
+        }
+        else
+        {
+            entry.encoding = HostTileEncoding::RunLength;
+            entry.runCount = static_cast<uint32_t>(runCount);
+        }
+        return entry;
+    }
+
+    // Writes the payload of a classified tile at payload.
+    void WriteTilePayload(const HostCompressedTile& entry, const uint64_t* tile, size_t pitch, uint32_t width, uint32_t height,
+        uint8_t* payload)
+    {
+        if (entry.encoding == HostTileEncoding::Raw)
+        {
+            uint64_t* raw = reinterpret_cast<uint64_t*>(payload);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                memcpy(raw + static_cast<size_t>(y) * width, tile + y * pitch, width * sizeof(uint64_t));
+            }
+            return;
+        }
+        if (entry.encoding != HostTileEncoding::RunLength)
+        {
+            return;
+        }
+
+        uint64_t* values = reinterpret_cast<uint64_t*>(payload);
+        uint16_t* lengths = reinterpret_cast<uint16_t*>(values + entry.runCount);
+        memset(lengths, 0, RunLengthBytes(entry.runCount) - entry.runCount * sizeof(uint64_t));
+
+        // Runs continue across rows; a run ends where FindMismatch stops
+        // inside a row.
+        size_t run = 0;
+        uint64_t value = tile[0];
+        size_t length = 0;
+        for (uint32_t y = 0; y < height; y++)
+        {
+            const uint64_t* row = tile + y * pitch;
+            size_t x = 0;
+            while (x < width)
+            {
+                const size_t end = FindMismatch(row, x, width, value);
+                length += end - x;
+                x = end;
+                if (x < width)
+                {
+                    values[run] = value;
+                    lengths[run] = static_cast<uint16_t>(length);
+                    run++;
+                    value = row[x];
+                    length = 0;
+                }
+            }
+        }
+        values[run] = value;
+        lengths[run] = static_cast<uint16_t>(length);
+    }
+
+    void FillRow(uint64_t* row, size_t count, uint64_t value)
+    {
+        std::fill(row, row + count, value);
+    }
+}
+
+HostCompressionStats HostCompressSurface(std::vector<uint8_t>& stream, const uint64_t* texels, size_t rowPitch,
+    uint32_t width, uint32_t height, uint32_t tileSize, uint32_t workerCount)
+{
+    if (width == 0 || height == 0)
+    {
+        throw std::invalid_argument("HostCompressSurface: empty surface");
+    }
+    if (tileSize == 0 || tileSize > HostMaxCompressionTileSize)
+    {
+        throw std::invalid_argument("HostCompressSurface: tile size out of range");
+    }
+
+    HostCompressedSurfaceHeader header = {};
+    header.magic = HostCompressedSurfaceMagic;
+    header.version = HostCompressedSurfaceVersion;
+    header.width = width;
+    header.height = height;
+    header.tileSize = tileSize;
+    header.tilesX = (width + tileSize - 1) / tileSize;
+    header.tilesY = (height + tileSize - 1) / tileSize;
+
+    const size_t rowBytes = static_cast<size_t>(width) * sizeof(uint64_t);
+    workerCount = HostWorkersForBytes(rowBytes * height, workerCount);
+
+    // Two parallel passes over bands of tile rows: the first picks every
+    // tile's encoding and payload size, the second writes the payloads at
+    // their final offsets, so the stream is sized once and no payload is
+    // copied. A stream reused across frames keeps its capacity.
+    const size_t tileCount = static_cast<size_t>(header.tilesX) * header.tilesY;
+    std::vector<HostCompressedTile> tiles(tileCount);
+    std::vector<uint64_t> bandBytes(workerCount, 0);
+    HostParallelRanges(header.tilesY, workerCount, [&](uint32_t worker, size_t beginTileRow, size_t endTileRow)
+    {
+        uint64_t used = 0;
+        for (size_t tileY = beginTileRow; tileY < endTileRow; tileY++)
+        {
+            const uint32_t top = static_cast<uint32_t>(tileY) * tileSize;
+            const uint32_t tileHeight = std::min(tileSize, height - top);
+            for (uint32_t tileX = 0; tileX < header.tilesX; tileX++)
+            {
+                const uint32_t left = tileX * tileSize;
+                const uint32_t tileWidth = std::min(tileSize, width - left);
+                HostCompressedTile& entry = tiles[tileY * header.tilesX + tileX];
+                entry = ClassifyTile(texels + top * rowPitch + left, rowPitch, tileWidth, tileHeight);
+                if (entry.encoding != HostTileEncoding::Constant)
+                {
+                    entry.data = used;
+                    used += PayloadBytes(entry, tileWidth, tileHeight);
+                }
+            }
+        }
+        bandBytes[worker] = used;
+    });
+
+    std::vector<uint64_t> bandOffsets(workerCount);
+    uint64_t offset = 0;
+    for (uint32_t worker = 0; worker < workerCount; worker++)
+    {
+        bandOffsets[worker] = offset;
+        offset += bandBytes[worker];
+    }
+    header.payloadBytes = offset;
+
+    const size_t payloadStart = sizeof(header) + tileCount * sizeof(HostCompressedTile);
+    stream.resize(payloadStart + static_cast<size_t>(offset));
+    uint8_t* payload = stream.data() + payloadStart;
+    HostParallelRanges(header.tilesY, workerCount, [&](uint32_t worker, size_t beginTileRow, size_t endTileRow)
+    {
+        for (size_t tileY = beginTileRow; tileY < endTileRow; tileY++)
+        {
+            const uint32_t top = static_cast<uint32_t>(tileY) * tileSize;
+            const uint32_t tileHeight = std::min(tileSize, height - top);
+            for (uint32_t tileX = 0; tileX < header.tilesX; tileX++)
+            {
+                HostCompressedTile& entry = tiles[tileY * header.tilesX + tileX];
+                if (entry.encoding != HostTileEncoding::Constant)
+                {
+                    const uint32_t left = tileX * tileSize;
+                    entry.data += bandOffsets[worker];
+                    WriteTilePayload(entry, texels + top * rowPitch + left, rowPitch, std::min(tileSize, width - left),
+                        tileHeight, payload + entry.data);
+                }
+            }
+        }
+    });
+    memcpy(stream.data(), &header, sizeof(header));
+    memcpy(stream.data() + sizeof(header), tiles.data(), tileCount * sizeof(HostCompressedTile));
+
+    HostCompressionStats stats = {};
+    for (const HostCompressedTile& entry : tiles)
+    {
+        stats.constantTiles += entry.encoding == HostTileEncoding::Constant;
+        stats.runLengthTiles += entry.encoding == HostTileEncoding::RunLength;
+        stats.rawTiles += entry.encoding == HostTileEncoding::Raw;
+    }
+    stats.uncompressedBytes = static_cast<uint64_t>(rowBytes) * height;
+    stats.compressedBytes = stream.size();
+    return stats;
+}
+
+//
+// HostCompressedSurface
+//
+
+HostCompressedSurface::HostCompressedSurface(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    if (reinterpret_cast<uintptr_t>(bytes) % sizeof(uint64_t) != 0 || size < sizeof(m_header))
+    {
+        throw std::invalid_argument("HostCompressedSurface: misaligned or truncated stream");
+    }
+    memcpy(&m_header, bytes, sizeof(m_header));
+    const uint32_t tileSize = m_header.tileSize;
+    if (m_header.magic != HostCompressedSurfaceMagic || m_header.version != HostCompressedSurfaceVersion ||
+        m_header.width == 0 || m_header.height == 0 || tileSize == 0 || tileSize > HostMaxCompressionTileSize ||
+        m_header.tilesX != (m_header.width + tileSize - 1) / tileSize ||
+        m_header.tilesY != (m_header.height + tileSize - 1) / tileSize)
+    {
+        throw std::invalid_argument("HostCompressedSurface: bad header");
+    }
+
+    const uint64_t directoryBytes = static_cast<uint64_t>(GetTileCount()) * sizeof(HostCompressedTile);
+    if (size - sizeof(m_header) < directoryBytes || size - sizeof(m_header) - directoryBytes < m_header.payloadBytes)
+    {
+        throw std::invalid_argument("HostCompressedSurface: truncated stream");
+    }
+    m_tiles = reinterpret_cast<const HostCompressedTile*>(bytes + sizeof(m_header));
+    m_payload = bytes + sizeof(m_header) + directoryBytes;
+
+    for (uint32_t tile = 0; tile < GetTileCount(); tile++)
+    {
+        const HostCompressedTile& entry = m_tiles[tile];
+        if (entry.encoding == HostTileEncoding::Constant)
+        {
+            continue;
+        }
+        uint32_t left;
+        uint32_t top;
+        uint32_t width;
+        uint32_t height;
+        GetTileRect(tile, left, top, width, height);
+        const uint64_t texelCount = static_cast<uint64_t>(width) * height;
+
+        uint64_t tileBytes = 0;
+        if (entry.encoding == HostTileEncoding::RunLength)
+        {
+            tileBytes = entry.runCount == 0 || entry.runCount > texelCount ? ~0ull : RunLengthBytes(entry.runCount);
+        }
+        else if (entry.encoding == HostTileEncoding::Raw)
+        {
+            tileBytes = texelCount * sizeof(uint64_t);
+        }
+        if (entry.encoding > HostTileEncoding::Raw || entry.data % sizeof(uint64_t) != 0 ||
+            entry.data > m_header.payloadBytes || m_header.payloadBytes - entry.data < tileBytes)
+        {
+            throw std::invalid_argument("HostCompressedSurface: bad tile");
+        }
+
+        // Run lengths must cover the tile exactly for decoding to stay in it.
+        if (entry.encoding == HostTileEncoding::RunLength)
+        {
+            const uint64_t* values = reinterpret_cast<const uint64_t*>(m_payload + entry.data);
+            const uint16_t* lengths = reinterpret_cast<const uint16_t*>(values + entry.runCount);
+            uint64_t covered = 0;
+            for (uint32_t run = 0; run < entry.runCount; run++)
+            {
+                covered += lengths[run];
+            }
+            if (covered != texelCount)
+            {
+                throw std::invalid_argument("HostCompressedSurface: bad tile");
+            }
+        }
+    }
+}
+
+void HostCompressedSurface::GetTileRect(uint32_t tile, uint32_t& left, uint32_t& top, uint32_t& width, uint32_t& height) const
+{
+    const uint32_t tileSize = m_header.tileSize;
+    left = (tile % m_header.tilesX) * tileSize;
+    top = (tile / m_header.tilesX) * tileSize;
+    width = std::min(tileSize, m_header.width - left);
+    height = std::min(tileSize, m_header.height - top);
+}
+
+void HostCompressedSurface::DecodeTile(uint32_t tile, uint64_t* destination, size_t destinationPitch) const
+{
+    uint32_t left;
+    uint32_t top;
+    uint32_t width;
+    uint32_t height;
+    GetTileRect(tile, left, top, width, height);
+
+    const HostCompressedTile& entry = m_tiles[tile];
+    switch (entry.encoding)
+    {
+    case HostTileEncoding::Constant:
+        for (uint32_t y = 0; y < height; y++)
+        {
+            FillRow(destination + y * destinationPitch, width, entry.data);
+        }
+        break;
+
+    case HostTileEncoding::RunLength:
+    {
+        const uint64_t* values = reinterpret_cast<const uint64_t*>(m_payload + entry.data);
+        const uint16_t* lengths = reinterpret_cast<const uint16_t*>(values + entry.runCount);
+        uint32_t x = 0;
+        uint32_t y = 0;
+        for (uint32_t run = 0; run < entry.runCount; run++)
+        {
+            // Split the run at row ends.
+            size_t remaining = lengths[run];
+            while (remaining > 0)
+            {
+                const size_t count = std::min<size_t>(remaining, width - x);
+                FillRow(destination + y * destinationPitch + x, count, values[run]);
+                remaining -= count;
+                x += static_cast<uint32_t>(count);
+                if (x == width)
+                {
+                    x = 0;
+                    y++;
+                }
+            }
+        }
+        break;
+    }
+
+    case HostTileEncoding::Raw:
+    {
+        const uint64_t* raw = reinterpret_cast<const uint64_t*>(m_payload + entry.data);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            memcpy(destination + y * destinationPitch, raw + static_cast<size_t>(y) * width, width * sizeof(uint64_t));
+        }
+        break;
+    }
+    }
+}
+
+void HostCompressedSurface::Decode(uint64_t* texels, size_t rowPitch, uint32_t workerCount) const
+{
+    workerCount = HostWorkersForBytes(static_cast<size_t>(m_header.width) * m_header.height * sizeof(uint64_t), workerCount);
+
+    const uint32_t tilesX = m_header.tilesX;
+    const uint32_t tileSize = m_header.tileSize;
+    HostParallelRanges(m_header.tilesY, workerCount, [&](uint32_t, size_t beginTileRow, size_t endTileRow)
+    {
+        for (size_t tile = beginTileRow * tilesX; tile < endTileRow * tilesX; tile++)
+        {
+            const size_t left = (tile % tilesX) * tileSize;
+            const size_t top = (tile / tilesX) * tileSize;
+            DecodeTile(static_cast<uint32_t>(tile), texels + top * rowPitch + left, rowPitch);
+        }
+    });
+}
+
+uint64_t HostCompressedSurface::Load(uint32_t x, uint32_t y) const
+{
+    const uint32_t tileSize = m_header.tileSize;
+    const uint32_t tile = (y / tileSize) * m_header.tilesX + x / tileSize;
+    const HostCompressedTile& entry = m_tiles[tile];
+    if (entry.encoding == HostTileEncoding::Constant)
+    {
+        return entry.data;
+    }
+
+    uint32_t left;
+    uint32_t top;
+    uint32_t width;
+    uint32_t height;
+    GetTileRect(tile, left, top, width, height);
+    const size_t index = static_cast<size_t>(y - top) * width + (x - left);
+    const uint64_t* values = reinterpret_cast<const uint64_t*>(m_payload + entry.data);
+    if (entry.encoding == HostTileEncoding::Raw)
+    {
+        return values[index];
+    }
+
+    const uint16_t* lengths = reinterpret_cast<const uint16_t*>(values + entry.runCount);
+    size_t end = 0;
+    uint32_t run = 0;
+    while ((end += lengths[run]) <= index)
+    {
+        run++;
+    }
+    return values[run];
+}
@@ -0,0 +1,117 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Lossless snapshots of 64-bit surfaces that are mostly uniform, such as the
+// sample's output of all-ones and zero texels. The surface is cut into square
+// tiles and each tile is stored the cheapest of three ways:
+//
+//   Constant   every texel has one value, kept in the tile directory;
+//   RunLength  runs of equal texels in row-major tile order;
+//   Raw        the tile's texels, row by row.
+//
+// A compressed surface is one self-contained byte stream, ready to store or
+// transfer:
+//
+//   [ HostCompressedSurfaceHeader ]
+//   [ HostCompressedTile per tile, row-major ]
+//   [ payload: run-length and raw tiles, 8-byte aligned ]
+//
+// A run-length payload holds runCount uint64_t values, then runCount uint16_t
+// lengths padded to 8 bytes. The encoder uses SSE2 on x86 to find runs and
+// uniform tiles, and runs in parallel over rows of tiles. Any tile, or any
+// texel, decodes without touching the others.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const uint32_t HostCompressedSurfaceMagic = 0x34365343;    // "CS64".
+const uint32_t HostCompressedSurfaceVersion = 1;
+
+// Tiles hold at most 65536 texels, so a run that is not the whole tile fits
+// a uint16_t length.
+const uint32_t HostMaxCompressionTileSize = 256;
+
+enum class HostTileEncoding : uint32_t
+{
+    Constant,
+    RunLength,
+    Raw,
+};
+
+struct HostCompressedSurfaceHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t tileSize;
+    uint32_t tilesX;
+    uint32_t tilesY;
+    uint32_t reserved;
+    uint64_t payloadBytes;
+};
+
+struct HostCompressedTile
+{
+    uint64_t data;              // The value of a constant tile, otherwise the payload offset.
+    HostTileEncoding encoding;
+    uint32_t runCount;          // RunLength only.
+};
+
+struct HostCompressionStats
+{
+    uint64_t constantTiles;
+    uint64_t runLengthTiles;
+    uint64_t rawTiles;
+    uint64_t uncompressedBytes;     // width * height * 8.
+    uint64_t compressedBytes;       // Size of the stream.
+};
+
+// Replaces stream with width x height texels, rowPitch texels apart, in
+// tileSize x tileSize tiles. A workerCount of zero uses HostWorkerCount()
+// threads. Throws std::invalid_argument for an empty surface or a tile size
+// outside [1, HostMaxCompressionTileSize].
+HostCompressionStats HostCompressSurface(std::vector<uint8_t>& stream, const uint64_t* texels, size_t rowPitch,
+    uint32_t width, uint32_t height, uint32_t tileSize = 32, uint32_t workerCount = 0);
+
+// Read-only view of a compressed stream, which must stay alive and be 8-byte
+// aligned (as vector and mapped memory are).
+class HostCompressedSurface
+{
+public:
+    // Checks the header and that every tile lies within size bytes. Throws
+    // std::invalid_argument for a stream that fails the checks.
+    HostCompressedSurface(const void* data, size_t size);
+
+    uint32_t GetWidth() const       { return m_header.width; }
+    uint32_t GetHeight() const      { return m_header.height; }
+    uint32_t GetTileSize() const    { return m_header.tileSize; }
+    uint32_t GetTilesX() const      { return m_header.tilesX; }
+    uint32_t GetTilesY() const      { return m_header.tilesY; }
+    uint32_t GetTileCount() const   { return m_header.tilesX * m_header.tilesY; }
+
+    const HostCompressedTile& GetTile(uint32_t tile) const { return m_tiles[tile]; }
+
+    // Clipped to the surface.
+    void GetTileRect(uint32_t tile, uint32_t& left, uint32_t& top, uint32_t& width, uint32_t& height) const;
+
+    // Writes the tile's texels with its top-left at destination, rows
+    // destinationPitch texels apart.
+    void DecodeTile(uint32_t tile, uint64_t* destination, size_t destinationPitch) const;
+
+    // Writes the whole surface, rowPitch texels apart. A workerCount of zero
+    // uses HostWorkerCount() threads.
+    void Decode(uint64_t* texels, size_t rowPitch, uint32_t workerCount = 0) const;
+
+    uint64_t Load(uint32_t x, uint32_t y) const;
+
+private:
+    HostCompressedSurfaceHeader m_header;
+    const HostCompressedTile* m_tiles;
+    const uint8_t* m_payload;
+};
@@ -0,0 +1,269 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostSurfaceDiff.h"
+#include "HostParallel.h"
+
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HOST_DIFF_X86 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    const uint64_t SignBit = 0x8000000000000000ull;
+    const uint64_t PositiveInfinity = 0x7FF0000000000000ull;
+
+    inline uint32_t PopCount(uint64_t bits)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        return static_cast<uint32_t>(__popcnt64(bits));
+#elif defined(__GNUC__)
+        return static_cast<uint32_t>(__builtin_popcountll(bits));
+#else
+        uint32_t count = 0;
+        for (; bits != 0; bits &= bits - 1)
+        {
+            count++;
+        }
+        return count;
+#endif
+    }
+
+    inline uint32_t LowestBit(uint64_t bits)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long bit;
+        _BitScanForward64(&bit, bits);
+        return bit;
+#elif defined(__GNUC__)
+        return static_cast<uint32_t>(__builtin_ctzll(bits));
+#else
+        uint32_t bit = 0;
+        while ((bits & 1) == 0)
+        {
+            bits >>= 1;
+            bit++;
+        }
+        return bit;
+#endif
+    }
+
+    // Maps double bits to integers in the same order as the doubles, with
+    // -0 and +0 one apart.
+    inline uint64_t OrderDouble(uint64_t bits)
+    {
+        return (bits & SignBit) != 0 ? ~bits : bits | SignBit;
+    }
+
+    inline bool IsNaN(uint64_t orderedBits)
+    {
+        const uint64_t magnitude = ((orderedBits & SignBit) != 0 ? orderedBits : ~orderedBits) & ~SignBit;
+        return magnitude > PositiveInfinity;
+    }
+
+    // Bit i is set where (actual[i] ^ golden[i]) & bitMask is non-zero, for
+    // i below count (at most 64).
+    uint64_t DifferingBits(const uint64_t* actual, const uint64_t* golden, uint32_t count, uint64_t bitMask)
+    {
+        uint32_t i = 0;
+        uint64_t bits = 0;
+#ifdef HOST_DIFF_X86
+        // Most spans match: OR the differences together first and only
+        // sort out which texels differ when something does. 64-bit lanes
+        // are zero when both 32-bit halves are (PCMPEQQ is SSE4.1).
+        const __m128i mask = _mm_set1_epi64x(static_cast<long long>(bitMask));
+        const __m128i zero = _mm_setzero_si128();
+        __m128i any = zero;
+        const uint32_t vectorCount = count & ~3u;
+        for (; i < vectorCount; i += 4)
+        {
+            const __m128i a = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(actual + i)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(golden + i)));
+            const __m128i b = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(actual + i + 2)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(golden + i + 2)));
+            any = _mm_or_si128(any, _mm_and_si128(_mm_or_si128(a, b), mask));
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(any, zero)) != 0xFFFF)
+        {
+            for (i = 0; i < vectorCount; i += 2)
+            {
+                const __m128i difference = _mm_and_si128(mask, _mm_xor_si128(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(actual + i)),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(golden + i))));
+                const int equal = _mm_movemask_epi8(_mm_cmpeq_epi32(difference, zero));
+                bits |= static_cast<uint64_t>(((equal & 0xFF) != 0xFF) | (((equal >> 8) != 0xFF) << 1)) << i;
+            }
+        }
+#endif
+        for (; i < count; i++)
+        {
+            bits |= static_cast<uint64_t>(((actual[i] ^ golden[i]) & bitMask) != 0) << i;
+        }
+        return bits;
+    }
+
+    // Bit i is set where region[i] is non-zero, for i below count.
+    uint64_t RegionBits(const uint8_t* region, uint32_t count)
+    {
+        uint32_t i = 0;
+        uint64_t bits = 0;
+#ifdef HOST_DIFF_X86
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= count; i += 16)
+        {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(region + i));
+            bits |= static_cast<uint64_t>(~_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero)) & 0xFFFF) << i;
+        }
+#endif
+        for (; i < count; i++)
+        {
+            bits |= static_cast<uint64_t>(region[i] != 0) << i;
+        }
+        return bits;
+    }
+
+    // Clears the bits of texels within tolerance, and raises maxDistance.
+    uint64_t ApplyUlpTolerance(uint64_t bits, const uint64_t* actual, const uint64_t* golden,
+        bool ordered, uint64_t tolerance, uint64_t& maxDistance)
+    {
+        for (uint64_t pending = bits; pending != 0; pending &= pending - 1)
+        {
+            const uint32_t i = LowestBit(pending);
+            const uint64_t a = ordered ? actual[i] : OrderDouble(actual[i]);
+            const uint64_t b = ordered ? golden[i] : OrderDouble(golden[i]);
+            uint64_t distance = a > b ? a - b : b - a;
+            if (IsNaN(a) || IsNaN(b))
+            {
+                distance = ~0ull;
+            }
+            maxDistance = distance > maxDistance ? distance : maxDistance;
+            if (distance <= tolerance)
+            {
+                bits &= ~(1ull << i);
+            }
+        }
+        return bits;
+    }
+
+    struct Partial
+    {
+        uint64_t mismatchCount;
+        uint64_t maxUlpDistance;
+        std::vector<HostDiffMismatch> mismatches;
+    };
+}
+
+void HostDiffSurfaces(HostSurfaceDiff& result, const uint64_t* actual, size_t actualPitch,
+    const uint64_t* golden, size_t goldenPitch, uint32_t width, uint32_t height,
+    const HostDiffOptions& options, uint32_t workerCount)
+{
+    if (width == 0 || height == 0)
+    {
+        throw std::invalid_argument("HostDiffSurfaces: empty surface");
+    }
+    if (options.tileSize == 0)
+    {
+        throw std::invalid_argument("HostDiffSurfaces: zero tile size");
+    }
+
+    const uint32_t tileSize = options.tileSize;
+    result.width = width;
+    result.height = height;
+    result.mismatchCount = 0;
+    result.maxUlpDistance = 0;
+    result.bitmapPitch = (width + 63) / 64;
+    result.bitmap.resize(result.bitmapPitch * height);
+    result.tileSize = tileSize;
+    result.tilesX = static_cast<uint32_t>((static_cast<uint64_t>(width) + tileSize - 1) / tileSize);
+    result.tilesY = static_cast<uint32_t>((static_cast<uint64_t>(height) + tileSize - 1) / tileSize);
+    result.tileMismatches.resize(static_cast<size_t>(result.tilesX) * result.tilesY);
+    result.mismatches.clear();
+
+    workerCount = HostWorkersForBytes(static_cast<size_t>(width) * height * 2 * sizeof(uint64_t), workerCount);
+
+    const bool ulp = options.mode == HostDiffMode::DoubleUlp || options.mode == HostDiffMode::OrderedUlp;
+    const uint64_t bitMask = options.mode == HostDiffMode::Masked ? options.bitMask : ~0ull;
+
+    // Whole tile rows per worker, so every tile count and bitmap word has
+    // one writer, and each worker's mismatches follow the previous worker's.
+    std::vector<Partial> partials(workerCount, Partial{ 0, 0, {} });
+    HostParallelRanges(result.tilesY, workerCount, [&](uint32_t worker, size_t beginTileRow, size_t endTileRow)
+    {
+        Partial& partial = partials[worker];
+        for (size_t tileY = beginTileRow; tileY < endTileRow; tileY++)
+        {
+            uint64_t* tiles = &result.tileMismatches[tileY * result.tilesX];
+            for (uint32_t tileX = 0; tileX < result.tilesX; tileX++)
+            {
+                tiles[tileX] = 0;
+            }
+
+            const uint32_t beginRow = static_cast<uint32_t>(tileY) * tileSize;
+            const uint32_t endRow = height - beginRow < tileSize ? height : beginRow + tileSize;
+            for (uint32_t y = beginRow; y < endRow; y++)
+            {
+                const uint64_t* actualRow = actual + y * actualPitch;
+                const uint64_t* goldenRow = golden + y * goldenPitch;
+                const uint8_t* regionRow = options.region != nullptr ? options.region + y * options.regionPitch : nullptr;
+                uint64_t* bitmapRow = &result.bitmap[y * result.bitmapPitch];
+
+                for (size_t word = 0; word < result.bitmapPitch; word++)
+                {
+                    const uint32_t left = static_cast<uint32_t>(word * 64);
+                    const uint32_t count = width - left < 64 ? width - left : 64;
+                    uint64_t bits = DifferingBits(actualRow + left, goldenRow + left, count, bitMask);
+                    if (bits != 0 && regionRow != nullptr)
+                    {
+                        bits &= RegionBits(regionRow + left, count);
+                    }
+                    if (bits != 0 && ulp)
+                    {
+                        bits = ApplyUlpTolerance(bits, actualRow + left, goldenRow + left,
+                            options.mode == HostDiffMode::OrderedUlp, options.ulpTolerance, partial.maxUlpDistance);
+                    }
+                    bitmapRow[word] = bits;
+                    if (bits == 0)
+                    {
+                        continue;
+                    }
+
+                    partial.mismatchCount += PopCount(bits);
+
+                    // Split the word at tile boundaries.
+                    for (uint64_t tileLeft = left - left % tileSize; tileLeft < left + count; tileLeft += tileSize)
+                    {
+                        const uint64_t begin = tileLeft > left ? tileLeft - left : 0;
+                        const uint64_t end = tileLeft + tileSize - left < count ? tileLeft + tileSize - left : count;
+                        const uint64_t span = (end - begin == 64 ? ~0ull : ((1ull << (end - begin)) - 1)) << begin;
+                        tiles[tileLeft / tileSize] += PopCount(bits & span);
+                    }
+
+                    for (uint64_t pending = bits; pending != 0 && partial.mismatches.size() < options.maxMismatches; pending &= pending - 1)
+                    {
+                        const uint32_t x = left + LowestBit(pending);
+                        partial.mismatches.push_back({ x, y, actualRow[x], goldenRow[x] });
+                    }
+                }
+            }
+        }
+    });
+
+    for (const Partial& partial : partials)
+    {
+        result.mismatchCount += partial.mismatchCount;
+        result.maxUlpDistance = partial.maxUlpDistance > result.maxUlpDistance ? partial.maxUlpDistance : result.maxUlpDistance;
+        for (size_t i = 0; i < partial.mismatches.size() && result.mismatches.size() < options.maxMismatches; i++)
+        {
+            result.mismatches.push_back(partial.mismatches[i]);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Golden-image comparison of 64-bit surfaces. A captured surface is checked
+// texel by texel against a stored golden (a HostSurfaceDump record, say) in
+// one of four ways:
+//
+//   Exact       the 64 bits must match;
+//   Masked      only the bits in bitMask must match, e.g. the high word of
+//               a value packed with an ID;
+//   DoubleUlp   the texels are IEEE-754 doubles and may be up to
+//               ulpTolerance representable values apart;
+//   OrderedUlp  the same for doubles in the order-preserving integer
+//               encoding used to take float maxima with integer atomics.
+//
+// NaNs match only themselves, bit for bit. An optional region mask, one byte
+// per texel, restricts the comparison to texels whose byte is non-zero.
+//
+// The result is a one-bit-per-texel diff bitmap, per-tile mismatch counts
+// and the first mismatches in row-major order. Identical spans are skipped
+// four texels per SSE2 step, and the work is split across workers by rows of
+// tiles, so a diff runs at memory bandwidth.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class HostDiffMode : uint32_t
+{
+    Exact,
+    Masked,
+    DoubleUlp,
+    OrderedUlp,
+};
+
+struct HostDiffOptions
+{
+    HostDiffMode mode = HostDiffMode::Exact;
+
+    uint64_t bitMask = ~0ull;       // Masked.
+    uint64_t ulpTolerance = 0;      // DoubleUlp and OrderedUlp.
+
+    // Texels whose byte is zero are skipped; nullptr compares every texel.
+    const uint8_t* region = nullptr;
+    size_t regionPitch = 0;
+
+    uint32_t tileSize = 32;
+    uint32_t maxMismatches = 16;    // Mismatches listed in full.
+};
+
+struct HostDiffMismatch
+{
+    uint32_t x;
+    uint32_t y;
+    uint64_t actual;
+    uint64_t golden;
+};
+
+struct HostSurfaceDiff
+{
+    uint32_t width;
+    uint32_t height;
+    uint64_t mismatchCount;
+
+    // Largest distance between compared texels in the ULP modes, including
+    // those within tolerance; ~0 when a NaN differs.
+    uint64_t maxUlpDistance;
+
+    // Bit x % 64 of word y * bitmapPitch + x / 64 is set for a mismatch.
+    size_t bitmapPitch;
+    std::vector<uint64_t> bitmap;
+
+    uint32_t tileSize;
+    uint32_t tilesX;
+    uint32_t tilesY;
+    std::vector<uint64_t> tileMismatches;   // Row-major.
+
+    std::vector<HostDiffMismatch> mismatches;   // The first maxMismatches, row-major.
+
+    bool IsMismatch(uint32_t x, uint32_t y) const
+    {
+        return (bitmap[y * bitmapPitch + x / 64] >> (x % 64)) & 1;
+    }
+};
+
+// Compares width x height texels of actual and golden, actualPitch and
+// goldenPitch texels apart, into result, reusing its storage. A workerCount
+// of zero uses HostWorkerCount() threads. Throws std::invalid_argument for an
+// empty surface or a zero tile size.
+void HostDiffSurfaces(HostSurfaceDiff& result, const uint64_t* actual, size_t actualPitch,
+    const uint64_t* golden, size_t goldenPitch, uint32_t width, uint32_t height,
+    const HostDiffOptions& options, uint32_t workerCount = 0);
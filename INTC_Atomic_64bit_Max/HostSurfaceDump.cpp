@@ -0,0 +1,384 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostSurfaceDump.h"
+#include "HostBits.h"
+#include "HostReadbackCopy.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    static_assert(sizeof(HostSurfaceDumpHeader) <= HostSurfaceDumpAlignment, "Dump header must fit its block");
+
+    // Each Open* returns an invalid handle when the file cannot be opened,
+    // and first tries unbuffered I/O, which not every file system supports.
+    // Unbuffered writes need sector-aligned buffers, sizes and offsets, which
+    // HostSurfaceDumpAlignment covers.
+#ifdef _WIN32
+    // Keeps single writes within a DWORD, as a multiple of the alignment.
+    const DWORD MaxWriteBytes = 1u << 30;
+
+    HANDLE OpenForWrite(const char* path, bool& unbuffered)
+    {
+        HANDLE file = CreateFileA(path, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING, nullptr);
+        unbuffered = file != INVALID_HANDLE_VALUE;
+        if (!unbuffered)
+        {
+            file = CreateFileA(path, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        }
+        return file;
+    }
+
+    bool WriteAt(HANDLE file, const uint8_t* data, size_t size, uint64_t offset, bool& unbuffered)
+    {
+        (void)unbuffered;
+        while (size > 0)
+        {
+            const DWORD chunk = size < MaxWriteBytes ? static_cast<DWORD>(size) : MaxWriteBytes;
+            OVERLAPPED overlapped = {};
+            overlapped.Offset = static_cast<DWORD>(offset);
+            overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            DWORD written = 0;
+            if (!WriteFile(file, data, chunk, &written, &overlapped) || written == 0)
+            {
+                return false;
+            }
+            data += written;
+            size -= written;
+            offset += written;
+        }
+        return true;
+    }
+#else
+    int OpenForWrite(const char* path, bool& unbuffered)
+    {
+#ifdef O_DIRECT
+        const int file = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+        if (file >= 0)
+        {
+            unbuffered = true;
+            return file;
+        }
+#endif
+        unbuffered = false;
+        return open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+
+    bool WriteAt(int file, const uint8_t* data, size_t size, uint64_t offset, bool& unbuffered)
+    {
+        while (size > 0)
+        {
+            const ssize_t written = pwrite(file, data, size, static_cast<off_t>(offset));
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+#ifdef O_DIRECT
+            // Some file systems accept O_DIRECT at open and reject the writes.
+            if (written < 0 && errno == EINVAL && unbuffered)
+            {
+                unbuffered = false;
+                if (fcntl(file, F_SETFL, fcntl(file, F_GETFL) & ~O_DIRECT) == 0)
+                {
+                    continue;
+                }
+            }
+#endif
+            if (written <= 0)
+            {
+                return false;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+            offset += static_cast<uint64_t>(written);
+        }
+        return true;
+    }
+#endif
+}
+
+//
+// HostSurfaceDumpWriter
+//
+
+const uint32_t HostSurfaceDumpWriter::DefaultBufferCount;
+
+HostSurfaceDumpWriter::HostSurfaceDumpWriter(const char* path, uint32_t width, uint32_t height, uint32_t bufferCount) :
+    m_width(width),
+    m_height(height),
+    m_rowPitch(AlignUp(static_cast<size_t>(width) * sizeof(uint64_t), HostSurfaceDumpPitchAlignment)),
+    m_recordBytes(0),
+    m_unbuffered(false),
+    m_inFlight(0),
+    m_nextIndex(0),
+    m_stopping(false),
+    m_stats()
+{
+    if (width == 0 || height == 0 || bufferCount == 0)
+    {
+        throw std::invalid_argument("HostSurfaceDumpWriter: empty surface or no buffers");
+    }
+    m_recordBytes = HostSurfaceDumpAlignment + AlignUp(m_rowPitch * height, HostSurfaceDumpAlignment);
+
+    // Fresh arena memory is zeroed, so header and row padding stay zero.
+    m_freeBuffers.reserve(bufferCount);
+    for (uint32_t i = 0; i < bufferCount; i++)
+    {
+        m_freeBuffers.push_back(static_cast<uint8_t*>(m_arena.Allocate(m_recordBytes, HostSurfaceDumpAlignment)));
+    }
+
+    bool unbuffered = false;
+    m_file = OpenForWrite(path, unbuffered);
+    m_unbuffered = unbuffered;
+#ifdef _WIN32
+    if (m_file == INVALID_HANDLE_VALUE)
+#else
+    if (m_file < 0)
+#endif
+    {
+        throw std::runtime_error("HostSurfaceDumpWriter: cannot open " + std::string(path));
+    }
+
+    m_writer = std::thread(&HostSurfaceDumpWriter::WriterLoop, this);
+}
+
+HostSurfaceDumpWriter::~HostSurfaceDumpWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_queued.notify_one();
+    m_writer.join();
+
+#ifdef _WIN32
+    CloseHandle(m_file);
+#else
+    close(m_file);
+#endif
+}
+
+bool HostSurfaceDumpWriter::Submit(const void* texels, size_t sourcePitch, uint64_t frame, uint64_t fence, uint32_t workerCount)
+{
+    uint8_t* buffer = nullptr;
+    uint64_t index = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.submitted++;
+        if (m_freeBuffers.empty())
+        {
+            m_stats.dropped++;
+            return false;
+        }
+        buffer = m_freeBuffers.back();
+        m_freeBuffers.pop_back();
+        index = m_nextIndex++;
+    }
+
+    // The buffer belongs to this thread until it is queued.
+    HostSurfaceDumpHeader header = {};
+    header.magic = HostSurfaceDumpMagic;
+    header.version = HostSurfaceDumpVersion;
+    header.headerBytes = static_cast<uint32_t>(HostSurfaceDumpAlignment);
+    header.width = m_width;
+    header.height = m_height;
+    header.rowPitch = static_cast<uint32_t>(m_rowPitch);
+    header.frame = frame;
+    header.fence = fence;
+    header.recordBytes = m_recordBytes;
+    memcpy(buffer, &header, sizeof(header));
+    HostCopyPitchedRows(buffer + HostSurfaceDumpAlignment, m_rowPitch, texels, sourcePitch,
+        static_cast<size_t>(m_width) * sizeof(uint64_t), m_height, workerCount);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back({ buffer, index });
+    }
+    m_queued.notify_one();
+    return true;
+}
+
+void HostSurfaceDumpWriter::Flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_retired.wait(lock, [this] { return m_queue.empty() && m_inFlight == 0; });
+}
+
+HostSurfaceDumpStats HostSurfaceDumpWriter::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void HostSurfaceDumpWriter::WriterLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_queued.wait(lock, [this] { return !m_queue.empty() || m_stopping; });
+        if (m_queue.empty())
+        {
+            return;
+        }
+        const Record record = m_queue.front();
+        m_queue.pop_front();
+        m_inFlight++;
+
+        lock.unlock();
+        const bool written = WriteRecord(record);
+        lock.lock();
+
+        m_inFlight--;
+        m_freeBuffers.push_back(record.buffer);
+        if (written)
+        {
+            m_stats.written++;
+            m_stats.bytesWritten += m_recordBytes;
+        }
+        else
+        {
+            m_stats.failed++;
+        }
+        m_retired.notify_all();
+    }
+}
+
+bool HostSurfaceDumpWriter::WriteRecord(const Record& record)
+{
+    bool unbuffered = m_unbuffered;
+    const bool written = WriteAt(m_file, record.buffer, m_recordBytes, record.index * m_recordBytes, unbuffered);
+    m_unbuffered = unbuffered;
+    return written;
+}
+
+//
+// HostSurfaceDumpReader
+//
+
+HostSurfaceDumpReader::HostSurfaceDumpReader(const char* path) :
+    m_base(nullptr),
+    m_size(0),
+    m_recordBytes(0),
+    m_recordCount(0)
+{
+    const std::string error = "HostSurfaceDumpReader: cannot map " + std::string(path);
+#ifdef _WIN32
+    m_mapping = nullptr;
+    m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size = {};
+    if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size))
+    {
+        if (m_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_file);
+        }
+        throw std::runtime_error(error);
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size != 0)
+    {
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        m_base = m_mapping == nullptr ? nullptr :
+            static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (m_base == nullptr)
+        {
+            if (m_mapping != nullptr)
+            {
+                CloseHandle(m_mapping);
+            }
+            CloseHandle(m_file);
+            throw std::runtime_error(error);
+        }
+    }
+#else
+    const int file = open(path, O_RDONLY);
+    struct stat status = {};
+    if (file < 0 || fstat(file, &status) != 0)
+    {
+        if (file >= 0)
+        {
+            close(file);
+        }
+        throw std::runtime_error(error);
+    }
+    m_size = static_cast<size_t>(status.st_size);
+    if (m_size != 0)
+    {
+        void* base = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, file, 0);
+        if (base == MAP_FAILED)
+        {
+            close(file);
+            throw std::runtime_error(error);
+        }
+        m_base = static_cast<const uint8_t*>(base);
+    }
+    // The mapping keeps the file open.
+    close(file);
+#endif
+
+    // An empty dump has no records.
+    if (m_size == 0)
+    {
+        return;
+    }
+
+    HostSurfaceDumpHeader header = {};
+    if (m_size >= sizeof(header))
+    {
+        memcpy(&header, m_base, sizeof(header));
+    }
+    const uint64_t payloadBytes = static_cast<uint64_t>(header.rowPitch) * header.height;
+    if (header.magic != HostSurfaceDumpMagic || header.version != HostSurfaceDumpVersion ||
+        header.headerBytes < sizeof(header) || header.rowPitch < static_cast<uint64_t>(header.width) * sizeof(uint64_t) ||
+        header.recordBytes < header.headerBytes + payloadBytes)
+    {
+        Unmap();
+        throw std::runtime_error("HostSurfaceDumpReader: not a surface dump: " + std::string(path));
+    }
+    m_recordBytes = static_cast<size_t>(header.recordBytes);
+    m_recordCount = m_size / m_recordBytes;
+}
+
+HostSurfaceDumpReader::~HostSurfaceDumpReader()
+{
+    Unmap();
+}
+
+void HostSurfaceDumpReader::Unmap()
+{
+#ifdef _WIN32
+    if (m_base != nullptr)
+    {
+        UnmapViewOfFile(m_base);
+        CloseHandle(m_mapping);
+    }
+    CloseHandle(m_file);
+#else
+    if (m_base != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(m_base), m_size);
+    }
+#endif
+}
@@ -0,0 +1,170 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Streaming dumps of 64-bit readback surfaces to disk, in a format that is
+// read back by mapping the file. A dump is a sequence of fixed-size records,
+// one per frame, so record i starts at i * recordBytes:
+//
+//   [ HostSurfaceDumpHeader, zero padded to HostSurfaceDumpAlignment ]
+//   [ height rows of rowPitch bytes, zero padded to HostSurfaceDumpAlignment ]
+//
+// rowPitch is width * 8 rounded up to HostSurfaceDumpPitchAlignment, the
+// D3D12 readback row pitch, so 32-texel tiles are whole rows of bytes and
+// readback rows can be taken over as they are. The writer copies each frame
+// into one of a few preallocated, page-aligned buffers and returns; a
+// background thread writes the buffers out with unbuffered I/O (O_DIRECT,
+// FILE_FLAG_NO_BUFFERING) where the file system allows it. When every buffer
+// is waiting for the disk the frame is dropped rather than stalling the
+// caller.
+
+#pragma once
+
+#include "HostArena.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+const uint32_t HostSurfaceDumpMagic = 0x34364453;      // "SD64".
+const uint32_t HostSurfaceDumpVersion = 1;
+const size_t HostSurfaceDumpAlignment = 4096;
+const size_t HostSurfaceDumpPitchAlignment = 256;
+
+struct HostSurfaceDumpHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerBytes;   // Offset of the texels within the record.
+    uint32_t width;
+    uint32_t height;
+    uint32_t rowPitch;      // Bytes.
+    uint64_t frame;
+    uint64_t fence;
+    uint64_t recordBytes;
+};
+
+struct HostSurfaceDumpStats
+{
+    uint64_t submitted;
+    uint64_t written;
+    uint64_t dropped;       // Submitted while no buffer was free.
+    uint64_t failed;        // Records the OS refused to write.
+    uint64_t bytesWritten;
+};
+
+class HostSurfaceDumpWriter
+{
+public:
+    static const uint32_t DefaultBufferCount = 4;
+
+    // Creates or truncates path. Throws std::invalid_argument for an empty
+    // surface or no buffers, std::runtime_error when the file cannot be opened.
+    HostSurfaceDumpWriter(const char* path, uint32_t width, uint32_t height, uint32_t bufferCount = DefaultBufferCount);
+
+    // Writes out the queued records.
+    ~HostSurfaceDumpWriter();
+
+    HostSurfaceDumpWriter(const HostSurfaceDumpWriter&) = delete;
+    HostSurfaceDumpWriter& operator=(const HostSurfaceDumpWriter&) = delete;
+
+    // Copies width x height texels, sourcePitch bytes apart, into a free
+    // buffer and queues it as the next record. Never waits for the disk:
+    // returns false, and counts a drop, when no buffer is free. A workerCount
+    // of zero uses HostWorkerCount() threads for the copy.
+    bool Submit(const void* texels, size_t sourcePitch, uint64_t frame, uint64_t fence, uint32_t workerCount = 0);
+
+    // Waits until every queued record has been written.
+    void Flush();
+
+    HostSurfaceDumpStats GetStats() const;
+
+    // Whether the file was opened for unbuffered I/O.
+    bool IsUnbuffered() const       { return m_unbuffered; }
+
+    size_t GetRecordBytes() const   { return m_recordBytes; }
+
+private:
+    struct Record
+    {
+        uint8_t* buffer;
+        uint64_t index;
+    };
+
+    void WriterLoop();
+    bool WriteRecord(const Record& record);
+
+    uint32_t m_width;
+    uint32_t m_height;
+    size_t m_rowPitch;
+    size_t m_recordBytes;
+    std::atomic<bool> m_unbuffered;
+#ifdef _WIN32
+    void* m_file;
+#else
+    int m_file;
+#endif
+
+    HostArena m_arena;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queued;
+    std::condition_variable m_retired;
+    std::vector<uint8_t*> m_freeBuffers;
+    std::deque<Record> m_queue;
+    uint32_t m_inFlight;
+    uint64_t m_nextIndex;
+    bool m_stopping;
+    HostSurfaceDumpStats m_stats;
+    std::thread m_writer;
+};
+
+// Read-only mapping of a dump. Texels are read in place.
+class HostSurfaceDumpReader
+{
+public:
+    // Throws std::runtime_error when the file cannot be mapped, or is neither
+    // empty nor starts with a dump header. A partly written last record is
+    // ignored.
+    explicit HostSurfaceDumpReader(const char* path);
+    ~HostSurfaceDumpReader();
+
+    HostSurfaceDumpReader(const HostSurfaceDumpReader&) = delete;
+    HostSurfaceDumpReader& operator=(const HostSurfaceDumpReader&) = delete;
+
+    size_t GetRecordCount() const   { return m_recordCount; }
+
+    const HostSurfaceDumpHeader& GetHeader(size_t record) const
+    {
+        return *reinterpret_cast<const HostSurfaceDumpHeader*>(GetRecord(record));
+    }
+
+    // Rows are GetHeader(record).rowPitch bytes apart.
+    const uint64_t* GetTexels(size_t record) const
+    {
+        return reinterpret_cast<const uint64_t*>(GetRecord(record) + GetHeader(record).headerBytes);
+    }
+
+private:
+    const uint8_t* GetRecord(size_t record) const
+    {
+        return m_base + record * m_recordBytes;
+    }
+
+    void Unmap();
+
+    const uint8_t* m_base;
+    size_t m_size;
+    size_t m_recordBytes;
+    size_t m_recordCount;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#endif
+};
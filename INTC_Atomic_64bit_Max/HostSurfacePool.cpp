@@ -0,0 +1,190 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostSurfacePool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+const uint32_t HostSurfacePool::InvalidSurface;
+const uint32_t HostSurfacePool::DefaultMaxIdleFrames;
+
+HostSurfacePool::HostSurfacePool(CreateCallback create, DestroyCallback destroy, uint32_t maxIdleFrames) :
+    m_create(create),
+    m_destroy(destroy),
+    m_maxIdleFrames(maxIdleFrames),
+    m_recycleCount(0),
+    m_stats()
+{
+    if (!m_create)
+    {
+        throw std::invalid_argument("HostSurfacePool: create callback required");
+    }
+}
+
+HostSurfacePool::~HostSurfacePool()
+{
+    // The owner waits for the GPU before destroying the pool.
+    for (uint32_t surface = 0; surface < m_surfaces.size(); surface++)
+    {
+        if (m_surfaces[surface].live && m_destroy)
+        {
+            m_destroy(surface);
+        }
+    }
+}
+
+void HostSurfacePool::Destroy(uint32_t surface)
+{
+    Surface& entry = m_surfaces[surface];
+    if (m_destroy)
+    {
+        m_destroy(surface);
+    }
+    m_stats.bytesHeld -= entry.bytes;
+    m_stats.surfaceCount--;
+    entry.live = false;
+    m_freeSurfaces.push_back(surface);
+}
+
+void HostSurfacePool::RemoveIdle(uint32_t surface)
+{
+    Surface& entry = m_surfaces[surface];
+    std::vector<uint32_t>& idle = m_idle[entry.key];
+    idle.erase(std::find(idle.begin(), idle.end(), surface));
+    entry.idle = false;
+    m_stats.idleBytes -= entry.bytes;
+    m_stats.idleCount--;
+}
+
+uint32_t HostSurfacePool::Acquire(const HostSurfaceKey& key, uint64_t frameFence)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    uint32_t surface;
+    auto idle = m_idle.find(key);
+    if (idle != m_idle.end() && !idle->second.empty())
+    {
+        surface = idle->second.back();
+        RemoveIdle(surface);
+        m_stats.hits++;
+    }
+    else
+    {
+        if (!m_freeSurfaces.empty())
+        {
+            surface = m_freeSurfaces.back();
+            m_freeSurfaces.pop_back();
+        }
+        else
+        {
+            surface = static_cast<uint32_t>(m_surfaces.size());
+            m_surfaces.push_back(Surface());
+        }
+
+        uint64_t bytes;
+        try
+        {
+            bytes = m_create(surface, key);
+        }
+        catch (...)
+        {
+            m_freeSurfaces.push_back(surface);
+            throw;
+        }
+
+        Surface& entry = m_surfaces[surface];
+        entry.key = key;
+        entry.bytes = bytes;
+        entry.live = true;
+        entry.idle = false;
+        m_stats.bytesHeld += bytes;
+        m_stats.surfaceCount++;
+        m_stats.misses++;
+    }
+
+    m_surfaces[surface].fence = frameFence;
+    m_inFlight.push_back(surface);
+    return surface;
+}
+
+void HostSurfacePool::Recycle(uint64_t completedFence)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_recycleCount++;
+
+    size_t kept = 0;
+    for (uint32_t surface : m_inFlight)
+    {
+        Surface& entry = m_surfaces[surface];
+        if (entry.fence > completedFence)
+        {
+            m_inFlight[kept++] = surface;
+            continue;
+        }
+        entry.idle = true;
+        entry.idleSince = m_recycleCount;
+        m_idle[entry.key].push_back(surface);
+        m_stats.idleBytes += entry.bytes;
+        m_stats.idleCount++;
+    }
+    m_inFlight.resize(kept);
+
+    // Idle lists are ordered by idleSince, so stale entries are at the front.
+    for (auto& idle : m_idle)
+    {
+        size_t stale = 0;
+        while (stale < idle.second.size() && m_recycleCount - m_surfaces[idle.second[stale]].idleSince > m_maxIdleFrames)
+        {
+            stale++;
+        }
+        for (size_t i = 0; i < stale; i++)
+        {
+            const uint32_t surface = idle.second[i];
+            m_surfaces[surface].idle = false;
+            m_stats.idleBytes -= m_surfaces[surface].bytes;
+            m_stats.idleCount--;
+            m_stats.trimmed++;
+            Destroy(surface);
+        }
+        idle.second.erase(idle.second.begin(), idle.second.begin() + stale);
+    }
+}
+
+uint64_t HostSurfacePool::Trim(uint64_t maxIdleBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stats.idleBytes <= maxIdleBytes)
+    {
+        return 0;
+    }
+
+    std::vector<uint32_t> idle;
+    idle.reserve(static_cast<size_t>(m_stats.idleCount));
+    for (const auto& list : m_idle)
+    {
+        idle.insert(idle.end(), list.second.begin(), list.second.end());
+    }
+    std::sort(idle.begin(), idle.end(), [this](uint32_t a, uint32_t b)
+    {
+        return m_surfaces[a].idleSince < m_surfaces[b].idleSince;
+    });
+
+    uint64_t released = 0;
+    for (size_t i = 0; i < idle.size() && m_stats.idleBytes > maxIdleBytes; i++)
+    {
+        released += m_surfaces[idle[i]].bytes;
+        RemoveIdle(idle[i]);
+        m_stats.trimmed++;
+        Destroy(idle[i]);
+    }
+    return released;
+}
+
+HostSurfacePoolStats HostSurfacePool::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
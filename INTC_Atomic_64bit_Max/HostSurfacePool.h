@@ -0,0 +1,129 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Pool of per-frame scratch surfaces. Instead of creating and destroying a
+// resource every frame, Acquire hands out an idle surface with the same
+// description, and surfaces come back to the pool once the fence value of the
+// frame that used them has completed. Idle surfaces are destroyed by Trim
+// under memory pressure, or once they have been idle for a number of frames.
+// This file holds the pool logic only, with no D3D12 dependency;
+// AtomicSurfacePool creates the resources, and HostSimulatedFence stands in
+// for an ID3D12Fence offline.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct HostSurfaceKey
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;        // DXGI_FORMAT.
+    bool atomic64;          // Created with EmulatedTyped64bitAtomics.
+
+    bool operator==(const HostSurfaceKey& other) const
+    {
+        return width == other.width && height == other.height && format == other.format && atomic64 == other.atomic64;
+    }
+};
+
+struct HostSurfaceKeyHash
+{
+    size_t operator()(const HostSurfaceKey& key) const
+    {
+        uint64_t hash = (static_cast<uint64_t>(key.width) << 32 | key.height) * 0x9E3779B97F4A7C15ull;
+        hash ^= (static_cast<uint64_t>(key.format) << 1 | (key.atomic64 ? 1 : 0)) + (hash >> 29);
+        return static_cast<size_t>(hash);
+    }
+};
+
+// Fence values advance with Signal and complete, in order, with Complete.
+class HostSimulatedFence
+{
+public:
+    HostSimulatedFence() : m_signaled(0), m_completed(0) {}
+
+    uint64_t Signal()                   { return ++m_signaled; }
+    void Complete(uint64_t value)       { m_completed = value > m_signaled ? m_signaled : value; }
+    uint64_t GetCompletedValue() const  { return m_completed; }
+    uint64_t GetSignaledValue() const   { return m_signaled; }
+
+private:
+    uint64_t m_signaled;
+    uint64_t m_completed;
+};
+
+struct HostSurfacePoolStats
+{
+    uint64_t hits;              // Acquires served from the pool.
+    uint64_t misses;            // Acquires that created a surface.
+    uint64_t trimmed;           // Surfaces destroyed by trimming.
+    uint64_t bytesHeld;         // All live surfaces.
+    uint64_t idleBytes;         // Surfaces waiting in the pool.
+    uint64_t surfaceCount;
+    uint64_t idleCount;
+};
+
+class HostSurfacePool
+{
+public:
+    static const uint32_t InvalidSurface = ~0u;
+    static const uint32_t DefaultMaxIdleFrames = 60;
+
+    // Creates surface with the given description and returns its size in
+    // bytes; reports failure by throwing. Destroy releases it. Both run under
+    // the pool lock.
+    typedef std::function<uint64_t(uint32_t surface, const HostSurfaceKey& key)> CreateCallback;
+    typedef std::function<void(uint32_t surface)> DestroyCallback;
+
+    HostSurfacePool(CreateCallback create, DestroyCallback destroy, uint32_t maxIdleFrames = DefaultMaxIdleFrames);
+    ~HostSurfacePool();
+
+    // Returns a surface for the frame that ends with fence value frameFence.
+    // Its contents are undefined.
+    uint32_t Acquire(const HostSurfaceKey& key, uint64_t frameFence);
+
+    // Returns surfaces whose frame fence is at most completedFence to the
+    // pool, and destroys surfaces that have been idle for more than
+    // maxIdleFrames calls. Call once per frame.
+    void Recycle(uint64_t completedFence);
+
+    // Destroys idle surfaces, least recently used first, until at most
+    // maxIdleBytes are idle. Returns the bytes released.
+    uint64_t Trim(uint64_t maxIdleBytes);
+
+    HostSurfacePoolStats GetStats() const;
+
+private:
+    struct Surface
+    {
+        HostSurfaceKey key;
+        uint64_t bytes;
+        uint64_t fence;         // Frame fence while in flight.
+        uint64_t idleSince;     // Recycle count when it became idle.
+        bool live;
+        bool idle;
+    };
+
+    void Destroy(uint32_t surface);
+    void RemoveIdle(uint32_t surface);
+
+    mutable std::mutex m_mutex;
+    CreateCallback m_create;
+    DestroyCallback m_destroy;
+    uint32_t m_maxIdleFrames;
+
+    std::vector<Surface> m_surfaces;
+    std::vector<uint32_t> m_freeSurfaces;       // Indices available for reuse.
+    std::vector<uint32_t> m_inFlight;
+    std::unordered_map<HostSurfaceKey, std::vector<uint32_t>, HostSurfaceKeyHash> m_idle;  // Most recently idle last.
+    uint64_t m_recycleCount;
+
+    HostSurfacePoolStats m_stats;
+};
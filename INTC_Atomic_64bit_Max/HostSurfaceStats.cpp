@@ -0,0 +1,263 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostSurfaceStats.h"
+#include "HostParallel.h"
+
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+// PCMPGTQ is SSE4.2. MSVC emits it without /arch flags; GCC and Clang need
+// -msse4.2 or later, and fall back to scalar code otherwise.
+#if defined(_MSC_VER) || defined(__SSE4_2__)
+#define HOST_STATS_SSE42 1
+#endif
+#endif
+
+namespace
+{
+    const HostValueSummary EmptySummary = { 0, ~0ull, 0, 0 };
+
+    void Merge(HostValueSummary& total, const HostValueSummary& part)
+    {
+        total.count += part.count;
+        total.minValue = part.minValue < total.minValue ? part.minValue : total.minValue;
+        total.maxValue = part.maxValue > total.maxValue ? part.maxValue : total.maxValue;
+        total.sum += part.sum;
+    }
+
+    HostValueSummary SummarizeSpan(const uint64_t* texels, size_t count)
+    {
+        HostValueSummary summary = EmptySummary;
+        summary.count = count;
+        size_t i = 0;
+#ifdef HOST_STATS_SSE42
+        // PCMPGTQ is signed, so values are biased by 2^63 for min / max.
+        // Four texels per step, in two independent pairs of lanes.
+        const __m128i bias = _mm_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+        __m128i minLo = _mm_set1_epi64x(0x7FFFFFFFFFFFFFFFll);
+        __m128i minHi = minLo;
+        __m128i maxLo = bias;
+        __m128i maxHi = bias;
+        __m128i sum = _mm_setzero_si128();
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + i + 2));
+            sum = _mm_add_epi64(sum, _mm_add_epi64(a, b));
+
+            const __m128i biasedA = _mm_xor_si128(a, bias);
+            const __m128i biasedB = _mm_xor_si128(b, bias);
+            minLo = _mm_blendv_epi8(minLo, biasedA, _mm_cmpgt_epi64(minLo, biasedA));
+            minHi = _mm_blendv_epi8(minHi, biasedB, _mm_cmpgt_epi64(minHi, biasedB));
+            maxLo = _mm_blendv_epi8(maxLo, biasedA, _mm_cmpgt_epi64(biasedA, maxLo));
+            maxHi = _mm_blendv_epi8(maxHi, biasedB, _mm_cmpgt_epi64(biasedB, maxHi));
+        }
+
+        uint64_t lanes[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), _mm_xor_si128(minLo, bias));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes + 2), _mm_xor_si128(minHi, bias));
+        for (uint64_t lane : lanes)
+        {
+            summary.minValue = lane < summary.minValue ? lane : summary.minValue;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), _mm_xor_si128(maxLo, bias));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes + 2), _mm_xor_si128(maxHi, bias));
+        for (uint64_t lane : lanes)
+        {
+            summary.maxValue = lane > summary.maxValue ? lane : summary.maxValue;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+        summary.sum = lanes[0] + lanes[1];
+#endif
+        for (; i < count; i++)
+        {
+            const uint64_t value = texels[i];
+            summary.minValue = value < summary.minValue ? value : summary.minValue;
+            summary.maxValue = value > summary.maxValue ? value : summary.maxValue;
+            summary.sum += value;
+        }
+        return summary;
+    }
+
+    // Worker histograms have two extra slots per copy: binCount for overflow
+    // and binCount + 1 for underflow.
+    const uint32_t HistogramCopies = 4;
+
+    size_t HistogramStride(uint32_t binCount)
+    {
+        return static_cast<size_t>(binCount) + 2;
+    }
+
+    // Per-worker accumulators of the whole-surface results.
+    struct Partial
+    {
+        HostValueSummary total;
+        std::vector<uint64_t> valueCounts;
+        std::vector<uint64_t> histogram;
+    };
+
+    // Shift for power-of-two bin widths, or -1.
+    int BinShift(uint64_t binWidth)
+    {
+        if (binWidth == 0 || (binWidth & (binWidth - 1)) != 0)
+        {
+            return -1;
+        }
+        int shift = 0;
+        while ((1ull << shift) != binWidth)
+        {
+            shift++;
+        }
+        return shift;
+    }
+
+    void CountRow(const uint64_t* row, uint32_t width, const HostSummaryOptions& options, int binShift, Partial& partial)
+    {
+        // One pass per value over the row, which is in L1 by now, with a
+        // local count the compiler can keep in a register.
+        for (size_t k = 0; k < options.countValues.size(); k++)
+        {
+            const uint64_t match = options.countValues[k];
+            uint64_t count = 0;
+            for (uint32_t x = 0; x < width; x++)
+            {
+                count += row[x] == match ? 1 : 0;
+            }
+            partial.valueCounts[k] += count;
+        }
+
+        if (options.binCount == 0)
+        {
+            return;
+        }
+
+        // Branch-free binning into HistogramCopies interleaved histograms, so
+        // runs of equal values do not serialize on one counter.
+        const uint64_t base = options.histogramBase;
+        const uint64_t binCount = options.binCount;
+        const size_t stride = HistogramStride(options.binCount);
+        uint64_t* histogram = partial.histogram.data();
+        for (uint32_t x = 0; x < width; x++)
+        {
+            const uint64_t value = row[x];
+            const uint64_t offset = value - base;
+            uint64_t bin = binShift >= 0 ? offset >> binShift : offset / options.binWidth;
+            bin = bin < binCount ? bin : binCount;
+            bin = value < base ? binCount + 1 : bin;
+            histogram[(x % HistogramCopies) * stride + static_cast<size_t>(bin)]++;
+        }
+    }
+}
+
+HostSurfaceSummary HostSummarizeSurface(const uint64_t* texels, size_t rowPitch, uint32_t width, uint32_t height,
+    const HostSummaryOptions& options, uint32_t workerCount)
+{
+    if (options.binCount != 0 && options.binWidth == 0)
+    {
+        throw std::invalid_argument("HostSummarizeSurface: zero bin width");
+    }
+
+    const uint32_t tileSize = options.tileSize;
+    const uint32_t tilesX = tileSize == 0 ? 0 : (width + tileSize - 1) / tileSize;
+    const uint32_t tilesY = tileSize == 0 ? 0 : (height + tileSize - 1) / tileSize;
+
+    HostSurfaceSummary summary;
+    summary.total = EmptySummary;
+    summary.valueCounts.assign(options.countValues.size(), 0);
+    summary.histogram.assign(options.binCount, 0);
+    summary.underflow = 0;
+    summary.overflow = 0;
+    if (options.perRow)
+    {
+        summary.rows.assign(height, EmptySummary);
+    }
+    summary.tiles.assign(static_cast<size_t>(tilesX) * tilesY, EmptySummary);
+    if (width == 0 || height == 0)
+    {
+        return summary;
+    }
+
+    workerCount = HostWorkersForBytes(static_cast<size_t>(width) * height * sizeof(uint64_t), workerCount);
+
+    // Bands of whole tile rows keep every tile within one worker.
+    const uint32_t bandHeight = tileSize == 0 ? 1 : tileSize;
+    const uint32_t bandCount = (height + bandHeight - 1) / bandHeight;
+    const bool countTexels = !options.countValues.empty() || options.binCount != 0;
+    const int binShift = BinShift(options.binWidth);
+
+    std::vector<Partial> partials(workerCount, Partial{ EmptySummary, {}, {} });
+    HostParallelRanges(bandCount, workerCount, [&](uint32_t worker, size_t beginBand, size_t endBand)
+    {
+        Partial& partial = partials[worker];
+        partial.total = EmptySummary;
+        partial.valueCounts.assign(options.countValues.size(), 0);
+        partial.histogram.assign(options.binCount == 0 ? 0 : HistogramCopies * HistogramStride(options.binCount), 0);
+
+        const uint32_t beginRow = static_cast<uint32_t>(beginBand) * bandHeight;
+        const uint32_t endRow = static_cast<uint32_t>(endBand * bandHeight < height ? endBand * bandHeight : height);
+        for (uint32_t y = beginRow; y < endRow; y++)
+        {
+            const uint64_t* row = texels + y * rowPitch;
+            HostValueSummary rowSummary;
+            if (tileSize == 0)
+            {
+                rowSummary = SummarizeSpan(row, width);
+            }
+            else
+            {
+                rowSummary = EmptySummary;
+                HostValueSummary* tiles = &summary.tiles[static_cast<size_t>(y / tileSize) * tilesX];
+                for (uint32_t tileX = 0; tileX < tilesX; tileX++)
+                {
+                    const uint32_t left = tileX * tileSize;
+                    const HostValueSummary span = SummarizeSpan(row + left, width - left < tileSize ? width - left : tileSize);
+                    Merge(tiles[tileX], span);
+                    Merge(rowSummary, span);
+                }
+            }
+
+            Merge(partial.total, rowSummary);
+            if (options.perRow)
+            {
+                summary.rows[y] = rowSummary;
+            }
+            if (countTexels)
+            {
+                CountRow(row, width, options, binShift, partial);
+            }
+        }
+    });
+
+    for (const Partial& partial : partials)
+    {
+        // Workers without a range leave their partial empty.
+        if (partial.total.count == 0)
+        {
+            continue;
+        }
+        Merge(summary.total, partial.total);
+        for (size_t k = 0; k < summary.valueCounts.size(); k++)
+        {
+            summary.valueCounts[k] += partial.valueCounts[k];
+        }
+        if (options.binCount != 0)
+        {
+            const size_t stride = HistogramStride(options.binCount);
+            for (uint32_t copy = 0; copy < HistogramCopies; copy++)
+            {
+                const uint64_t* histogram = &partial.histogram[copy * stride];
+                for (uint32_t bin = 0; bin < options.binCount; bin++)
+                {
+                    summary.histogram[bin] += histogram[bin];
+                }
+                summary.overflow += histogram[options.binCount];
+                summary.underflow += histogram[options.binCount + 1];
+            }
+        }
+    }
+    return summary;
+}
@@ -0,0 +1,59 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Parallel summary statistics over a 64-bit readback surface, for validating
+// frames without stepping through texels: min / max / sum, counts of chosen
+// values, a value histogram, and optional per-row and per-tile summaries.
+// Everything is gathered in one pass, split across workers by bands of rows
+// (tile rows when per-tile summaries are requested), with SIMD min / max / sum
+// on x86 when SSE4.2 is available at compile time.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct HostValueSummary
+{
+    uint64_t count;
+    uint64_t minValue;
+    uint64_t maxValue;
+    uint64_t sum;           // Wraps modulo 2^64.
+};
+
+struct HostSummaryOptions
+{
+    // Values to count exactly, e.g. the clear value and a sentinel.
+    std::vector<uint64_t> countValues;
+
+    // binCount bins of binWidth values starting at histogramBase; values
+    // outside land in underflow / overflow. No histogram when binCount is 0.
+    uint64_t histogramBase = 0;
+    uint64_t binWidth = 1;
+    uint32_t binCount = 0;
+
+    bool perRow = false;
+
+    // Tile size of the per-tile summaries; 0 for none.
+    uint32_t tileSize = 0;
+};
+
+struct HostSurfaceSummary
+{
+    HostValueSummary total;
+    std::vector<uint64_t> valueCounts;      // Parallel to countValues.
+    std::vector<uint64_t> histogram;
+    uint64_t underflow;
+    uint64_t overflow;
+    std::vector<HostValueSummary> rows;
+    std::vector<HostValueSummary> tiles;    // Row-major, ceil(width / tileSize) per tile row.
+};
+
+// Summarizes width x height texels, rowPitch texels apart. A workerCount of
+// zero uses HostWorkerCount() threads. Throws std::invalid_argument for a zero
+// bin width.
+HostSurfaceSummary HostSummarizeSurface(const uint64_t* texels, size_t rowPitch, uint32_t width, uint32_t height,
+    const HostSummaryOptions& options, uint32_t workerCount = 0);
@@ -0,0 +1,140 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Zero-copy rectangular views over 64-bit atomic surfaces. The extension does
+// not support subresource regions, so instead of copying a rectangle out (or
+// dispatching over the whole surface) a view keeps the parent surface and an
+// origin / extent and offsets every access. Works with any of the host
+// surfaces (HostAtomicSurface64, HostEmulatedAtomicSurface64,
+// HostSparseAtomicSurface64).
+//
+// Shaders use the matching root-constant convention in AtomicView.hlsl: the
+// view origin and extent are passed as four 32-bit root constants and threads
+// outside the extent return early.
+
+#pragma once
+
+#include "HostAtomics64.h"
+
+#include <stdexcept>
+
+// Root constants of AtomicView.hlsl, in register order.
+struct HostViewConstants
+{
+    uint32_t originX;
+    uint32_t originY;
+    uint32_t width;
+    uint32_t height;
+};
+
+static const uint32_t HostViewConstantCount = sizeof(HostViewConstants) / sizeof(uint32_t);
+
+template <typename Surface>
+class HostSurfaceView
+{
+public:
+    // Whole surface.
+    explicit HostSurfaceView(Surface& surface) :
+        HostSurfaceView(surface, 0, 0, surface.GetWidth(), surface.GetHeight())
+    {
+    }
+
+    // Throws std::invalid_argument when the rectangle is empty or does not
+    // fit the surface.
+    HostSurfaceView(Surface& surface, uint32_t originX, uint32_t originY, uint32_t width, uint32_t height) :
+        m_surface(&surface),
+        m_originX(originX),
+        m_originY(originY),
+        m_width(width),
+        m_height(height)
+    {
+        if (width == 0 || height == 0 ||
+            originX > surface.GetWidth() || width > surface.GetWidth() - originX ||
+            originY > surface.GetHeight() || height > surface.GetHeight() - originY)
+        {
+            throw std::invalid_argument("HostSurfaceView: rectangle does not fit the surface");
+        }
+    }
+
+    Surface& GetSurface() const     { return *m_surface; }
+    uint32_t GetOriginX() const     { return m_originX; }
+    uint32_t GetOriginY() const     { return m_originY; }
+    uint32_t GetWidth() const       { return m_width; }
+    uint32_t GetHeight() const      { return m_height; }
+
+    // Row pitch of the parent surface, in texels.
+    uint32_t GetPitch() const       { return m_surface->GetWidth(); }
+
+    HostViewConstants GetConstants() const  { return HostViewConstants{ m_originX, m_originY, m_width, m_height }; }
+
+    // Rectangle relative to this view.
+    HostSurfaceView Subview(uint32_t originX, uint32_t originY, uint32_t width, uint32_t height) const
+    {
+        if (originX > m_width || width > m_width - originX || originY > m_height || height > m_height - originY)
+        {
+            throw std::invalid_argument("HostSurfaceView::Subview: rectangle does not fit the view");
+        }
+        return HostSurfaceView(*m_surface, m_originX + originX, m_originY + originY, width, height);
+    }
+
+    // Coordinates are relative to the view origin and are not range checked,
+    // like the surfaces themselves.
+    uint64_t Load(uint32_t x, uint32_t y) const                 { return m_surface->Load(m_originX + x, m_originY + y); }
+    void Store(uint32_t x, uint32_t y, uint64_t value) const    { m_surface->Store(m_originX + x, m_originY + y, value); }
+
+    uint64_t InterlockedAdd(uint32_t x, uint32_t y, uint64_t value) const       { return m_surface->InterlockedAdd(m_originX + x, m_originY + y, value); }
+    uint64_t InterlockedMin(uint32_t x, uint32_t y, uint64_t value) const       { return m_surface->InterlockedMin(m_originX + x, m_originY + y, value); }
+    uint64_t InterlockedMax(uint32_t x, uint32_t y, uint64_t value) const       { return m_surface->InterlockedMax(m_originX + x, m_originY + y, value); }
+    uint64_t InterlockedAnd(uint32_t x, uint32_t y, uint64_t value) const       { return m_surface->InterlockedAnd(m_originX + x, m_originY + y, value); }
+    uint64_t InterlockedOr(uint32_t x, uint32_t y, uint64_t value) const        { return m_surface->InterlockedOr(m_originX + x, m_originY + y, value); }
+    uint64_t InterlockedXor(uint32_t x, uint32_t y, uint64_t value) const       { return m_surface->InterlockedXor(m_originX + x, m_originY + y, value); }
+    uint64_t InterlockedExchange(uint32_t x, uint32_t y, uint64_t value) const  { return m_surface->InterlockedExchange(m_originX + x, m_originY + y, value); }
+    uint64_t InterlockedCompareExchange(uint32_t x, uint32_t y, uint64_t cmpValue, uint64_t xchgValue) const
+    {
+        return m_surface->InterlockedCompareExchange(m_originX + x, m_originY + y, cmpValue, xchgValue);
+    }
+
+    uint64_t Apply(HostAtomicOp op, uint32_t x, uint32_t y, uint64_t value, uint64_t xchgValue = 0) const
+    {
+        return m_surface->Apply(op, m_originX + x, m_originY + y, value, xchgValue);
+    }
+
+    // Copies the view's rows, and only those, to destination with the given
+    // row pitch in bytes.
+    void CopyTo(uint64_t* destination, size_t destinationPitch) const
+    {
+        for (uint32_t y = 0; y < m_height; y++)
+        {
+            uint64_t* row = reinterpret_cast<uint64_t*>(reinterpret_cast<uint8_t*>(destination) + y * destinationPitch);
+            for (uint32_t x = 0; x < m_width; x++)
+            {
+                row[x] = Load(x, y);
+            }
+        }
+    }
+
+    // Stores width x height texels from source, e.g. a mapped readback buffer
+    // holding a CopyTextureRegion of just this view (RowPitch bytes per row).
+    void CopyFrom(const uint64_t* source, size_t sourcePitch) const
+    {
+        for (uint32_t y = 0; y < m_height; y++)
+        {
+            const uint64_t* row = reinterpret_cast<const uint64_t*>(reinterpret_cast<const uint8_t*>(source) + y * sourcePitch);
+            for (uint32_t x = 0; x < m_width; x++)
+            {
+                Store(x, y, row[x]);
+            }
+        }
+    }
+
+private:
+    Surface* m_surface;
+    uint32_t m_originX;
+    uint32_t m_originY;
+    uint32_t m_width;
+    uint32_t m_height;
+};
+
+typedef HostSurfaceView<HostAtomicSurface64> HostAtomicSurfaceView64;
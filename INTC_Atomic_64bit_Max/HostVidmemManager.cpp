@@ -0,0 +1,284 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostVidmemManager.h"
+
+#include <stdexcept>
+
+const char* HostMemoryPoolName(HostMemoryPool pool)
+{
+    switch (pool)
+    {
+    case HostMemoryPool::System:            return "system";
+    case HostMemoryPool::CpuVisibleVidmem:  return "cpu-visible vidmem";
+    }
+    return "unknown";
+}
+
+//
+// HostSimulatedVidmemBudget
+//
+
+HostSimulatedVidmemBudget::HostSimulatedVidmemBudget(uint64_t totalBytes) :
+    m_totalBytes(totalBytes),
+    m_committedBytes(0),
+    m_externalBytes(0)
+{
+}
+
+void HostSimulatedVidmemBudget::Query(uint64_t* totalBytes, uint64_t* freeBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint64_t used = m_committedBytes + m_externalBytes;
+    *totalBytes = m_totalBytes;
+    *freeBytes = used < m_totalBytes ? m_totalBytes - used : 0;
+}
+
+bool HostSimulatedVidmemBudget::Commit(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_committedBytes + m_externalBytes + bytes > m_totalBytes)
+    {
+        return false;
+    }
+    m_committedBytes += bytes;
+    return true;
+}
+
+void HostSimulatedVidmemBudget::Decommit(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_committedBytes -= bytes;
+}
+
+void HostSimulatedVidmemBudget::SetExternalUsage(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_externalBytes = bytes;
+}
+
+//
+// HostVidmemManager
+//
+
+const uint32_t HostVidmemManager::InvalidBuffer;
+const uint64_t HostVidmemManager::DefaultHeadroom;
+
+HostVidmemManager::HostVidmemManager(HostVidmemBudgetProvider& budget, PlaceCallback place, ReleaseCallback release, uint64_t headroom) :
+    m_budget(budget),
+    m_place(place),
+    m_release(release),
+    m_headroom(headroom),
+    m_clock(0),
+    m_lastRebalance(0),
+    m_stats()
+{
+    if (!m_place)
+    {
+        throw std::invalid_argument("HostVidmemManager: place callback required");
+    }
+}
+
+// Bytes that can still go to video memory without eating into the headroom.
+uint64_t HostVidmemManager::QueryAvailable() const
+{
+    uint64_t totalBytes = 0;
+    uint64_t freeBytes = 0;
+    m_budget.Query(&totalBytes, &freeBytes);
+    return freeBytes > m_headroom ? freeBytes - m_headroom : 0;
+}
+
+// Moves buffer to pool, keeping the statistics in step. Returns false when
+// video memory creation fails and the buffer stays where it was.
+bool HostVidmemManager::Place(uint32_t buffer, HostMemoryPool pool)
+{
+    Buffer& entry = m_buffers[buffer];
+    if (!m_place(buffer, entry.size, entry.kind, pool))
+    {
+        if (pool == HostMemoryPool::System)
+        {
+            throw std::runtime_error("HostVidmemManager: system memory placement failed");
+        }
+        return false;
+    }
+
+    if (entry.live)
+    {
+        const bool wasVidmem = entry.pool == HostMemoryPool::CpuVisibleVidmem;
+        (wasVidmem ? m_stats.vidmemBytes : m_stats.systemBytes) -= entry.size;
+        (wasVidmem ? m_stats.vidmemBuffers : m_stats.systemBuffers)--;
+    }
+    const bool isVidmem = pool == HostMemoryPool::CpuVisibleVidmem;
+    (isVidmem ? m_stats.vidmemBytes : m_stats.systemBytes) += entry.size;
+    (isVidmem ? m_stats.vidmemBuffers : m_stats.systemBuffers)++;
+    entry.pool = pool;
+    entry.live = true;
+    return true;
+}
+
+void HostVidmemManager::Demote(uint32_t buffer)
+{
+    Place(buffer, HostMemoryPool::System);
+    m_stats.demotions++;
+}
+
+uint32_t HostVidmemManager::Allocate(uint64_t size, HostBufferKind kind)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    uint32_t buffer;
+    if (!m_freeBuffers.empty())
+    {
+        buffer = m_freeBuffers.back();
+        m_freeBuffers.pop_back();
+    }
+    else
+    {
+        buffer = static_cast<uint32_t>(m_buffers.size());
+        m_buffers.push_back(Buffer());
+    }
+
+    Buffer& entry = m_buffers[buffer];
+    entry.size = size;
+    entry.lastUse = ++m_clock;
+    entry.kind = kind;
+    entry.pool = HostMemoryPool::System;
+    entry.live = false;
+
+    try
+    {
+        if (size > QueryAvailable() || !Place(buffer, HostMemoryPool::CpuVisibleVidmem))
+        {
+            Place(buffer, HostMemoryPool::System);
+            m_stats.fallbacks++;
+        }
+    }
+    catch (...)
+    {
+        m_freeBuffers.push_back(buffer);
+        throw;
+    }
+
+    m_lru.push_front(buffer);
+    m_buffers[buffer].lru = m_lru.begin();
+    return buffer;
+}
+
+void HostVidmemManager::Free(uint32_t buffer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Buffer& entry = m_buffers[buffer];
+    if (m_release)
+    {
+        m_release(buffer);
+    }
+
+    const bool isVidmem = entry.pool == HostMemoryPool::CpuVisibleVidmem;
+    (isVidmem ? m_stats.vidmemBytes : m_stats.systemBytes) -= entry.size;
+    (isVidmem ? m_stats.vidmemBuffers : m_stats.systemBuffers)--;
+
+    m_lru.erase(entry.lru);
+    entry.live = false;
+    m_freeBuffers.push_back(buffer);
+}
+
+void HostVidmemManager::Touch(uint32_t buffer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Buffer& entry = m_buffers[buffer];
+    entry.lastUse = ++m_clock;
+    m_lru.splice(m_lru.begin(), m_lru, entry.lru);
+}
+
+HostMemoryPool HostVidmemManager::GetPool(uint32_t buffer) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_buffers[buffer].pool;
+}
+
+uint32_t HostVidmemManager::Rebalance()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t moves = 0;
+
+    // Over budget (another application took video memory, say): demote from
+    // the least recently used end until the headroom is back.
+    uint64_t totalBytes = 0;
+    uint64_t freeBytes = 0;
+    m_budget.Query(&totalBytes, &freeBytes);
+    for (auto it = m_lru.rbegin(); it != m_lru.rend() && freeBytes < m_headroom; ++it)
+    {
+        if (m_buffers[*it].pool == HostMemoryPool::CpuVisibleVidmem)
+        {
+            Demote(*it);
+            moves++;
+            m_budget.Query(&totalBytes, &freeBytes);
+        }
+    }
+
+    // Promote recently touched system buffers. The LRU list is ordered by last
+    // use, so the walk stops at the first buffer not touched since the
+    // previous Rebalance, and victims are taken from the tail only while they
+    // are older than the candidate.
+    std::vector<uint32_t> victims;
+    for (auto it = m_lru.begin(); it != m_lru.end() && m_buffers[*it].lastUse > m_lastRebalance; ++it)
+    {
+        Buffer& candidate = m_buffers[*it];
+        if (candidate.pool != HostMemoryPool::System)
+        {
+            continue;
+        }
+
+        uint64_t available = QueryAvailable();
+        if (available < candidate.size)
+        {
+            victims.clear();
+            uint64_t reclaimed = 0;
+            for (auto victim = m_lru.rbegin(); victim != m_lru.rend() && available + reclaimed < candidate.size; ++victim)
+            {
+                const Buffer& entry = m_buffers[*victim];
+                if (entry.lastUse >= candidate.lastUse)
+                {
+                    break;
+                }
+                if (entry.pool == HostMemoryPool::CpuVisibleVidmem)
+                {
+                    victims.push_back(*victim);
+                    reclaimed += entry.size;
+                }
+            }
+            if (available + reclaimed < candidate.size)
+            {
+                continue;
+            }
+
+            for (uint32_t victim : victims)
+            {
+                Demote(victim);
+                moves++;
+            }
+            available = QueryAvailable();
+            if (available < candidate.size)
+            {
+                continue;
+            }
+        }
+
+        if (Place(*it, HostMemoryPool::CpuVisibleVidmem))
+        {
+            m_stats.promotions++;
+            moves++;
+        }
+    }
+
+    m_lastRebalance = m_clock;
+    return moves;
+}
+
+HostVidmemStats HostVidmemManager::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
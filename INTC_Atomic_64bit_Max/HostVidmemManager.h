@@ -0,0 +1,142 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Placement policy for CPU-visible buffers (upload and readback). Buffers go
+// to CPU-visible video memory while the budget reported by
+// INTC_D3D12_QueryCpuVisibleVidmem allows it and to system memory otherwise.
+// When the budget shrinks, or a hot system buffer needs room, the least
+// recently used video memory buffers are demoted. This file holds the policy
+// only, with no D3D12 dependency; CpuVisibleBufferManager wraps it for the
+// device, and HostSimulatedVidmemBudget drives it offline.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <vector>
+
+enum class HostMemoryPool
+{
+    System,
+    CpuVisibleVidmem,
+};
+
+enum class HostBufferKind
+{
+    Upload,
+    Readback,
+};
+
+const char* HostMemoryPoolName(HostMemoryPool pool);
+
+class HostVidmemBudgetProvider
+{
+public:
+    virtual ~HostVidmemBudgetProvider() {}
+
+    // Total and free bytes of CPU-visible video memory.
+    virtual void Query(uint64_t* totalBytes, uint64_t* freeBytes) = 0;
+};
+
+// A budget that only changes through Commit/Decommit and SetExternalUsage, the
+// latter standing in for other applications. Thread safe.
+class HostSimulatedVidmemBudget : public HostVidmemBudgetProvider
+{
+public:
+    explicit HostSimulatedVidmemBudget(uint64_t totalBytes);
+
+    void Query(uint64_t* totalBytes, uint64_t* freeBytes) override;
+
+    // Returns false, committing nothing, when fewer than bytes are free.
+    bool Commit(uint64_t bytes);
+    void Decommit(uint64_t bytes);
+
+    void SetExternalUsage(uint64_t bytes);
+
+private:
+    mutable std::mutex m_mutex;
+    uint64_t m_totalBytes;
+    uint64_t m_committedBytes;
+    uint64_t m_externalBytes;
+};
+
+struct HostVidmemStats
+{
+    uint64_t vidmemBytes;
+    uint64_t systemBytes;
+    uint64_t vidmemBuffers;
+    uint64_t systemBuffers;
+    uint64_t fallbacks;     // Allocations that went to system memory.
+    uint64_t demotions;
+    uint64_t promotions;
+};
+
+class HostVidmemManager
+{
+public:
+    static const uint32_t InvalidBuffer = ~0u;
+    static const uint64_t DefaultHeadroom = 16ull * 1024 * 1024;
+
+    // Creates the backing of buffer in pool, replacing any previous backing
+    // (contents are not preserved). Returns false, keeping the previous
+    // backing, when video memory creation fails; system memory creation
+    // reports failure by throwing. Runs under the manager lock.
+    typedef std::function<bool(uint32_t buffer, uint64_t size, HostBufferKind kind, HostMemoryPool pool)> PlaceCallback;
+    typedef std::function<void(uint32_t buffer)> ReleaseCallback;
+
+    // headroom bytes of CPU-visible video memory are always left free.
+    HostVidmemManager(HostVidmemBudgetProvider& budget, PlaceCallback place,
+        ReleaseCallback release = ReleaseCallback(), uint64_t headroom = DefaultHeadroom);
+
+    // Places the buffer in video memory when it fits within the budget and in
+    // system memory otherwise. Never moves other buffers.
+    uint32_t Allocate(uint64_t size, HostBufferKind kind);
+    void Free(uint32_t buffer);
+
+    // Marks the buffer as used now, making it the most recently used.
+    void Touch(uint32_t buffer);
+
+    HostMemoryPool GetPool(uint32_t buffer) const;
+
+    // Demotes least recently used video memory buffers while the budget is
+    // exceeded, then promotes system buffers touched since the previous
+    // Rebalance, most recent first, demoting buffers used less recently than
+    // them to make room. Moves recreate backings, so call this only when the
+    // GPU is not using any managed buffer. Returns the number of moves.
+    uint32_t Rebalance();
+
+    HostVidmemStats GetStats() const;
+
+private:
+    struct Buffer
+    {
+        uint64_t size;
+        uint64_t lastUse;
+        HostBufferKind kind;
+        HostMemoryPool pool;
+        bool live;
+        std::list<uint32_t>::iterator lru;
+    };
+
+    uint64_t QueryAvailable() const;
+    bool Place(uint32_t buffer, HostMemoryPool pool);
+    void Demote(uint32_t buffer);
+
+    mutable std::mutex m_mutex;
+    HostVidmemBudgetProvider& m_budget;
+    PlaceCallback m_place;
+    ReleaseCallback m_release;
+    uint64_t m_headroom;
+
+    std::vector<Buffer> m_buffers;
+    std::vector<uint32_t> m_freeBuffers;   // Indices available for reuse.
+    std::list<uint32_t> m_lru;             // Live buffers, most recently used first.
+    uint64_t m_clock;
+    uint64_t m_lastRebalance;
+
+    HostVidmemStats m_stats;
+};
@@ -0,0 +1,161 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostVisualize.h"
+#include "HostBits.h"
+#include "HostParallel.h"
+
+namespace
+{
+    const uint32_t Opaque = 0xFF000000u;
+
+    // Highest Log2 level: bit 63 with both following bits set.
+    const uint32_t MaxLogLevel = (64 << 2) | 3;
+
+    inline uint32_t PackRgb(uint32_t r, uint32_t g, uint32_t b)
+    {
+        return r | (g << 8) | (b << 16) | Opaque;
+    }
+
+    // Visualize_Ramp.
+    inline uint32_t Ramp(uint32_t t)
+    {
+        const uint32_t f = (t & 63) * 4;
+        switch (t >> 6)
+        {
+        case 0:     return PackRgb(0, f, 255);
+        case 1:     return PackRgb(0, 255, 255 - f);
+        case 2:     return PackRgb(f, 255, 0);
+        default:    return PackRgb(255, 255 - f, 0);
+        }
+    }
+
+    // Visualize_Hash (a 32-bit integer finalizer).
+    inline uint32_t Hash(uint32_t x)
+    {
+        x ^= x >> 16;
+        x *= 0x7FEB352Du;
+        x ^= x >> 15;
+        x *= 0x846CA68Bu;
+        x ^= x >> 16;
+        return x;
+    }
+}
+
+HostVisualizeConstants HostMakeVisualizeConstants(HostVisualizeMode mode, uint32_t low, uint32_t high)
+{
+    HostVisualizeConstants constants = {};
+    constants.mode = static_cast<uint32_t>(mode);
+    constants.rangeLow = low;
+    const uint32_t span = high > low ? high - low : 0;
+    while ((span >> constants.rangeShift) > 255)
+    {
+        constants.rangeShift++;
+    }
+    return constants;
+}
+
+uint32_t HostVisualizeTexel(uint64_t value, const HostVisualizeConstants& constants)
+{
+    switch (static_cast<HostVisualizeMode>(constants.mode))
+    {
+    case HostVisualizeMode::LowWord:
+    case HostVisualizeMode::HighWord:
+    {
+        const uint32_t word = static_cast<HostVisualizeMode>(constants.mode) == HostVisualizeMode::LowWord ?
+            static_cast<uint32_t>(value) : static_cast<uint32_t>(value >> 32);
+        const uint32_t offset = word > constants.rangeLow ? word - constants.rangeLow : 0;
+        const uint32_t t = offset >> constants.rangeShift;
+        return Ramp(t < 255 ? t : 255);
+    }
+
+    case HostVisualizeMode::Log2:
+    {
+        uint32_t level = 0;
+        if (value != 0)
+        {
+            const uint32_t bit = HighestBit(value);
+            const uint32_t next = bit >= 2 ? static_cast<uint32_t>(value >> (bit - 2)) & 3 : static_cast<uint32_t>(value << (2 - bit)) & 3;
+            level = ((bit + 1) << 2) | next;
+        }
+        return Ramp(level * 255 / MaxLogLevel);
+    }
+
+    case HostVisualizeMode::IdHash:
+        if (value == 0)
+        {
+            return Opaque;
+        }
+        return (Hash(static_cast<uint32_t>(value) ^ Hash(static_cast<uint32_t>(value >> 32))) & 0x00FFFFFFu) | Opaque;
+    }
+    return Opaque;
+}
+
+void HostVisualizeSurface(uint32_t* rgba, size_t rgbaPitch, const uint64_t* texels, size_t rowPitch,
+    uint32_t width, uint32_t height, const HostVisualizeConstants& constants, uint32_t workerCount)
+{
+    workerCount = HostWorkersForBytes(static_cast<size_t>(width) * height * sizeof(uint64_t), workerCount);
+
+    // The ramp and log modes have few distinct colors; look them up rather
+    // than branch per texel. The tables hold HostVisualizeTexel's results.
+    uint32_t ramp[256];
+    for (uint32_t t = 0; t < 256; t++)
+    {
+        ramp[t] = Ramp(t);
+    }
+    uint32_t logColors[MaxLogLevel + 1];
+    for (uint32_t level = 0; level <= MaxLogLevel; level++)
+    {
+        logColors[level] = ramp[level * 255 / MaxLogLevel];
+    }
+
+    const HostVisualizeMode mode = static_cast<HostVisualizeMode>(constants.mode);
+    HostParallelRanges(height, workerCount, [&](uint32_t, size_t begin, size_t end)
+    {
+        for (size_t y = begin; y < end; y++)
+        {
+            const uint64_t* source = texels + y * rowPitch;
+            uint32_t* destination = rgba + y * rgbaPitch;
+            switch (mode)
+            {
+            case HostVisualizeMode::LowWord:
+            case HostVisualizeMode::HighWord:
+            {
+                const uint32_t wordShift = mode == HostVisualizeMode::LowWord ? 0 : 32;
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    const uint32_t word = static_cast<uint32_t>(source[x] >> wordShift);
+                    const uint32_t offset = word > constants.rangeLow ? word - constants.rangeLow : 0;
+                    const uint32_t t = offset >> constants.rangeShift;
+                    destination[x] = ramp[t < 255 ? t : 255];
+                }
+                break;
+            }
+
+            case HostVisualizeMode::Log2:
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    const uint64_t value = source[x];
+                    uint32_t level = 0;
+                    if (value != 0)
+                    {
+                        const uint32_t bit = HighestBit(value);
+                        const uint32_t next = bit >= 2 ? static_cast<uint32_t>(value >> (bit - 2)) & 3 : static_cast<uint32_t>(value << (2 - bit)) & 3;
+                        level = ((bit + 1) << 2) | next;
+                    }
+                    destination[x] = logColors[level];
+                }
+                break;
+
+            default:
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    destination[x] = HostVisualizeTexel(source[x], constants);
+                }
+                break;
+            }
+        }
+    });
+}
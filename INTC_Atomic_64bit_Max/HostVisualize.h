@@ -0,0 +1,53 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Conversion of 64-bit atomic results to RGBA8 for display, bit for bit the
+// same as Visualize.hlsl, so GPU output can be checked or reproduced
+// headless. Every mode is integer arithmetic down to the final 8-bit channel
+// values; the shader writes them as byte / 255.0 to a UNORM target, which
+// converts back exactly.
+//
+//   LowWord, HighWord  the chosen 32-bit word, offset by rangeLow and shifted
+//                      right by rangeShift, clamped to 255 and false-colored;
+//   Log2               floor(log2) and the next two bits, false-colored;
+//   IdHash             a hash of the value, so equal values share a color.
+//                      Zero is black.
+//
+// The false-color ramp runs blue, cyan, green, yellow, red in four equal
+// steps. Texels pack as R | G << 8 | B << 16 | A << 24 (R8G8B8A8 in memory).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum class HostVisualizeMode : uint32_t
+{
+    LowWord,
+    HighWord,
+    Log2,
+    IdHash,
+};
+
+// Root constants of Visualize.hlsl, in register order.
+struct HostVisualizeConstants
+{
+    uint32_t mode;          // HostVisualizeMode.
+    uint32_t rangeLow;
+    uint32_t rangeShift;
+    uint32_t reserved;
+};
+
+static const uint32_t HostVisualizeConstantCount = sizeof(HostVisualizeConstants) / sizeof(uint32_t);
+
+// Constants that spread word values in [low, high] over the ramp.
+HostVisualizeConstants HostMakeVisualizeConstants(HostVisualizeMode mode, uint32_t low = 0, uint32_t high = 0xFFFFFFFF);
+
+uint32_t HostVisualizeTexel(uint64_t value, const HostVisualizeConstants& constants);
+
+// Converts width x height texels, rowPitch texels apart, into rgba, rgbaPitch
+// texels apart. A workerCount of zero uses HostWorkerCount() threads.
+void HostVisualizeSurface(uint32_t* rgba, size_t rgbaPitch, const uint64_t* texels, size_t rowPitch,
+    uint32_t width, uint32_t height, const HostVisualizeConstants& constants, uint32_t workerCount = 0);
@@ -0,0 +1,43 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "HostVolume.h"
+
+#include <stdexcept>
+
+const char* HostVolumeMappingName(HostVolumeMapping mapping)
+{
+    switch (mapping)
+    {
+    case HostVolumeMapping::SliceTiled:         return "slice-tiled";
+    case HostVolumeMapping::SliceTiledMorton:   return "slice-tiled morton";
+    }
+    return "unknown";
+}
+
+const HostVolumeLayout& HostAtomicVolume64::Validate(const HostVolumeLayout& layout)
+{
+    if (!layout.IsValid())
+    {
+        throw std::invalid_argument("HostAtomicVolume64: invalid volume layout");
+    }
+    return layout;
+}
+
+HostAtomicVolume64::HostAtomicVolume64(const HostVolumeLayout& layout, HostArena* arena) :
+    m_layout(Validate(layout)),
+    m_surface(layout.SurfaceWidth(), layout.SurfaceHeight(), arena),
+    m_sliceOrigins(layout.depth),
+    m_morton(layout.mapping == HostVolumeMapping::SliceTiledMorton),
+    m_squareBits(HostFloorLog2(layout.width < layout.height ? layout.width : layout.height)),
+    m_squareMask((1u << m_squareBits) - 1),
+    m_widthBits(HostFloorLog2(layout.width)),
+    m_widthMask(layout.width - 1)
+{
+    for (uint32_t z = 0; z < layout.depth; z++)
+    {
+        m_sliceOrigins[z] = layout.Address(0, 0, z);
+    }
+}
@@ -0,0 +1,184 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// Volumetric (3D) grids on top of 2D 64-bit atomic surfaces. The extension
+// has no 3D surface support, so the z slices of a width x height x depth grid
+// are tiled over one Texture2D, slicesPerRow slices per row of slices:
+//
+//   +-------+-------+-------+-------+
+//   | z = 0 | z = 1 | z = 2 | z = 3 |
+//   +-------+-------+-------+-------+
+//   | z = 4 | z = 5 | ...
+//
+// Within a slice texels are either row-major (SliceTiled) or in Morton order
+// (SliceTiledMorton), which keeps 2D neighbourhoods within a few cache lines.
+// AtomicVolume.hlsl implements the same mapping for shaders.
+
+#pragma once
+
+#include "HostAtomics64.h"
+
+#include <vector>
+
+enum class HostVolumeMapping : uint32_t
+{
+    SliceTiled,         // Row-major texels within each slice.
+    SliceTiledMorton,   // Morton (Z-order) texels within each slice; power-of-two width and height.
+};
+
+const char* HostVolumeMappingName(HostVolumeMapping mapping);
+
+// Spreads the low 16 bits of value to the even bit positions.
+constexpr uint32_t HostMortonSpread(uint32_t value)
+{
+    value &= 0xFFFF;
+    value = (value | (value << 8)) & 0x00FF00FF;
+    value = (value | (value << 4)) & 0x0F0F0F0F;
+    value = (value | (value << 2)) & 0x33333333;
+    value = (value | (value << 1)) & 0x55555555;
+    return value;
+}
+
+constexpr uint32_t HostMorton2(uint32_t x, uint32_t y)
+{
+    return HostMortonSpread(x) | (HostMortonSpread(y) << 1);
+}
+
+constexpr uint32_t HostFloorLog2(uint32_t value)
+{
+    uint32_t log = 0;
+    while (value > 1)
+    {
+        value >>= 1;
+        log++;
+    }
+    return log;
+}
+
+struct HostVolumeLayout
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t slicesPerRow;
+    HostVolumeMapping mapping;
+
+    static constexpr uint32_t MaxDimension = 16384;    // D3D12 2D texture limit.
+
+    constexpr uint32_t SliceRows() const        { return (depth + slicesPerRow - 1) / slicesPerRow; }
+    constexpr uint32_t SurfaceWidth() const     { return width * slicesPerRow; }
+    constexpr uint32_t SurfaceHeight() const    { return height * SliceRows(); }
+
+    // Position of (x, y) within its slice.
+    constexpr HostTexelCoord SliceTexel(uint32_t x, uint32_t y) const
+    {
+        if (mapping == HostVolumeMapping::SliceTiled)
+        {
+            return HostTexelCoord{ x, y };
+        }
+
+        // Interleave the bits both coordinates have, then append the extra
+        // high bits of the longer side so the index stays dense for
+        // non-square slices.
+        const uint32_t squareBits = HostFloorLog2(width < height ? width : height);
+        const uint32_t squareMask = (1u << squareBits) - 1;
+        const uint32_t index = HostMorton2(x & squareMask, y & squareMask) | (((x | y) >> squareBits) << (2 * squareBits));
+        return HostTexelCoord{ index & (width - 1), index >> HostFloorLog2(width) };
+    }
+
+    constexpr HostTexelCoord Address(uint32_t x, uint32_t y, uint32_t z) const
+    {
+        const HostTexelCoord texel = SliceTexel(x, y);
+        return HostTexelCoord{ (z % slicesPerRow) * width + texel.x, (z / slicesPerRow) * height + texel.y };
+    }
+
+    constexpr bool IsValid() const
+    {
+        return width != 0 && height != 0 && depth != 0 && slicesPerRow != 0 &&
+            SurfaceWidth() <= MaxDimension && SurfaceHeight() <= MaxDimension &&
+            (mapping == HostVolumeMapping::SliceTiled ||
+                ((width & (width - 1)) == 0 && (height & (height - 1)) == 0 && width <= 65536 && height <= 65536));
+    }
+};
+
+// Layout with slicesPerRow chosen to keep the surface as close to square as
+// possible.
+constexpr HostVolumeLayout HostMakeVolumeLayout(uint32_t width, uint32_t height, uint32_t depth, HostVolumeMapping mapping)
+{
+    uint32_t bestSlicesPerRow = 1;
+    uint64_t bestEdge = ~0ull;
+    for (uint32_t slicesPerRow = 1; slicesPerRow <= depth; slicesPerRow++)
+    {
+        const uint64_t surfaceWidth = static_cast<uint64_t>(width) * slicesPerRow;
+        const uint64_t surfaceHeight = static_cast<uint64_t>(height) * ((depth + slicesPerRow - 1) / slicesPerRow);
+        const uint64_t edge = surfaceWidth > surfaceHeight ? surfaceWidth : surfaceHeight;
+        if (edge < bestEdge)
+        {
+            bestEdge = edge;
+            bestSlicesPerRow = slicesPerRow;
+        }
+    }
+    return HostVolumeLayout{ width, height, depth, bestSlicesPerRow, mapping };
+}
+
+// 3D atomic grid stored in a HostAtomicSurface64 through a HostVolumeLayout.
+class HostAtomicVolume64
+{
+public:
+    // Throws std::invalid_argument when the layout is invalid.
+    explicit HostAtomicVolume64(const HostVolumeLayout& layout, HostArena* arena = nullptr);
+
+    const HostVolumeLayout& GetLayout() const   { return m_layout; }
+    HostAtomicSurface64& GetSurface()           { return m_surface; }
+
+    uint64_t Load(uint32_t x, uint32_t y, uint32_t z) const
+    {
+        const HostTexelCoord texel = Address(x, y, z);
+        return m_surface.Load(texel.x, texel.y);
+    }
+
+    void Store(uint32_t x, uint32_t y, uint32_t z, uint64_t value)
+    {
+        const HostTexelCoord texel = Address(x, y, z);
+        m_surface.Store(texel.x, texel.y, value);
+    }
+
+    uint64_t Apply(HostAtomicOp op, uint32_t x, uint32_t y, uint32_t z, uint64_t value, uint64_t xchgValue = 0)
+    {
+        const HostTexelCoord texel = Address(x, y, z);
+        return m_surface.Apply(op, texel.x, texel.y, value, xchgValue);
+    }
+
+    uint64_t InterlockedAdd(uint32_t x, uint32_t y, uint32_t z, uint64_t value)   { return Apply(HostAtomicOp::Add, x, y, z, value); }
+    uint64_t InterlockedMin(uint32_t x, uint32_t y, uint32_t z, uint64_t value)   { return Apply(HostAtomicOp::Min, x, y, z, value); }
+    uint64_t InterlockedMax(uint32_t x, uint32_t y, uint32_t z, uint64_t value)   { return Apply(HostAtomicOp::Max, x, y, z, value); }
+
+    void Clear(uint64_t value)  { m_surface.Clear(value); }
+
+    // Same result as GetLayout().Address, with the slice origins and Morton
+    // shifts precomputed so no division or log2 is left on the hot path.
+    HostTexelCoord Address(uint32_t x, uint32_t y, uint32_t z) const
+    {
+        const HostTexelCoord origin = m_sliceOrigins[z];
+        if (!m_morton)
+        {
+            return HostTexelCoord{ origin.x + x, origin.y + y };
+        }
+        const uint32_t index = HostMorton2(x & m_squareMask, y & m_squareMask) | (((x | y) >> m_squareBits) << (2 * m_squareBits));
+        return HostTexelCoord{ origin.x + (index & m_widthMask), origin.y + (index >> m_widthBits) };
+    }
+
+private:
+    static const HostVolumeLayout& Validate(const HostVolumeLayout& layout);
+
+    HostVolumeLayout m_layout;
+    HostAtomicSurface64 m_surface;
+    std::vector<HostTexelCoord> m_sliceOrigins;
+    bool m_morton;
+    uint32_t m_squareBits;
+    uint32_t m_squareMask;
+    uint32_t m_widthBits;
+    uint32_t m_widthMask;
+};
@@ -11,6 +11,7 @@
 
 #include "stdafx.h"
 #include "INTC_Atomics_64bit_Max.h"
+#include "HostBenchmarks.h"
 
 INTC_Atomics_64bit_Max::INTC_Atomics_64bit_Max(UINT width, UINT height, std::wstring name) :
     DXSample(width, height, name),
@@ -23,8 +24,29 @@ INTC_Atomics_64bit_Max::INTC_Atomics_64bit_Max(UINT width, UINT height, std::wst
 
 void INTC_Atomics_64bit_Max::OnInit()
 {
-    LoadPipeline();
-    LoadAssets();
+    if (m_runHostBenchmarks)
+    {
+        const int failedChecks = RunHostBenchmarks(nullptr);
+        if (failedChecks > 0)
+        {
+            printf("ERROR: %d host benchmark checks failed\n", failedChecks);
+        }
+    }
+
+    if (m_useTimeline)
+    {
+        m_timeline.reset(new HostFrameTimeline({ "LoadPipeline", "LoadAssets", "Record", "RecordPass",
+            "Submit", "Present", "FenceWait", "ReadbackMap" }));
+    }
+
+    {
+        HostTimelineScope scope(m_timeline.get(), LoadPipelinePhase);
+        LoadPipeline();
+    }
+    {
+        HostTimelineScope scope(m_timeline.get(), LoadAssetsPhase);
+        LoadAssets();
+    }
 }
 
 
@@ -206,6 +228,18 @@ void INTC_Atomics_64bit_Max::LoadPipeline()
     swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
     swapChainDesc.SampleDesc.Count = 1;
 
+    // Uncapped frames present without waiting for vertical blank only when
+    // the swap chain allows tearing.
+    ComPtr<IDXGIFactory5> factory5;
+    BOOL allowTearing = FALSE;
+    if (m_presentMode == HostPresentMode::Uncapped && SUCCEEDED(factory.As(&factory5)) &&
+        SUCCEEDED(factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing))) &&
+        allowTearing)
+    {
+        m_tearingSupported = true;
+        swapChainDesc.Flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+    }
+
     ComPtr<IDXGISwapChain1> swapChain;
     ThrowIfFailed(factory->CreateSwapChainForHwnd(
         m_commandQueue.Get(),        // Swap chain needs the queue so that it can force a flush on it.
@@ -231,12 +265,8 @@ void INTC_Atomics_64bit_Max::LoadPipeline()
         rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
         ThrowIfFailed(m_device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&m_rtvHeap)));
 
-        // Describe and create a shader resource view (SRV) heap for the texture.
-        D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
-        srvHeapDesc.NumDescriptors = 1;
-        srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-        srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-        ThrowIfFailed(m_device->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&m_srvHeap)));
+        // One shader-visible heap holds the texture SRV and the compute UAVs.
+        m_descriptorHeap.reset(new ShaderVisibleDescriptorHeap(m_device.Get(), FrameCount));
 
         m_rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 
@@ -259,17 +289,6 @@ void INTC_Atomics_64bit_Max::LoadPipeline()
     ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_commandAllocator)));
 
 #ifdef INTC_EXTENSIONS
-    // Create UAV descriptor heap for compute pipeline.
-    {
-        // Describe and create a UAV descriptor heap.
-        D3D12_DESCRIPTOR_HEAP_DESC uavHeapDesc = {};
-        uavHeapDesc.NumDescriptors = 1;
-        uavHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-        uavHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-        ThrowIfFailed(m_device->CreateDescriptorHeap(&uavHeapDesc, IID_PPV_ARGS(&m_computeUAVHeap)));
-        NAME_D3D12_OBJECT(m_computeUAVHeap);
-    }
-
     bool bInitIntelExtensions = false;
     bInitIntelExtensions = InitINTCExtensions();
 
@@ -472,7 +491,9 @@ void INTC_Atomics_64bit_Max::LoadAssets()
         srvDesc.Format = textureDesc.Format;
         srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
         srvDesc.Texture2D.MipLevels = 1;
-        m_device->CreateShaderResourceView(m_texture.Get(), &srvDesc, m_srvHeap->GetCPUDescriptorHandleForHeapStart());
+        m_srvTable = m_descriptorHeap->AllocatePersistent(1);
+        m_device->CreateShaderResourceView(m_texture.Get(), &srvDesc, m_descriptorHeap->GetPersistentCpuHandle(m_srvTable.base));
+        m_descriptorHeap->UpdatePersistent(m_srvTable);
     }
     
 #ifdef INTC_EXTENSIONS
@@ -480,11 +501,15 @@ void INTC_Atomics_64bit_Max::LoadAssets()
     // Create compute root signature
     {
         CD3DX12_DESCRIPTOR_RANGE1 descRange[2] = {};
-        descRange[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
-        descRange[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 7, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+        // The extension UAV (u7) uses the table's reserved slot after the resources.
+        descRange[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, ComputeUAVCount, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+        descRange[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 7, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, ComputeUAVCount);
 
-        CD3DX12_ROOT_PARAMETER1 rootParameters[1] = {};
+        // b0 is CSMain's view rectangle, b1 the Visualize.hlsl constants.
+        CD3DX12_ROOT_PARAMETER1 rootParameters[3] = {};
         rootParameters[0].InitAsDescriptorTable(_countof(descRange), descRange, D3D12_SHADER_VISIBILITY_ALL);
+        rootParameters[1].InitAsConstants(HostViewConstantCount, 0, 0, D3D12_SHADER_VISIBILITY_ALL);
+        rootParameters[2].InitAsConstants(HostVisualizeConstantCount, 1, 0, D3D12_SHADER_VISIBILITY_ALL);
 
         CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
         rootSignatureDesc.Init_1_1(_countof(rootParameters), rootParameters, 0, nullptr);
@@ -543,6 +568,74 @@ void INTC_Atomics_64bit_Max::LoadAssets()
         }
 
         NAME_D3D12_OBJECT(m_computePipelineState);
+
+        // The visualization pass shares the compute root signature.
+        ComPtr<ID3DBlob> visualizeShader;
+        ThrowIfFailed(D3DCompileFromFile(GetAssetFullPath(L"Visualize.hlsl").c_str(), nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, "VisualizeMain", "cs_5_1", compileFlags, 0, &visualizeShader, nullptr));
+        psoDesc.CS = CD3DX12_SHADER_BYTECODE(visualizeShader.Get());
+        ThrowIfFailed(m_device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&m_visualizePipelineState)));
+
+        NAME_D3D12_OBJECT(m_visualizePipelineState);
+    }
+
+    // Select the compute view; invalid rectangles fall back to the whole surface.
+    if (m_viewWidth != 0 && m_viewHeight != 0 &&
+        m_viewOriginX < TEX_WIDTH && m_viewWidth <= TEX_WIDTH - m_viewOriginX &&
+        m_viewOriginY < TEX_HEIGHT && m_viewHeight <= TEX_HEIGHT - m_viewOriginY)
+    {
+        m_computeView = { m_viewOriginX, m_viewOriginY, m_viewWidth, m_viewHeight };
+    }
+    else
+    {
+        m_computeView = { 0, 0, TEX_WIDTH, TEX_HEIGHT };
+    }
+    printf("Compute view: origin (%u, %u), extent %u x %u\n",
+        m_computeView.originX, m_computeView.originY, m_computeView.width, m_computeView.height);
+
+    if (!m_dumpPath.empty())
+    {
+        char path[MAX_PATH] = {};
+        WideCharToMultiByte(CP_ACP, 0, m_dumpPath.c_str(), -1, path, _countof(path), nullptr, nullptr);
+        m_surfaceDump.reset(new HostSurfaceDumpWriter(path, m_computeView.width, m_computeView.height));
+        printf("Dumping readbacks to %s (%s I/O)\n", path, m_surfaceDump->IsUnbuffered() ? "unbuffered" : "buffered");
+    }
+
+    // A golden is a -dump of the same view; anything else is ignored.
+    if (!m_goldenPath.empty())
+    {
+        char path[MAX_PATH] = {};
+        WideCharToMultiByte(CP_ACP, 0, m_goldenPath.c_str(), -1, path, _countof(path), nullptr, nullptr);
+        m_golden.reset(new HostSurfaceDumpReader(path));
+        if (m_golden->GetRecordCount() == 0 ||
+            m_golden->GetHeader(0).width != m_computeView.width || m_golden->GetHeader(0).height != m_computeView.height)
+        {
+            printf("Golden %s does not hold a %u x %u view; not comparing\n", path, m_computeView.width, m_computeView.height);
+            m_golden.reset();
+        }
+        else
+        {
+            printf("Comparing readbacks with %s\n", path);
+        }
+    }
+
+    // Select the visualization; word modes spread the full 32-bit range.
+    {
+        static const struct { const wchar_t* name; HostVisualizeMode mode; } modes[] =
+        {
+            { L"low", HostVisualizeMode::LowWord },
+            { L"high", HostVisualizeMode::HighWord },
+            { L"log", HostVisualizeMode::Log2 },
+            { L"id", HostVisualizeMode::IdHash },
+        };
+        for (const auto& entry : modes)
+        {
+            if (_wcsicmp(m_visualizeMode.c_str(), entry.name) == 0)
+            {
+                m_visualize = true;
+                m_visualizeConstants = HostMakeVisualizeConstants(entry.mode);
+                printf("Visualizing the compute texture (%ls)\n", entry.name);
+            }
+        }
     }
 
     // Create Compute Texture
@@ -574,20 +667,41 @@ void INTC_Atomics_64bit_Max::LoadAssets()
         dsResDesc1.Texture2DArrayMipPack = FALSE;
         dsResDesc1.EmulatedTyped64bitAtomics = TRUE;
 
-        INTC_D3D12_CreateCommittedResource(
-            m_pINTCExtensionContext,
-            &heap_props,
-            D3D12_HEAP_FLAGS::D3D12_HEAP_FLAG_ALLOW_SHADER_ATOMICS,
-            &dsResDesc1,
-            D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-            nullptr,
-            IID_PPV_ARGS(&m_computeBuffer)
-        );
+        if (m_useReservedResource && CreateReservedComputeTexture(texture2D))
+        {
+            // Map the tiles covered by CSMain's dispatch.
+            MapReservedTiles(m_computeView.originX, m_computeView.originY,
+                m_computeView.originX + m_computeView.width, m_computeView.originY + m_computeView.height);
+        }
+        else if (m_usePlacedResource)
+        {
+            m_surfaceHeap.reset(new AtomicSurfaceHeap(m_device.Get(), m_pINTCExtensionContext));
+            m_computeBuffer = m_surfaceHeap->CreateSurface(texture2D, D3D12_RESOURCE_STATE_UNORDERED_ACCESS).resource;
+
+            const HostHeapStats stats = m_surfaceHeap->GetStats();
+            printf("Placed compute texture: %llu bytes in %llu heap(s) of %llu bytes\n",
+                static_cast<unsigned long long>(stats.allocatedBytes),
+                static_cast<unsigned long long>(stats.heapCount),
+                static_cast<unsigned long long>(stats.heapBytes));
+        }
+        else
+        {
+            INTC_D3D12_CreateCommittedResource(
+                m_pINTCExtensionContext,
+                &heap_props,
+                D3D12_HEAP_FLAGS::D3D12_HEAP_FLAG_ALLOW_SHADER_ATOMICS,
+                &dsResDesc1,
+                D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+                nullptr,
+                IID_PPV_ARGS(&m_computeBuffer)
+            );
+        }
     }
 
     // Create a UAV resource to write to.
     {
-        CD3DX12_CPU_DESCRIPTOR_HANDLE uavHandle(m_computeUAVHeap->GetCPUDescriptorHandleForHeapStart());
+        m_computeUAVTable = m_descriptorHeap->AllocatePersistent(ComputeUAVCount);
+        const D3D12_CPU_DESCRIPTOR_HANDLE uavHandle = m_descriptorHeap->GetPersistentCpuHandle(m_computeUAVTable.base);
 
         //texture2D
         D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc2 = {};
@@ -597,6 +711,53 @@ void INTC_Atomics_64bit_Max::LoadAssets()
         uavDesc2.Texture2D.PlaneSlice = 0;
 
         m_device->CreateUnorderedAccessView(m_computeBuffer.Get(), nullptr, &uavDesc2, uavHandle);
+
+        // CSMain marks the mask whether or not -dirtytiles reads it back. The
+        // ring holds a quarter of the tiles; the rest wait for later frames.
+        const UINT tileCount = ((TEX_WIDTH + DirtyTileReadback::TileSize - 1) / DirtyTileReadback::TileSize) *
+            ((TEX_HEIGHT + DirtyTileReadback::TileSize - 1) / DirtyTileReadback::TileSize);
+        m_dirtyTiles.reset(new DirtyTileReadback(m_device.Get(), m_pINTCExtensionContext, TEX_WIDTH, TEX_HEIGHT,
+            (tileCount + 3) / 4, FrameCount));
+        m_dirtyTiles->CreateMaskView(m_descriptorHeap->GetPersistentCpuHandle(m_computeUAVTable.base + DirtyMaskUAV));
+
+        // CSMain only writes the compute view, and with -reserved only the
+        // view's tiles are mapped; copying any other tile would read unmapped
+        // memory. Dirty tiles are 32 x 32 texels and divide the 64 KiB tiles,
+        // so every tile the view touches lies in a mapped one.
+        m_dirtyTiles->SetInitialRect(m_computeView.originX, m_computeView.originY,
+            m_computeView.originX + m_computeView.width, m_computeView.originY + m_computeView.height);
+
+        // The visualization target always has a view, so the table never
+        // holds a null descriptor the driver would have to validate.
+        D3D12_RESOURCE_DESC visualizeDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, TEX_WIDTH, TEX_HEIGHT,
+            1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+        ThrowIfFailed(m_device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+            D3D12_HEAP_FLAG_NONE,
+            &visualizeDesc,
+            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+            nullptr,
+            IID_PPV_ARGS(&m_visualizeTexture)));
+        NAME_D3D12_OBJECT(m_visualizeTexture);
+
+        D3D12_UNORDERED_ACCESS_VIEW_DESC visualizeUavDesc = {};
+        visualizeUavDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        visualizeUavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+        m_device->CreateUnorderedAccessView(m_visualizeTexture.Get(), nullptr, &visualizeUavDesc,
+            m_descriptorHeap->GetPersistentCpuHandle(m_computeUAVTable.base + VisualizeUAV));
+        m_descriptorHeap->UpdatePersistent(m_computeUAVTable);
+
+        // Show it in place of the checkerboard.
+        if (m_visualize)
+        {
+            D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+            srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+            srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+            srvDesc.Texture2D.MipLevels = 1;
+            m_device->CreateShaderResourceView(m_visualizeTexture.Get(), &srvDesc, m_descriptorHeap->GetPersistentCpuHandle(m_srvTable.base));
+            m_descriptorHeap->UpdatePersistent(m_srvTable);
+        }
     }
 
     // Create the readback buffer.
@@ -609,10 +770,12 @@ void INTC_Atomics_64bit_Max::LoadAssets()
         HeapProps.CreationNodeMask = 1;
         HeapProps.VisibleNodeMask = 1;
 
-        // Readback buffers must be 1-dimensional, i.e. "buffer" not "texture2d"
+        // Readback buffers must be 1-dimensional, i.e. "buffer" not "texture2d".
+        // Sized from the view's footprint: rows padded to the 256-byte pitch
+        // can need more than width * height texels.
         D3D12_RESOURCE_DESC ResourceDesc = {};
         ResourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-        ResourceDesc.Width = TEX_WIDTH * TEX_HEIGHT * 4 * 2;  //note that i'd expect to call this an R32_UINT but instead have to do this, cause WTF DX , must be bytes
+        ResourceDesc.Width = PlanViewReadback();
         ResourceDesc.Height = 1;
         ResourceDesc.DepthOrArraySize = 1;
         ResourceDesc.MipLevels = 1;
@@ -622,12 +785,37 @@ void INTC_Atomics_64bit_Max::LoadAssets()
         ResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
         ResourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
 
-        ThrowIfFailed(m_device->CreateCommittedResource(&HeapProps, D3D12_HEAP_FLAG_NONE, &ResourceDesc,
-            D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&m_readbackBuffer)));
-
+        if (m_useCpuVisibleVidmem)
+        {
+            m_bufferManager.reset(new CpuVisibleBufferManager(m_device.Get(), m_pINTCExtensionContext));
+            m_readbackBufferHandle = m_bufferManager->CreateBuffer(ResourceDesc.Width, HostBufferKind::Readback);
+            m_readbackBuffer = m_bufferManager->GetResource(m_readbackBufferHandle);
+            printf("Readback buffer: %s\n", HostMemoryPoolName(m_bufferManager->GetPool(m_readbackBufferHandle)));
+        }
+        else
+        {
+            ThrowIfFailed(m_device->CreateCommittedResource(&HeapProps, D3D12_HEAP_FLAG_NONE, &ResourceDesc,
+                D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&m_readbackBuffer)));
+        }
      }
 #endif
 
+    // Create the bundles, closed; RecordBundles fills them.
+    {
+        ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_BUNDLE, IID_PPV_ARGS(&m_bundleAllocator)));
+        ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_BUNDLE, m_bundleAllocator.Get(), m_pipelineState.Get(), IID_PPV_ARGS(&m_drawBundle)));
+        ThrowIfFailed(m_drawBundle->Close());
+        NAME_D3D12_OBJECT(m_drawBundle);
+#ifdef INTC_EXTENSIONS
+        ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_BUNDLE, m_bundleAllocator.Get(), m_computePipelineState.Get(), IID_PPV_ARGS(&m_computeBundle)));
+        ThrowIfFailed(m_computeBundle->Close());
+        NAME_D3D12_OBJECT(m_computeBundle);
+#endif
+        RecordBundles();
+    }
+
+    PlanFramePasses();
+
     // Close the command list and execute it to begin the initial GPU setup.
     ThrowIfFailed(m_commandList->Close());
     ID3D12CommandList* ppCommandLists[] = { m_commandList.Get() };
@@ -652,6 +840,191 @@ void INTC_Atomics_64bit_Max::LoadAssets()
     }
 }
 
+// Records the triangle draw and the CSMain dispatch. Called with the GPU idle,
+// as the bundle allocator is reset.
+void INTC_Atomics_64bit_Max::RecordBundles()
+{
+    ID3D12DescriptorHeap* ppHeaps[] = { m_descriptorHeap->GetHeap() };
+    m_bundleHeap = ppHeaps[0];
+    ThrowIfFailed(m_bundleAllocator->Reset());
+
+    ThrowIfFailed(m_drawBundle->Reset(m_bundleAllocator.Get(), m_pipelineState.Get()));
+    m_drawBundle->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+    m_drawBundle->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    m_drawBundle->IASetVertexBuffers(0, 1, &m_vertexBufferView);
+    m_drawBundle->DrawInstanced(3, 1, 0, 0);
+    ThrowIfFailed(m_drawBundle->Close());
+
+#ifdef INTC_EXTENSIONS
+    ThrowIfFailed(m_computeBundle->Reset(m_bundleAllocator.Get(), m_computePipelineState.Get()));
+    m_computeBundle->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+    m_computeBundle->Dispatch((m_computeView.width + 31) / 32, (m_computeView.height + 31) / 32, 1);
+    ThrowIfFailed(m_computeBundle->Close());
+#endif
+}
+
+// Creates the pass lists and allocators, and works out the order the
+// passes this run records are submitted in.
+void INTC_Atomics_64bit_Max::PlanFramePasses()
+{
+    m_recordWorkers = m_recordThreads < MaxRecordingWorkers ? m_recordThreads : MaxRecordingWorkers;
+    for (UINT frame = 0; frame < FrameCount; frame++)
+    {
+        for (UINT worker = 0; worker < m_recordWorkers; worker++)
+        {
+            ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_passAllocators[frame][worker])));
+        }
+    }
+
+    bool recorded[FramePassCount] = { true, false, false, false };
+#ifdef INTC_EXTENSIONS
+    recorded[ComputePass] = true;
+    recorded[ReadbackPass] = !m_useDirtyTiles;
+    recorded[VisualizePass] = m_visualize;
+#endif
+
+    // By FramePass. VisualizePass overwrites what DrawPass samples, so it
+    // must not run first. Leaving passes out of a valid order keeps it valid.
+    const std::vector<std::vector<uint32_t>> dependencies =
+    {
+        {},
+        {},
+        { ComputePass },
+        { DrawPass, ComputePass },
+    };
+    m_framePasses.clear();
+    m_submission.clear();
+    for (uint32_t pass : HostSubmissionOrder(dependencies))
+    {
+        if (recorded[pass])
+        {
+            ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_passAllocators[0][0].Get(), nullptr, IID_PPV_ARGS(&m_passLists[pass])));
+            ThrowIfFailed(m_passLists[pass]->Close());
+            m_framePasses.push_back(pass);
+            m_submission.push_back(m_passLists[pass].Get());
+        }
+    }
+}
+
+#ifdef INTC_EXTENSIONS
+// Creates m_computeBuffer as a reserved resource with no tiles mapped. Returns
+// false when the device has no tiled resource support.
+bool INTC_Atomics_64bit_Max::CreateReservedComputeTexture(D3D12_RESOURCE_DESC& texture2D)
+{
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    if (FAILED(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options))) ||
+        options.TiledResourcesTier == D3D12_TILED_RESOURCES_TIER_NOT_SUPPORTED)
+    {
+        printf("Tiled resources are not supported, using a committed compute texture.\n");
+        return false;
+    }
+
+    // Reserved textures must use the 64 KiB tiled layout.
+    texture2D.Layout = D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE;
+
+    INTC_D3D12_RESOURCE_DESC_0001 dsResDesc1;
+    dsResDesc1.pD3D12Desc = &texture2D;
+    dsResDesc1.Texture2DArrayMipPack = FALSE;
+    dsResDesc1.EmulatedTyped64bitAtomics = TRUE;
+
+    ThrowIfFailed(INTC_D3D12_CreateReservedResource(
+        m_pINTCExtensionContext,
+        &dsResDesc1,
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+        nullptr,
+        IID_PPV_ARGS(&m_computeBuffer)));
+    NAME_D3D12_OBJECT(m_computeBuffer);
+
+    UINT numTiles = 0;
+    D3D12_PACKED_MIP_INFO packedMipInfo = {};
+    D3D12_SUBRESOURCE_TILING tiling = {};
+    UINT numSubresourceTilings = 1;
+    m_device->GetResourceTiling(m_computeBuffer.Get(), &numTiles, &packedMipInfo, &m_reservedTileShape, &numSubresourceTilings, 0, &tiling);
+
+    m_reservedTilesX = tiling.WidthInTiles;
+    m_reservedTilesY = tiling.HeightInTiles;
+    m_reservedTileMapped.assign(static_cast<size_t>(m_reservedTilesX) * m_reservedTilesY, false);
+    m_reservedTileHeaps.clear();
+    m_reservedHeapTilesUsed = ReservedTilesPerHeap;
+
+    printf("Reserved compute texture: %u x %u tiles of %u x %u texels.\n",
+        m_reservedTilesX, m_reservedTilesY, m_reservedTileShape.WidthInTexels, m_reservedTileShape.HeightInTexels);
+    return true;
+}
+
+// Maps every unmapped tile overlapping the texel rectangle [left, right) x
+// [top, bottom) of the reserved compute texture. Newly mapped tiles hold
+// undefined data until written; CSMain writes every texel before its atomics.
+void INTC_Atomics_64bit_Max::MapReservedTiles(UINT left, UINT top, UINT right, UINT bottom)
+{
+    std::vector<D3D12_TILED_RESOURCE_COORDINATE> coordinates;
+    std::vector<UINT> heapOffsets;
+
+    // Issues one UpdateTileMappings call for the tiles gathered for the current heap.
+    auto flush = [&]()
+    {
+        if (coordinates.empty())
+        {
+            return;
+        }
+        const UINT count = static_cast<UINT>(coordinates.size());
+        const std::vector<D3D12_TILE_REGION_SIZE> sizes(count, D3D12_TILE_REGION_SIZE{ 1, FALSE, 1, 1, 1 });
+        const std::vector<D3D12_TILE_RANGE_FLAGS> flags(count, D3D12_TILE_RANGE_FLAG_NONE);
+        const std::vector<UINT> tileCounts(count, 1);
+        m_commandQueue->UpdateTileMappings(
+            m_computeBuffer.Get(),
+            count,
+            coordinates.data(),
+            sizes.data(),
+            m_reservedTileHeaps.back().Get(),
+            count,
+            flags.data(),
+            heapOffsets.data(),
+            tileCounts.data(),
+            D3D12_TILE_MAPPING_FLAG_NONE);
+        coordinates.clear();
+        heapOffsets.clear();
+    };
+
+    const UINT tileX0 = left / m_reservedTileShape.WidthInTexels;
+    const UINT tileY0 = top / m_reservedTileShape.HeightInTexels;
+    const UINT tileX1 = min((right + m_reservedTileShape.WidthInTexels - 1) / m_reservedTileShape.WidthInTexels, m_reservedTilesX);
+    const UINT tileY1 = min((bottom + m_reservedTileShape.HeightInTexels - 1) / m_reservedTileShape.HeightInTexels, m_reservedTilesY);
+
+    for (UINT tileY = tileY0; tileY < tileY1; tileY++)
+    {
+        for (UINT tileX = tileX0; tileX < tileX1; tileX++)
+        {
+            const size_t index = static_cast<size_t>(tileY) * m_reservedTilesX + tileX;
+            if (m_reservedTileMapped[index])
+            {
+                continue;
+            }
+
+            if (m_reservedHeapTilesUsed == ReservedTilesPerHeap)
+            {
+                flush();
+
+                CD3DX12_HEAP_DESC heapDesc(
+                    ReservedTilesPerHeap * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES,
+                    D3D12_HEAP_TYPE_DEFAULT,
+                    0,
+                    D3D12_HEAP_FLAG_DENY_BUFFERS | D3D12_HEAP_FLAG_DENY_RT_DS_TEXTURES | D3D12_HEAP_FLAG_ALLOW_SHADER_ATOMICS);
+                ComPtr<ID3D12Heap> heap;
+                ThrowIfFailed(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap)));
+                m_reservedTileHeaps.push_back(heap);
+                m_reservedHeapTilesUsed = 0;
+            }
+
+            coordinates.push_back(CD3DX12_TILED_RESOURCE_COORDINATE(tileX, tileY, 0, 0));
+            heapOffsets.push_back(m_reservedHeapTilesUsed++);
+            m_reservedTileMapped[index] = true;
+        }
+    }
+    flush();
+}
+#endif
+
 // Generate a simple black and white checkerboard texture.
 std::vector<UINT8> INTC_Atomics_64bit_Max::GenerateTextureData()
 {
@@ -698,110 +1071,339 @@ void INTC_Atomics_64bit_Max::OnUpdate()
 // Render the scene.
 void INTC_Atomics_64bit_Max::OnRender()
 {
-    // Command list allocators can only be reset when the associated 
-    // command lists have finished execution on the GPU; apps should use 
-    // fences to determine GPU execution progress.
-    ThrowIfFailed(m_commandAllocator->Reset());
+    {
+        HostTimelineScope scope(m_timeline.get(), RecordPhase);
+
+        // Command list allocators can only be reset when the associated 
+        // command lists have finished execution on the GPU; apps should use 
+        // fences to determine GPU execution progress.
+        for (UINT worker = 0; worker < m_recordWorkers; worker++)
+        {
+            ThrowIfFailed(m_passAllocators[m_frameIndex][worker]->Reset());
+        }
+
+        // The previous frame has finished (WaitForPreviousFrame), so its ring
+        // slot can be recycled.
+        m_descriptorHeap->BeginFrame();
+
+        // Bundles name the heap they bind; record them again if it grew.
+        if (m_descriptorHeap->GetHeap() != m_bundleHeap)
+        {
+            RecordBundles();
+        }
+
+        // Record the passes concurrently, each into its own list from the
+        // allocator of the worker that takes it.
+        HostRecordPasses(static_cast<uint32_t>(m_framePasses.size()), m_recordWorkers, [&](uint32_t worker, uint32_t index)
+        {
+            HostTimelineScope passScope(m_timeline.get(), RecordPassPhase);
+            ID3D12GraphicsCommandList* commandList = m_passLists[m_framePasses[index]].Get();
+            ThrowIfFailed(commandList->Reset(m_passAllocators[m_frameIndex][worker].Get(), nullptr));
+            RecordFramePass(m_framePasses[index], commandList);
+            ThrowIfFailed(commandList->Close());
+        });
+    }
+
+    // Execute the passes, in dependency order.
+    {
+        HostTimelineScope scope(m_timeline.get(), SubmitPhase);
+        m_commandQueue->ExecuteCommandLists(static_cast<UINT>(m_submission.size()), m_submission.data());
+    }
+
+    // Present the frame.
+    {
+        HostTimelineScope scope(m_timeline.get(), PresentPhase);
+        ThrowIfFailed(m_swapChain->Present(HostSyncInterval(m_presentMode), m_tearingSupported ? DXGI_PRESENT_ALLOW_TEARING : 0));
+    }
+
+    WaitForPreviousFrame();
+
+#ifdef INTC_EXTENSIONS
+    if (m_useDirtyTiles)
+    {
+        {
+            HostTimelineScope scope(m_timeline.get(), ReadbackMapPhase);
+            m_dirtyTiles->Resolve(m_fence->GetCompletedValue());
+        }
 
-    // However, when ExecuteCommandList() is called on a particular command 
-    // list, that command list can then be reset at any time and must be before 
-    // re-recording.
-    ThrowIfFailed(m_commandList->Reset(m_commandAllocator.Get(), m_pipelineState.Get()));
+        // The mirror holds the whole surface, one frame behind.
+        const UINT64* row = m_dirtyTiles->GetMirror() +
+            static_cast<size_t>(m_computeView.originY) * m_dirtyTiles->GetMirrorPitch() + m_computeView.originX;
+        printf("the first few values are: %llu, %llu, %llu, %llu (%u dirty tiles read back)\n",
+            row[0],
+            m_computeView.width > 1 ? row[1] : 0,
+            m_computeView.width > 2 ? row[2] : 0,
+            m_computeView.width > 3 ? row[3] : 0,
+            m_dirtyTiles->GetLastTileCount());
+        PrintReadbackSummary(row, m_dirtyTiles->GetMirrorPitch(), m_computeView.width, m_computeView.height);
+        DumpView(row, m_dirtyTiles->GetMirrorPitch());
+        CompareGolden(row, m_dirtyTiles->GetMirrorPitch());
+    }
+    else
+    {
+        ReadViewReadback();
+        PrintReadbackSummary(m_readbackTexels.data(), m_computeView.width, m_computeView.width, m_computeView.height);
+        DumpView(m_readbackTexels.data(), m_computeView.width);
+        CompareGolden(m_readbackTexels.data(), m_computeView.width);
+    }
 
-    // Set necessary state.
-    m_commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+    // The GPU is idle here, so buffers can move if the budget changed.
+    if (m_bufferManager && m_bufferManager->Rebalance() != 0)
+    {
+        m_readbackBuffer = m_bufferManager->GetResource(m_readbackBufferHandle);
+        printf("Readback buffer moved to %s\n", HostMemoryPoolName(m_bufferManager->GetPool(m_readbackBufferHandle)));
+    }
+#endif
+}
 
-    ID3D12DescriptorHeap* ppHeaps[] = { m_srvHeap.Get() };
-    m_commandList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+// Records one frame pass. Passes are recorded at the same time on different
+// threads, so each sets all of its own state and changes nothing another
+// pass reads.
+void INTC_Atomics_64bit_Max::RecordFramePass(UINT pass, ID3D12GraphicsCommandList* commandList)
+{
+    // One heap for both the graphics and the compute tables.
+    ID3D12DescriptorHeap* ppHeaps[] = { m_descriptorHeap->GetHeap() };
 
-    m_commandList->SetGraphicsRootDescriptorTable(0, m_srvHeap->GetGPUDescriptorHandleForHeapStart());
+    switch (pass)
+    {
+    case DrawPass:
+    {
+        // Set necessary state.
+        commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+        commandList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+        commandList->SetGraphicsRootDescriptorTable(0, m_descriptorHeap->GetGpuHandle(m_srvTable.base));
 
-    m_commandList->RSSetViewports(1, &m_viewport);
-    m_commandList->RSSetScissorRects(1, &m_scissorRect);
+        commandList->RSSetViewports(1, &m_viewport);
+        commandList->RSSetScissorRects(1, &m_scissorRect);
 
-    // Indicate that the back buffer will be used as a render target.
-    m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_renderTargets[m_frameIndex].Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
+        // Indicate that the back buffer will be used as a render target.
+        commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_renderTargets[m_frameIndex].Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
 
-    CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart(), m_frameIndex, m_rtvDescriptorSize);
-    m_commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+        CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart(), m_frameIndex, m_rtvDescriptorSize);
+        commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
 
-    // Record commands.
-    const float clearColor[] = { 0.0f, 0.2f, 0.4f, 1.0f };
-    m_commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
-    m_commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    m_commandList->IASetVertexBuffers(0, 1, &m_vertexBufferView);
-    m_commandList->DrawInstanced(3, 1, 0, 0);
+        // Record commands.
+        const float clearColor[] = { 0.0f, 0.2f, 0.4f, 1.0f };
+        commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
+        commandList->ExecuteBundle(m_drawBundle.Get());
+
+        // Indicate that the back buffer will now be used to present.
+        commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_renderTargets[m_frameIndex].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+        break;
+    }
 
 #ifdef INTC_EXTENSIONS
-    ID3D12DescriptorHeap* ppHeapsCompute[] = { m_computeUAVHeap.Get() };
-    m_commandList->SetDescriptorHeaps(_countof(ppHeapsCompute), ppHeapsCompute);
-    m_commandList->SetPipelineState(m_computePipelineState.Get());
-    m_commandList->SetComputeRootSignature(m_computeRootSignature.Get());
-    m_commandList->SetComputeRootDescriptorTable(0, m_computeUAVHeap->GetGPUDescriptorHandleForHeapStart());
-    m_commandList->Dispatch(TEX_WIDTH / 32, TEX_HEIGHT / 32, 1);
+    case ComputePass:
+    {
+        commandList->SetComputeRootSignature(m_computeRootSignature.Get());
+        commandList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+        commandList->SetComputeRootDescriptorTable(0, m_descriptorHeap->GetGpuHandle(m_computeUAVTable.base));
+        commandList->SetComputeRoot32BitConstants(1, HostViewConstantCount, &m_computeView, 0);
+
+        // Stage the tiles earlier frames changed, before this dispatch changes
+        // them again. The mask copy stays in this pass, as only one thread may
+        // use m_dirtyTiles.
+        if (m_useDirtyTiles)
+        {
+            const UINT mask = m_computeUAVTable.base + DirtyMaskUAV;
+            m_dirtyTiles->RecordTileCopies(commandList, m_computeBuffer.Get(), m_fenceValue,
+                m_descriptorHeap->GetGpuHandle(mask), m_descriptorHeap->GetPersistentCpuHandle(mask));
+        }
+
+        commandList->ExecuteBundle(m_computeBundle.Get());
+
+        if (m_useDirtyTiles)
+        {
+            m_dirtyTiles->RecordMaskCopy(commandList);
+        }
+        break;
+    }
 
-    m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_computeBuffer.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE));
+    case ReadbackPass:
+        RecordViewReadback(commandList);
+        break;
+
+    // Resolve the whole texture for display. The triangle drawn above
+    // samples it, so what is on screen trails the atomics by a frame. Only
+    // the compute view is read; the rest is shown black.
+    case VisualizePass:
+    {
+        commandList->SetComputeRootSignature(m_computeRootSignature.Get());
+        commandList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+        commandList->SetComputeRootDescriptorTable(0, m_descriptorHeap->GetGpuHandle(m_computeUAVTable.base));
+
+        D3D12_RESOURCE_BARRIER barriers[] =
+        {
+            CD3DX12_RESOURCE_BARRIER::UAV(m_computeBuffer.Get()),
+            CD3DX12_RESOURCE_BARRIER::Transition(m_visualizeTexture.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+        };
+        commandList->ResourceBarrier(_countof(barriers), barriers);
+
+        commandList->SetPipelineState(m_visualizePipelineState.Get());
+        commandList->SetComputeRoot32BitConstants(1, HostViewConstantCount, &m_computeView, 0);
+        commandList->SetComputeRoot32BitConstants(2, HostVisualizeConstantCount, &m_visualizeConstants, 0);
+        commandList->Dispatch((TEX_WIDTH + 7) / 8, (TEX_HEIGHT + 7) / 8, 1);
+
+        commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_visualizeTexture.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+        break;
+    }
+#endif
+    }
+}
 
-    D3D12_PLACED_SUBRESOURCE_FOOTPRINT placedFootprint;
+#ifdef INTC_EXTENSIONS
+// Works out the view's readback copy once: the footprint, the copy locations
+// and the barriers around the copy. Returns the bytes the readback buffer
+// needs; RecordViewReadback fills in the buffer.
+UINT64 INTC_Atomics_64bit_Max::PlanViewReadback()
+{
     D3D12_RESOURCE_DESC texture2D;
     texture2D.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
     texture2D.Alignment = 0;
-    texture2D.Width = TEX_WIDTH;
-    texture2D.Height = TEX_HEIGHT;
+    texture2D.Width = m_computeView.width;
+    texture2D.Height = m_computeView.height;
     texture2D.DepthOrArraySize = 1;
     texture2D.MipLevels = 1;
     texture2D.Format = DXGI_FORMAT_R32G32_UINT;
     texture2D.SampleDesc.Count = 1;
-    texture2D.SampleDesc.Count = 1;
     texture2D.SampleDesc.Quality = 0;
     texture2D.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
     texture2D.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
-    //later, can use this to extract other useful info about the placedfootprint
-    m_device->GetCopyableFootprints(&texture2D, 0, 1, 0, &placedFootprint, nullptr, nullptr, nullptr);
+    // The footprint covers only the view, so only its rows are copied.
+    UINT64 totalBytes = 0;
+    m_device->GetCopyableFootprints(&texture2D, 0, 1, 0, &m_readbackFootprint, nullptr, nullptr, &totalBytes);
 
-    D3D12_TEXTURE_COPY_LOCATION src;
-    src.pResource = m_computeBuffer.Get();
-    src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-    src.SubresourceIndex = 0;
+    m_readbackSource.pResource = m_computeBuffer.Get();
+    m_readbackSource.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    m_readbackSource.SubresourceIndex = 0;
 
-    D3D12_TEXTURE_COPY_LOCATION dst;
-    dst.pResource = m_readbackBuffer.Get();
-    dst.PlacedFootprint = placedFootprint;
-    dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    m_readbackDestination.PlacedFootprint = m_readbackFootprint;
+    m_readbackDestination.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
 
-    m_commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+    m_readbackBox = {
+        m_computeView.originX, m_computeView.originY, 0,
+        m_computeView.originX + m_computeView.width, m_computeView.originY + m_computeView.height, 1 };
 
-    m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_computeBuffer.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
-#endif
+    m_readbackBarriers[0] = CD3DX12_RESOURCE_BARRIER::Transition(m_computeBuffer.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    m_readbackBarriers[1] = CD3DX12_RESOURCE_BARRIER::Transition(m_computeBuffer.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    return totalBytes;
+}
 
-    // Indicate that the back buffer will now be used to present.
-    m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_renderTargets[m_frameIndex].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+// Copies the compute view into the readback buffer.
+void INTC_Atomics_64bit_Max::RecordViewReadback(ID3D12GraphicsCommandList* commandList)
+{
+    // Rebalance may have moved the readback buffer since the last frame.
+    if (m_bufferManager)
+    {
+        m_bufferManager->Touch(m_readbackBufferHandle);
+    }
+    m_readbackDestination.pResource = m_readbackBuffer.Get();
 
-    ThrowIfFailed(m_commandList->Close());
+    commandList->ResourceBarrier(1, &m_readbackBarriers[0]);
+    commandList->CopyTextureRegion(&m_readbackDestination, 0, 0, 0, &m_readbackSource, &m_readbackBox);
+    commandList->ResourceBarrier(1, &m_readbackBarriers[1]);
+}
 
-    // Execute the command list.
-    ID3D12CommandList* ppCommandLists[] = { m_commandList.Get() };
-    m_commandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+// Unpacks the readback of RecordViewReadback after the frame has completed.
+void INTC_Atomics_64bit_Max::ReadViewReadback()
+{
+    // Rows are RowPitch bytes apart in the readback buffer; unpack them
+    // before indexing texels. The last row is not padded, and the buffer
+    // ends with it.
+    const D3D12_SUBRESOURCE_FOOTPRINT& footprint = m_readbackFootprint.Footprint;
+    const UINT64 readBytes = static_cast<UINT64>(footprint.RowPitch) * (footprint.Height - 1) + footprint.Width * sizeof(UINT64);
+    const D3D12_RANGE readRange = { static_cast<SIZE_T>(m_readbackFootprint.Offset),
+        static_cast<SIZE_T>(m_readbackFootprint.Offset + readBytes) };
+    {
+        HostTimelineScope scope(m_timeline.get(), ReadbackMapPhase);
+        UINT8* data = nullptr;
+        ThrowIfFailed(m_readbackBuffer->Map(0, &readRange, reinterpret_cast<void**>(&data)));
+        m_readbackTexels.resize(static_cast<size_t>(footprint.Width) * footprint.Height);
+        HostExtractReadback64(m_readbackTexels.data(), data + m_readbackFootprint.Offset, footprint.RowPitch,
+            footprint.Width, footprint.Height);
+        const D3D12_RANGE writeRange = { 0, 0 };
+        m_readbackBuffer->Unmap(0, &writeRange);
+    }
 
-    // Present the frame.
-    ThrowIfFailed(m_swapChain->Present(1, 0));
+    // The view may hold fewer than four texels.
+    UINT64 first[4] = {};
+    for (size_t i = 0; i < _countof(first) && i < m_readbackTexels.size(); i++)
+    {
+        first[i] = m_readbackTexels[i];
+    }
+    printf("the first few values are: %llu, %llu, %llu, %llu\n",
+        first[0],
+        first[1],
+        first[2],
+        first[3]);
+}
 
-    WaitForPreviousFrame();
+// CSMain leaves every texel of the view at all ones or zero, so the view
+// also compresses to little more than its tile directory.
+void INTC_Atomics_64bit_Max::PrintReadbackSummary(const UINT64* texels, size_t rowPitch, UINT width, UINT height)
+{
+    HostSummaryOptions options;
+    options.countValues = { ~0ull, 0 };
+    const HostSurfaceSummary summary = HostSummarizeSurface(texels, rowPitch, width, height, options);
+    printf("view summary: min %llu, max %llu, %llu all-ones and %llu zero of %llu texels\n",
+        summary.total.minValue,
+        summary.total.maxValue,
+        summary.valueCounts[0],
+        summary.valueCounts[1],
+        summary.total.count);
+
+    const HostCompressionStats compression = HostCompressSurface(m_compressedView, texels, rowPitch, width, height);
+    printf("view snapshot: %llu bytes compressed to %llu (%llu constant, %llu run-length, %llu raw tiles)\n",
+        compression.uncompressedBytes,
+        compression.compressedBytes,
+        compression.constantTiles,
+        compression.runLengthTiles,
+        compression.rawTiles);
+}
 
-#ifdef INTC_EXTENSIONS
-    uint64_t* data = nullptr;
-    ThrowIfFailed(m_readbackBuffer->Map(0, nullptr, reinterpret_cast<void**>(&data)));
+// Queues the view for the dump; frames are dropped, not waited for, while the
+// disk is behind.
+void INTC_Atomics_64bit_Max::DumpView(const UINT64* texels, size_t rowPitch)
+{
+    if (m_surfaceDump)
+    {
+        m_surfaceDump->Submit(texels, rowPitch * sizeof(UINT64), m_dumpFrame++, m_fence->GetCompletedValue());
+    }
+}
 
-    printf("the first few values are: %llu, %llu, %llu, %llu\n",
-        data[0],
-        data[1],
-        data[2],
-        data[3]);
+// Exact comparison with the golden; prints the first mismatch and the tile
+// with the most.
+void INTC_Atomics_64bit_Max::CompareGolden(const UINT64* texels, size_t rowPitch)
+{
+    if (!m_golden)
+    {
+        return;
+    }
 
-    m_readbackBuffer->Unmap(0, nullptr);
-#endif
+    HostDiffOptions options;
+    options.maxMismatches = 1;
+    HostDiffSurfaces(m_goldenDiff, texels, rowPitch, m_golden->GetTexels(0), m_golden->GetHeader(0).rowPitch / sizeof(UINT64),
+        m_computeView.width, m_computeView.height, options);
+    if (m_goldenDiff.mismatchCount == 0)
+    {
+        printf("golden: match\n");
+        return;
+    }
+
+    size_t worstTile = 0;
+    for (size_t tile = 1; tile < m_goldenDiff.tileMismatches.size(); tile++)
+    {
+        worstTile = m_goldenDiff.tileMismatches[tile] > m_goldenDiff.tileMismatches[worstTile] ? tile : worstTile;
+    }
+    const HostDiffMismatch& first = m_goldenDiff.mismatches[0];
+    printf("golden: %llu mismatches; first at (%u, %u): %llu, expected %llu; worst tile (%u, %u) with %llu\n",
+        m_goldenDiff.mismatchCount,
+        first.x, first.y, first.actual, first.golden,
+        static_cast<UINT>(worstTile % m_goldenDiff.tilesX), static_cast<UINT>(worstTile / m_goldenDiff.tilesX),
+        m_goldenDiff.tileMismatches[worstTile]);
 }
+#endif
 
 void INTC_Atomics_64bit_Max::OnDestroy()
 {
@@ -810,6 +1412,17 @@ void INTC_Atomics_64bit_Max::OnDestroy()
     WaitForPreviousFrame();
 
 #ifdef INTC_EXTENSIONS
+    if (m_surfaceDump)
+    {
+        m_surfaceDump->Flush();
+        const HostSurfaceDumpStats stats = m_surfaceDump->GetStats();
+        printf("Dump: %llu frames written, %llu dropped, %llu failed\n",
+            static_cast<unsigned long long>(stats.written),
+            static_cast<unsigned long long>(stats.dropped),
+            static_cast<unsigned long long>(stats.failed));
+        m_surfaceDump.reset();
+    }
+
     if (m_pINTCExtensionContext != nullptr)
     {
         HRESULT hr = INTC_DestroyDeviceExtensionContext(&m_pINTCExtensionContext);
@@ -823,6 +1436,44 @@ void INTC_Atomics_64bit_Max::OnDestroy()
 #endif
 
     CloseHandle(m_fenceEvent);
+
+    PrintTimeline();
+}
+
+// Prints the CPU time per phase and writes the trace (-trace path).
+void INTC_Atomics_64bit_Max::PrintTimeline()
+{
+    if (!m_timeline)
+    {
+        return;
+    }
+
+    printf("CPU timeline (us):    count       mean        p50        p99        max\n");
+    for (const HostTimelinePhaseSummary& phase : m_timeline->Summarize())
+    {
+        printf("  %-14s %9llu %10.1f %10.1f %10.1f %10.1f\n",
+            phase.name.c_str(),
+            static_cast<unsigned long long>(phase.count),
+            phase.meanMicroseconds,
+            phase.p50Microseconds,
+            phase.p99Microseconds,
+            phase.maxMicroseconds);
+    }
+
+    if (!m_tracePath.empty())
+    {
+        char path[MAX_PATH] = {};
+        WideCharToMultiByte(CP_ACP, 0, m_tracePath.c_str(), -1, path, _countof(path), nullptr, nullptr);
+        try
+        {
+            m_timeline->WriteTrace(path);
+            printf("Timeline trace written to %s\n", path);
+        }
+        catch (const std::exception& e)
+        {
+            printf("ERROR: %s\n", e.what());
+        }
+    }
 }
 
 void INTC_Atomics_64bit_Max::WaitForPreviousFrame()
@@ -840,6 +1491,7 @@ void INTC_Atomics_64bit_Max::WaitForPreviousFrame()
     // Wait until the previous frame is finished.
     if (m_fence->GetCompletedValue() < fence)
     {
+        HostTimelineScope scope(m_timeline.get(), FenceWaitPhase);
         ThrowIfFailed(m_fence->SetEventOnCompletion(fence, m_fenceEvent));
         WaitForSingleObject(m_fenceEvent, INFINITE);
     }
@@ -24,8 +24,22 @@ using namespace DirectX;
 //#define INTC_IGDEXT_D3D11
 
 #include "igdext.h"
+#include "AtomicSurfaceHeap.h"
+#include "CpuVisibleBufferManager.h"
+#include "DirtyTileReadback.h"
 #endif
 
+#include "HostFrameTimeline.h"
+#include "HostParallelRecording.h"
+#include "HostReadbackCopy.h"
+#include "HostSurfaceCompression.h"
+#include "HostSurfaceDiff.h"
+#include "HostSurfaceDump.h"
+#include "HostSurfaceStats.h"
+#include "HostSurfaceView.h"
+#include "HostVisualize.h"
+#include "ShaderVisibleDescriptorHeap.h"
+
 // Note that while ComPtr is used to manage the lifetime of resources on the CPU,
 // it has no understanding of the lifetime of resources on the GPU. Apps must account
 // for the GPU lifetime of resources to avoid destroying objects that may still be
@@ -59,13 +73,13 @@ private:
     CD3DX12_VIEWPORT m_viewport;
     CD3DX12_RECT m_scissorRect;
     ComPtr<IDXGISwapChain3> m_swapChain;
+    bool m_tearingSupported = false;    // Uncapped presents may tear.
     ComPtr<ID3D12Device> m_device;
     ComPtr<ID3D12Resource> m_renderTargets[FrameCount];
     ComPtr<ID3D12CommandAllocator> m_commandAllocator;
     ComPtr<ID3D12CommandQueue> m_commandQueue;
     ComPtr<ID3D12RootSignature> m_rootSignature;
     ComPtr<ID3D12DescriptorHeap> m_rtvHeap;
-    ComPtr<ID3D12DescriptorHeap> m_srvHeap;
     ComPtr<ID3D12PipelineState> m_pipelineState;
     ComPtr<ID3D12GraphicsCommandList> m_commandList;
     ComPtr<ID3D12Resource> m_readbackBuffer;
@@ -76,6 +90,56 @@ private:
     D3D12_VERTEX_BUFFER_VIEW m_vertexBufferView;
     ComPtr<ID3D12Resource> m_texture;
 
+    // Shader-visible CBV/SRV/UAV heap shared by all tables.
+    std::unique_ptr<ShaderVisibleDescriptorHeap> m_descriptorHeap;
+    HostDescriptorTable m_srvTable = {};
+
+    // Steady-state frame work, recorded once and replayed with ExecuteBundle.
+    // Bundles inherit the root signatures and arguments the direct list sets,
+    // which carry everything that may change per frame. They are recorded
+    // again only when the descriptor heap they were recorded with is replaced.
+    ComPtr<ID3D12CommandAllocator> m_bundleAllocator;
+    ComPtr<ID3D12GraphicsCommandList> m_drawBundle;
+    ID3D12DescriptorHeap* m_bundleHeap = nullptr;
+    void RecordBundles();
+
+    // Per-frame work, split into passes that are recorded into their own
+    // command lists on up to m_recordWorkers threads and submitted together,
+    // each after the passes it depends on. Every worker has an allocator per
+    // back buffer, reset once that frame has completed.
+    enum FramePass : UINT
+    {
+        DrawPass,       // Clear and the triangle, which samples the visualization.
+        ComputePass,    // CSMain, between the dirty-tile copies.
+        ReadbackPass,   // Copy of the view; after ComputePass.
+        VisualizePass,  // Resolve of the compute texture; after both above.
+        FramePassCount
+    };
+    static const UINT MaxRecordingWorkers = 4;
+    UINT m_recordWorkers = 1;
+    ComPtr<ID3D12CommandAllocator> m_passAllocators[FrameCount][MaxRecordingWorkers];
+    ComPtr<ID3D12GraphicsCommandList> m_passLists[FramePassCount];
+    std::vector<UINT> m_framePasses;                // Passes this run records.
+    std::vector<ID3D12CommandList*> m_submission;   // Their lists, in submission order.
+    void PlanFramePasses();
+    void RecordFramePass(UINT pass, ID3D12GraphicsCommandList* commandList);
+
+    // CPU time per phase (-timeline), or null when off.
+    enum TimelinePhase : uint32_t
+    {
+        LoadPipelinePhase,
+        LoadAssetsPhase,
+        RecordPhase,        // Allocator resets and every pass, on the render thread.
+        RecordPassPhase,    // One pass, on the worker that records it.
+        SubmitPhase,
+        PresentPhase,
+        FenceWaitPhase,
+        ReadbackMapPhase,
+        TimelinePhaseCount
+    };
+    std::unique_ptr<HostFrameTimeline> m_timeline;
+    void PrintTimeline();
+
     // Synchronization objects.
     UINT m_frameIndex;
     HANDLE m_fenceEvent;
@@ -98,9 +162,81 @@ private:
 
     ComPtr<ID3D12Resource> m_computeBuffer;
 
-    ComPtr<ID3D12DescriptorHeap> m_computeUAVHeap;
+    // Rectangle of the compute texture CSMain works on, passed as root
+    // constants (AtomicView.hlsl). Readback copies only its rows.
+    HostViewConstants m_computeView = {};
+
+    // Layout of the last readback copy, and its texels unpacked to
+    // m_computeView.width per row.
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT m_readbackFootprint = {};
+    std::vector<UINT64> m_readbackTexels;
+
+    // Readback copy of the view and its barriers, planned once.
+    D3D12_TEXTURE_COPY_LOCATION m_readbackSource = {};
+    D3D12_TEXTURE_COPY_LOCATION m_readbackDestination = {};
+    D3D12_BOX m_readbackBox = {};
+    D3D12_RESOURCE_BARRIER m_readbackBarriers[2] = {};
+
+    UINT64 PlanViewReadback();
+    void RecordViewReadback(ID3D12GraphicsCommandList* commandList);
+    void ReadViewReadback();
+    void PrintReadbackSummary(const UINT64* texels, size_t rowPitch, UINT width, UINT height);
+
+    // Compressed snapshot of the last readback, reused across frames.
+    std::vector<uint8_t> m_compressedView;
+    void DumpView(const UINT64* texels, size_t rowPitch);
+
+    // Readback dump (-dump path), written behind the frame loop.
+    std::unique_ptr<HostSurfaceDumpWriter> m_surfaceDump;
+    UINT64 m_dumpFrame = 0;
+
+    // Golden image (-golden path), mapped, and the last comparison with it.
+    std::unique_ptr<HostSurfaceDumpReader> m_golden;
+    HostSurfaceDiff m_goldenDiff = {};
+    void CompareGolden(const UINT64* texels, size_t rowPitch);
+
+    // Heaps for placed compute textures (-placed).
+    std::unique_ptr<AtomicSurfaceHeap> m_surfaceHeap;
+
+    // Readback buffer placement (-cpuvisible). m_readbackBuffer is refreshed
+    // whenever Rebalance moves it.
+    std::unique_ptr<CpuVisibleBufferManager> m_bufferManager;
+    UINT32 m_readbackBufferHandle = HostVidmemManager::InvalidBuffer;
+
+    // Incremental readback (-dirtytiles).
+    std::unique_ptr<DirtyTileReadback> m_dirtyTiles;
+
+    // Reserved compute texture (-reserved). Tiles are mapped on first use from
+    // heaps of ReservedTilesPerHeap 64 KiB tiles, so only touched regions of
+    // the surface consume video memory.
+    static const UINT ReservedTilesPerHeap = 64;
+    D3D12_TILE_SHAPE m_reservedTileShape = {};
+    UINT m_reservedTilesX = 0;
+    UINT m_reservedTilesY = 0;
+    std::vector<bool> m_reservedTileMapped;
+    std::vector<ComPtr<ID3D12Heap>> m_reservedTileHeaps;
+    UINT m_reservedHeapTilesUsed = 0;
+
+    bool CreateReservedComputeTexture(D3D12_RESOURCE_DESC& texture2D);
+    void MapReservedTiles(UINT left, UINT top, UINT right, UINT bottom);
+
+    // Compute table: ComputeUAVCount UAVs from u0 (the compute texture, the
+    // dirty-tile mask, then the visualization target), then the extension's u7.
+    static const UINT ComputeUAVCount = 3;
+    static const UINT DirtyMaskUAV = 1;
+    static const UINT VisualizeUAV = 2;
+    HostDescriptorTable m_computeUAVTable = {};
     ComPtr<ID3D12RootSignature> m_computeRootSignature;
     ComPtr<ID3D12PipelineState> m_computePipelineState;
+    ComPtr<ID3D12GraphicsCommandList> m_computeBundle;
+
+    // Display resolve of the compute texture (-visualize). The triangle
+    // samples m_visualizeTexture in place of the checkerboard, one frame
+    // behind the dispatch that wrote it.
+    bool m_visualize = false;
+    HostVisualizeConstants m_visualizeConstants = {};
+    ComPtr<ID3D12Resource> m_visualizeTexture;
+    ComPtr<ID3D12PipelineState> m_visualizePipelineState;
 
     //ComPtr<ID3D12CommandQueue> m_computeCommandQueue;
     //ComPtr<ID3D12CommandAllocator> m_computeCommandAllocator;
@@ -1,5 +1,7 @@
 #define INTEL_SHADER_EXT_UAV_SLOT u7
 #include "IntelExtensions12.hlsl"
+#include "AtomicView.hlsl"
+#include "DirtyTiles.hlsl"
 
 #define TEX_WIDTH 640
 #define TEX_HEIGHT 480
@@ -9,10 +11,15 @@ RWTexture2D<uint2> outputbuff : register(u0);
 [numthreads(32, 32, 1)]
 void CSMain(uint2 GTid : SV_GroupThreadID, uint3 DTid : SV_DispatchThreadID)
 {
-	uint2 address = uint2(DTid.x, DTid.y);
+	if (!View_Contains(DTid.xy))
+	{
+		return;
+	}
+
+	uint2 address = View_Address(DTid.xy);
 
 	uint2 value1 = uint2(TEX_HEIGHT / 2, 0);
-	uint2 value2 = uint2(DTid.y, 0);
+	uint2 value2 = uint2(address.y, 0);
 
 	outputbuff[address] = value2;
 
@@ -27,4 +34,6 @@ void CSMain(uint2 GTid : SV_GroupThreadID, uint3 DTid : SV_DispatchThreadID)
 	{
 		outputbuff[address] = uint2(0, 0);
 	}
+
+	DirtyTiles_MarkGroup(GTid, DTid.xy, viewExtent, address);
 }
@@ -0,0 +1,126 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+#include "stdafx.h"
+#include "ShaderVisibleDescriptorHeap.h"
+
+using Microsoft::WRL::ComPtr;
+
+ShaderVisibleDescriptorHeap::ShaderVisibleDescriptorHeap(ID3D12Device* device, UINT frameCount, UINT persistentBlocks, UINT ringPerFrame) :
+    m_device(device),
+    m_descriptorSize(device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)),
+    m_frameCount(frameCount),
+    m_frameNumber(0),
+    m_allocator(persistentBlocks, ringPerFrame, frameCount, HostDescriptorAllocator::DefaultBlockSize,
+        [this](uint32_t capacity, uint32_t persistentDescriptors)
+        {
+            Grow(capacity, persistentDescriptors);
+        })
+{
+}
+
+void ShaderVisibleDescriptorHeap::Grow(UINT capacity, UINT persistentDescriptors)
+{
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.NumDescriptors = capacity;
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+
+    ComPtr<ID3D12DescriptorHeap> mirror;
+    ThrowIfFailed(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&mirror)));
+    NAME_D3D12_OBJECT(mirror);
+
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    ComPtr<ID3D12DescriptorHeap> heap;
+    ThrowIfFailed(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&heap)));
+    NAME_D3D12_OBJECT(heap);
+
+    if (persistentDescriptors != 0)
+    {
+        m_device->CopyDescriptorsSimple(persistentDescriptors, mirror->GetCPUDescriptorHandleForHeapStart(),
+            m_mirror->GetCPUDescriptorHandleForHeapStart(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        m_device->CopyDescriptorsSimple(persistentDescriptors, heap->GetCPUDescriptorHandleForHeapStart(),
+            mirror->GetCPUDescriptorHandleForHeapStart(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    }
+
+    if (m_heap)
+    {
+        m_retiredHeaps.push_back(RetiredHeap{ m_frameNumber, m_heap });
+    }
+    m_heap = heap;
+    m_mirror = mirror;
+}
+
+void ShaderVisibleDescriptorHeap::WriteNullExtensionSlot(D3D12_CPU_DESCRIPTOR_HANDLE handle)
+{
+    // The extension UAV is intercepted by the driver; a null view keeps the
+    // slot defined.
+    D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+    uavDesc.Format = DXGI_FORMAT_R32_UINT;
+    uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+    m_device->CreateUnorderedAccessView(nullptr, nullptr, &uavDesc, handle);
+}
+
+HostDescriptorTable ShaderVisibleDescriptorHeap::AllocatePersistent(UINT resourceCount)
+{
+    const HostDescriptorTable table = m_allocator.AllocatePersistent(resourceCount);
+    if (!table.IsValid())
+    {
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
+    WriteNullExtensionSlot(GetPersistentCpuHandle(table.ExtensionSlot()));
+    return table;
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE ShaderVisibleDescriptorHeap::GetPersistentCpuHandle(UINT index) const
+{
+    return CD3DX12_CPU_DESCRIPTOR_HANDLE(m_mirror->GetCPUDescriptorHandleForHeapStart(), index, m_descriptorSize);
+}
+
+void ShaderVisibleDescriptorHeap::UpdatePersistent(const HostDescriptorTable& table)
+{
+    m_device->CopyDescriptorsSimple(table.DescriptorCount(),
+        CD3DX12_CPU_DESCRIPTOR_HANDLE(m_heap->GetCPUDescriptorHandleForHeapStart(), table.base, m_descriptorSize),
+        GetPersistentCpuHandle(table.base), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+HostDescriptorTable ShaderVisibleDescriptorHeap::CopyTransient(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, UINT count)
+{
+    const HostDescriptorTable table = m_allocator.AllocateTransient(count);
+    if (!table.IsValid())
+    {
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
+
+    const CD3DX12_CPU_DESCRIPTOR_HANDLE destination(m_heap->GetCPUDescriptorHandleForHeapStart(), table.base, m_descriptorSize);
+    if (count != 0)
+    {
+        m_device->CopyDescriptors(1, &destination, &count, count, sources, nullptr, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    }
+    WriteNullExtensionSlot(CD3DX12_CPU_DESCRIPTOR_HANDLE(destination, count, m_descriptorSize));
+    return table;
+}
+
+void ShaderVisibleDescriptorHeap::BeginFrame()
+{
+    m_frameNumber++;
+
+    size_t kept = 0;
+    for (RetiredHeap& retired : m_retiredHeaps)
+    {
+        if (retired.frame + m_frameCount > m_frameNumber)
+        {
+            m_retiredHeaps[kept++] = retired;
+        }
+    }
+    m_retiredHeaps.resize(kept);
+
+    m_allocator.BeginFrame();
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE ShaderVisibleDescriptorHeap::GetGpuHandle(UINT index) const
+{
+    return CD3DX12_GPU_DESCRIPTOR_HANDLE(m_heap->GetGPUDescriptorHandleForHeapStart(), index, m_descriptorSize);
+}
@@ -0,0 +1,63 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+// One shader-visible CBV/SRV/UAV heap laid out by HostDescriptorAllocator.
+// Persistent descriptors are written to a CPU-only mirror first and copied to
+// the shader-visible heap, because growth has to copy them and descriptors
+// cannot be copied out of a shader-visible heap. Replaced heaps are kept
+// until the GPU is done with the frames that used them. The extension slot of
+// every table is filled with a null UAV.
+
+#pragma once
+
+#include "HostDescriptorAllocator.h"
+
+class ShaderVisibleDescriptorHeap
+{
+public:
+    ShaderVisibleDescriptorHeap(ID3D12Device* device, UINT frameCount,
+        UINT persistentBlocks = 256, UINT ringPerFrame = 1024);
+
+    // Throws when the persistent region is full; it grows at the next
+    // BeginFrame. Write the descriptors through GetPersistentCpuHandle, then
+    // call UpdatePersistent.
+    HostDescriptorTable AllocatePersistent(UINT resourceCount);
+    void FreePersistent(const HostDescriptorTable& table)   { m_allocator.FreePersistent(table); }
+    D3D12_CPU_DESCRIPTOR_HANDLE GetPersistentCpuHandle(UINT index) const;
+    void UpdatePersistent(const HostDescriptorTable& table);
+
+    // Copies count descriptors from CPU-only heaps into a table in the
+    // current frame's ring. Throws when the ring is full.
+    HostDescriptorTable CopyTransient(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, UINT count);
+
+    // Call once per frame after the GPU has finished the frame that last used
+    // the same frame slot, before SetDescriptorHeaps. May replace the heap.
+    void BeginFrame();
+
+    ID3D12DescriptorHeap* GetHeap() const { return m_heap.Get(); }
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGpuHandle(UINT index) const;
+    HostDescriptorStats GetStats() const { return m_allocator.GetStats(); }
+
+private:
+    void Grow(UINT capacity, UINT persistentDescriptors);
+    void WriteNullExtensionSlot(D3D12_CPU_DESCRIPTOR_HANDLE handle);
+
+    Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+    UINT m_descriptorSize;
+    UINT m_frameCount;
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_heap;
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_mirror;     // CPU-only copy of the persistent region.
+
+    // Replaced heaps with the frame number they were replaced in.
+    struct RetiredHeap
+    {
+        UINT64 frame;
+        Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> heap;
+    };
+    std::vector<RetiredHeap> m_retiredHeaps;
+    UINT64 m_frameNumber;
+
+    HostDescriptorAllocator m_allocator;
+};
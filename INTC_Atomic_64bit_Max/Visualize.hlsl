@@ -0,0 +1,153 @@
+/*========================== begin_copyright_notice ============================
+Copyright (C) 2022 Intel Corporation
+SPDX-License-Identifier: MIT
+============================= end_copyright_notice ===========================*/
+
+//
+// Resolves a 64-bit atomic surface (R32G32_UINT) into an RGBA8_UNORM texture
+// for display, with no CPU round-trip. Must match HostVisualizeTexel in
+// HostVisualize.h bit for bit: colors are computed as integer channel values
+// and written as value / 255.0, which the UNORM conversion returns exactly.
+// The application binds four 32-bit root constants (HostVisualizeConstants):
+//
+//   b1.x   mode (VISUALIZE_*)
+//   b1.y   rangeLow:   word modes subtract it first...
+//   b1.z   rangeShift: ...then shift right by it (less than 32)
+//
+// and the source's view rectangle at b0 (AtomicView.hlsl), and dispatches
+// ceil(target size / 8) groups. Texels outside the view are shown black
+// without reading the source, which need not be backed there (-reserved
+// maps only the view's tiles).
+//
+
+#include "AtomicView.hlsl"
+
+#ifndef VISUALIZE_SOURCE_REGISTER
+#define VISUALIZE_SOURCE_REGISTER u0
+#endif
+
+#ifndef VISUALIZE_TARGET_REGISTER
+#define VISUALIZE_TARGET_REGISTER u2
+#endif
+
+#ifndef VISUALIZE_CONSTANTS_REGISTER
+#define VISUALIZE_CONSTANTS_REGISTER b1
+#endif
+
+#define VISUALIZE_LOW_WORD  0
+#define VISUALIZE_HIGH_WORD 1
+#define VISUALIZE_LOG2      2
+#define VISUALIZE_ID_HASH   3
+
+// Highest Log2 level: bit 63 with both following bits set.
+#define VISUALIZE_MAX_LOG_LEVEL ((64 << 2) | 3)
+
+RWTexture2D<uint2> visualizeSource : register(VISUALIZE_SOURCE_REGISTER);
+RWTexture2D<unorm float4> visualizeTarget : register(VISUALIZE_TARGET_REGISTER);
+
+cbuffer VisualizeConstants : register(VISUALIZE_CONSTANTS_REGISTER)
+{
+    uint visualizeMode;
+    uint rangeLow;
+    uint rangeShift;
+    uint reserved;
+};
+
+// Blue, cyan, green, yellow, red in four steps of 64.
+uint3 Visualize_Ramp(uint t)
+{
+    uint f = (t & 63) * 4;
+    uint step = t >> 6;
+    if (step == 0)
+    {
+        return uint3(0, f, 255);
+    }
+    if (step == 1)
+    {
+        return uint3(0, 255, 255 - f);
+    }
+    if (step == 2)
+    {
+        return uint3(f, 255, 0);
+    }
+    return uint3(255, 255 - f, 0);
+}
+
+uint Visualize_Hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352D;
+    x ^= x >> 15;
+    x *= 0x846CA68B;
+    x ^= x >> 16;
+    return x;
+}
+
+// Index of the highest set bit of a non-zero value.
+uint Visualize_HighestBit(uint2 value)
+{
+    return value.y != 0 ? 32 + firstbithigh(value.y) : firstbithigh(value.x);
+}
+
+// (value >> shift) & 3. HLSL masks shift counts to five bits, so shifts of 0
+// and 32 or more are taken apart.
+uint Visualize_TwoBits(uint2 value, uint shift)
+{
+    if (shift >= 32)
+    {
+        return (value.y >> (shift - 32)) & 3;
+    }
+    if (shift == 0)
+    {
+        return value.x & 3;
+    }
+    return ((value.x >> shift) | (value.y << (32 - shift))) & 3;
+}
+
+uint3 Visualize_Color(uint2 value)
+{
+    if (visualizeMode == VISUALIZE_LOW_WORD || visualizeMode == VISUALIZE_HIGH_WORD)
+    {
+        uint word = visualizeMode == VISUALIZE_LOW_WORD ? value.x : value.y;
+        uint offset = word > rangeLow ? word - rangeLow : 0;
+        return Visualize_Ramp(min(offset >> rangeShift, 255));
+    }
+
+    if (visualizeMode == VISUALIZE_LOG2)
+    {
+        uint level = 0;
+        if (any(value != 0))
+        {
+            uint bit = Visualize_HighestBit(value);
+            uint next = bit >= 2 ? Visualize_TwoBits(value, bit - 2) : (value.x << (2 - bit)) & 3;
+            level = ((bit + 1) << 2) | next;
+        }
+        return Visualize_Ramp(level * 255 / VISUALIZE_MAX_LOG_LEVEL);
+    }
+
+    if (all(value == 0))
+    {
+        return uint3(0, 0, 0);
+    }
+    uint hash = Visualize_Hash(value.x ^ Visualize_Hash(value.y));
+    return uint3(hash & 0xFF, (hash >> 8) & 0xFF, (hash >> 16) & 0xFF);
+}
+
+[numthreads(8, 8, 1)]
+void VisualizeMain(uint3 DTid : SV_DispatchThreadID)
+{
+    uint width;
+    uint height;
+    visualizeTarget.GetDimensions(width, height);
+    if (any(DTid.xy >= uint2(width, height)))
+    {
+        return;
+    }
+
+    uint3 color = uint3(0, 0, 0);
+    if (all(DTid.xy >= viewOrigin) && View_Contains(DTid.xy - viewOrigin))
+    {
+        color = Visualize_Color(visualizeSource[DTid.xy]);
+    }
+    visualizeTarget[DTid.xy] = float4(float3(color) / 255.0, 1.0);
+}
@@ -12,8 +12,64 @@
 #include "stdafx.h"
 #include "Win32Application.h"
 
+#include <memory>
+
 HWND Win32Application::m_hwnd = nullptr;
 
+namespace
+{
+    // The message queue and the sample, as HostRunFrameLoop sees them.
+    class Win32FrameLoopHost : public HostFrameLoopHost
+    {
+    public:
+        Win32FrameLoopHost(DXSample* pSample, HWND hwnd) :
+            m_pSample(pSample),
+            m_hwnd(hwnd),
+            m_exitCode(0)
+        {
+        }
+
+        bool PumpEvents() override
+        {
+            MSG msg = {};
+            while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+            {
+                if (msg.message == WM_QUIT)
+                {
+                    m_exitCode = static_cast<int>(msg.wParam);
+                    return false;
+                }
+                TranslateMessage(&msg);
+                DispatchMessage(&msg);
+            }
+            return true;
+        }
+
+        void WaitForEvents() override
+        {
+            WaitMessage();
+        }
+
+        bool IsVisible() override
+        {
+            return !IsIconic(m_hwnd);
+        }
+
+        void RenderFrame() override
+        {
+            m_pSample->OnUpdate();
+            m_pSample->OnRender();
+        }
+
+        int GetExitCode() const { return m_exitCode; }
+
+    private:
+        DXSample* m_pSample;
+        HWND m_hwnd;
+        int m_exitCode;
+    };
+}
+
 int Win32Application::Run(DXSample* pSample, HINSTANCE hInstance, int nCmdShow)
 {
     // Parse the command line parameters
@@ -54,22 +110,20 @@ int Win32Application::Run(DXSample* pSample, HINSTANCE hInstance, int nCmdShow)
 
     ShowWindow(m_hwnd, nCmdShow);
 
-    // Main sample loop.
-    MSG msg = {};
-    while (msg.message != WM_QUIT)
+    // Main sample loop. Frames are paced by Present or the limiter; while
+    // the window is minimized the loop sleeps in the message queue.
+    std::unique_ptr<HostFrameLimiter> limiter;
+    if (pSample->GetPresentMode() == HostPresentMode::FixedRate)
     {
-        // Process any messages in the queue.
-        if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
-        {
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
-        }
+        limiter.reset(new HostFrameLimiter(pSample->GetFrameRate()));
     }
+    Win32FrameLoopHost host(pSample, m_hwnd);
+    HostRunFrameLoop(host, limiter.get());
 
     pSample->OnDestroy();
 
     // Return this part of the WM_QUIT message to Windows.
-    return static_cast<char>(msg.wParam);
+    return static_cast<char>(host.GetExitCode());
 }
 
 // Main message handler for the sample.
@@ -102,11 +156,8 @@ LRESULT CALLBACK Win32Application::WindowProc(HWND hWnd, UINT message, WPARAM wP
         return 0;
 
     case WM_PAINT:
-        if (pSample)
-        {
-            pSample->OnUpdate();
-            pSample->OnRender();
-        }
+        // The main loop renders; validating stops repeated WM_PAINTs.
+        ValidateRect(hWnd, nullptr);
         return 0;
 
     case WM_DESTROY: